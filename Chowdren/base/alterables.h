@@ -9,6 +9,7 @@
 #include "dynnum.h"
 #include "pool.h"
 #include "stringcommon.h"
+#include "internstring.h"
 
 #define ALT_VALUES 26
 #define ALT_STRINGS 10
@@ -268,7 +269,7 @@ public:
 class AlterableStrings
 {
 public:
-    std::string values[ALT_STRINGS];
+    InternString values[ALT_STRINGS];
 
     AlterableStrings()
     {
@@ -278,6 +279,13 @@ public:
     {
         if (index >= ALT_STRINGS)
             return empty_string;
+        return values[index].get();
+    }
+
+    const InternString & get_intern(size_t index)
+    {
+        if (index >= ALT_STRINGS)
+            return empty_intern;
         return values[index];
     }
 
@@ -285,7 +293,7 @@ public:
     {
         if (index >= ALT_STRINGS)
             return;
-        values[index] = value;
+        values[index].set(value);
     }
 
     void set(const AlterableStrings & v)
@@ -363,6 +371,7 @@ public:
 
     static Alterables * create();
     static void destroy(Alterables * ptr);
+    static void release(Alterables * ptr);
 };
 
 struct SavedAlterables
@@ -380,12 +389,27 @@ extern ObjectPool<Alterables> alterable_pool;
 
 inline Alterables * Alterables::create()
 {
+    FrameArena * arena = FrameArena::current;
+    if (arena != NULL)
+        return new (arena->allocate(sizeof(Alterables))) Alterables();
     return new (alterable_pool.create()) Alterables();
 }
 
 inline void Alterables::destroy(Alterables * ptr)
 {
+    if (ptr == NULL)
+        return;
+    ptr->~Alterables();
     alterable_pool.destroy(ptr);
 }
 
+// for alterables created from a frame arena. the memory goes back with the
+// arena, but the strings still have to be freed
+inline void Alterables::release(Alterables * ptr)
+{
+    if (ptr == NULL)
+        return;
+    ptr->~Alterables();
+}
+
 #endif // ALTERABLES_H
@@ -0,0 +1,93 @@
+#include "blockcodec.h"
+#include <string.h>
+
+#define STBI_NO_STDIO
+#define STBI_NO_HDR
+#define STBI_ONLY_PNG
+#include "stb_image.h"
+
+#define LZ4_MIN_MATCH 4
+
+inline bool read_length(const unsigned char *& src, const unsigned char * end,
+                        unsigned int & len)
+{
+    unsigned int v;
+    do {
+        if (src >= end)
+            return false;
+        v = *src++;
+        len += v;
+    } while (v == 255);
+    return true;
+}
+
+int lz4_decode_block(const unsigned char * src, unsigned int src_size,
+                     unsigned char * out, unsigned int out_size)
+{
+    const unsigned char * src_end = src + src_size;
+    unsigned char * dst = out;
+    unsigned char * dst_end = out + out_size;
+
+    while (src < src_end) {
+        unsigned int token = *src++;
+
+        // literals
+        unsigned int len = token >> 4;
+        if (len == 15 && !read_length(src, src_end, len))
+            return -1;
+        if (len > (unsigned int)(src_end - src) ||
+            len > (unsigned int)(dst_end - dst))
+            return -1;
+        memcpy(dst, src, len);
+        src += len;
+        dst += len;
+
+        // last sequence has no match
+        if (src >= src_end)
+            break;
+
+        if (src_end - src < 2)
+            return -1;
+        unsigned int offset = src[0] | (src[1] << 8);
+        src += 2;
+        if (offset == 0 || offset > (unsigned int)(dst - out))
+            return -1;
+
+        len = token & 0xF;
+        if (len == 15 && !read_length(src, src_end, len))
+            return -1;
+        len += LZ4_MIN_MATCH;
+        if (len > (unsigned int)(dst_end - dst))
+            return -1;
+
+        const unsigned char * match = dst - offset;
+        if (offset >= len) {
+            memcpy(dst, match, len);
+            dst += len;
+        } else {
+            // overlapping copy, e.g. runs of a single pixel
+            unsigned char * copy_end = dst + len;
+            while (dst < copy_end)
+                *dst++ = *match++;
+        }
+    }
+
+    return int(dst - out);
+}
+
+int decode_block(int codec, const unsigned char * src, unsigned int src_size,
+                 unsigned char * out, unsigned int out_size)
+{
+    switch (codec) {
+        case ZLIB_CODEC:
+            return stbi_zlib_decode_buffer((char*)out, out_size,
+                                           (const char*)src, src_size);
+        case LZ4_CODEC:
+            if (lz4_decode_block(src, src_size, out, out_size) !=
+                int(out_size))
+                return -1;
+            return int(out_size);
+        default:
+            return -1;
+    }
+}
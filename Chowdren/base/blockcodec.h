@@ -0,0 +1,22 @@
+#ifndef CHOWDREN_BLOCKCODEC_H
+#define CHOWDREN_BLOCKCODEC_H
+
+// block codecs for asset data, see chowdren/blockcodec.py
+
+enum BlockCodec
+{
+    ZLIB_CODEC = 0,
+    LZ4_CODEC,
+    BLOCK_CODEC_MAX
+};
+
+// decodes a raw LZ4 block. returns the number of bytes written, or -1 if the
+// block is malformed or does not fit in 'out'
+int lz4_decode_block(const unsigned char * src, unsigned int src_size,
+                     unsigned char * out, unsigned int out_size);
+
+// decodes 'src' with the given codec. returns < 0 on error
+int decode_block(int codec, const unsigned char * src, unsigned int src_size,
+                 unsigned char * out, unsigned int out_size);
+
+#endif // CHOWDREN_BLOCKCODEC_H
@@ -66,6 +66,11 @@ public:
     template <typename T>
     bool remove_query(int v[4], T & callback);
 
+    template <typename T>
+    void query_nearest(int x, int y, T & callback);
+    template <typename T>
+    void query_cell(int x, int y, T & callback);
+
     void get_pos(int in[4], int out[4]);
     void set_pos(int in[4], GridItem & item);
 };
@@ -209,4 +214,61 @@ inline bool UniformGrid::remove_query(int v[4], T & callback)
     return res;
 }
 
+template <typename T>
+inline void UniformGrid::query_cell(int x, int y, T & callback)
+{
+    GridItemList & list = grid[GRID_INDEX(x, y)];
+    vector<int>::iterator it;
+    for (it = list.items.begin(); it != list.items.end(); ++it) {
+        GridItem & item = store[*it];
+        if (item.last_query_id == query_id)
+            continue;
+        item.last_query_id = query_id;
+        callback.on_callback(item.data);
+    }
+}
+
+// visits the items around (x, y) one ring of cells at a time, nearest
+// rings first. callback.get_radius() is the current search radius, and the
+// walk stops once the next ring lies entirely outside of it. items only
+// have to be inside a ring if the point being measured lies in their box.
+template <typename T>
+inline void UniformGrid::query_nearest(int x, int y, T & callback)
+{
+    int cx = clamp(x / GRID_SIZE, 0, width-1);
+    int cy = clamp(y / GRID_SIZE, 0, height-1);
+    int max_r = std::max(std::max(cx, width - 1 - cx),
+                         std::max(cy, height - 1 - cy));
+
+    query_id++;
+
+    for (int r = 0; r <= max_r; r++) {
+        // the cells of ring r are separated from the center cell by r-1
+        // full cells. the border cells also hold everything outside the
+        // grid, but only extend away from the center.
+        if (r > 1 && float((r - 1) * GRID_SIZE) > callback.get_radius())
+            return;
+        int y1 = cy - r;
+        int y2 = cy + r;
+        int x1 = std::max(0, cx - r);
+        int x2 = std::min(width - 1, cx + r);
+        if (y1 >= 0) {
+            for (int xx = x1; xx <= x2; xx++)
+                query_cell(xx, y1, callback);
+        }
+        if (r > 0 && y2 < height) {
+            for (int xx = x1; xx <= x2; xx++)
+                query_cell(xx, y2, callback);
+        }
+        int yy1 = std::max(0, y1 + 1);
+        int yy2 = std::min(height - 1, y2 - 1);
+        for (int yy = yy1; yy <= yy2; yy++) {
+            if (cx - r >= 0)
+                query_cell(cx - r, yy, callback);
+            if (r > 0 && cx + r < width)
+                query_cell(cx + r, yy, callback);
+        }
+    }
+}
+
 #endif // CHOWDREN_GRID_H
@@ -38,6 +38,10 @@ namespace boost
 
 std::string newline_character("\r\n");
 std::string empty_string("");
+uint64_t global_change_stamp = 0;
+uint64_t event_stamp_start = 0;
+unsigned int event_check_count = 0;
+unsigned int event_skip_count = 0;
 
 static const char hex_characters[] = "0123456789abcdef";
 
@@ -556,6 +560,11 @@ void Layer::reset()
     off_x = off_y = 0;
     scroll_x = scroll_y = 0;
     back = NULL;
+#ifdef CHOWDREN_LAYER_CACHE
+    cache = NULL;
+    cache_dirty = true;
+    cache_frames = 0;
+#endif
 
     update_position();
 #ifdef CHOWDREN_IS_3DS
@@ -590,6 +599,9 @@ void Layer::init(int index, double coeff_x, double coeff_y, bool visible,
 Layer::~Layer()
 {
     delete back;
+#ifdef CHOWDREN_LAYER_CACHE
+    delete cache;
+#endif
 
     // layers are in charge of deleting background instances
     FlatObjectList::const_iterator it;
@@ -731,6 +743,9 @@ void Layer::update_position()
 
 void Layer::add_background_object(FrameObject * instance)
 {
+#ifdef CHOWDREN_LAYER_CACHE
+    invalidate_cache();
+#endif
     if (visible)
         instance->flags |= LAYER_VISIBLE;
     else
@@ -745,6 +760,9 @@ void Layer::add_background_object(FrameObject * instance)
 
 void Layer::remove_background_object(FrameObject * instance)
 {
+#ifdef CHOWDREN_LAYER_CACHE
+    invalidate_cache();
+#endif
     FlatObjectList::iterator it;
     for (it = background_instances.begin(); it != background_instances.end();
          ++it) {
@@ -781,6 +799,9 @@ inline unsigned int sub_depth(unsigned int start, unsigned int sub,
 
 void Layer::add_object(FrameObject * instance)
 {
+#ifdef CHOWDREN_LAYER_CACHE
+    invalidate_cache();
+#endif
     if (visible)
         instance->flags |= LAYER_VISIBLE;
     else
@@ -806,6 +827,9 @@ void Layer::add_object(FrameObject * instance)
 
 void Layer::insert_object(FrameObject * instance, int index)
 {
+#ifdef CHOWDREN_LAYER_CACHE
+    invalidate_cache();
+#endif
     if (visible)
         instance->flags |= LAYER_VISIBLE;
     else
@@ -859,6 +883,9 @@ void Layer::reset_depth()
 
 void Layer::remove_object(FrameObject * instance)
 {
+#ifdef CHOWDREN_LAYER_CACHE
+    invalidate_cache();
+#endif
     instances.erase(LayerInstances::s_iterator_to(*instance));
 }
 
@@ -924,6 +951,9 @@ void Layer::hide()
 
 void Layer::destroy_backgrounds()
 {
+#ifdef CHOWDREN_LAYER_CACHE
+    invalidate_cache();
+#endif
     if (back == NULL)
         return;
     back->reset();
@@ -931,6 +961,9 @@ void Layer::destroy_backgrounds()
 
 void Layer::destroy_backgrounds(int x, int y, bool fine)
 {
+#ifdef CHOWDREN_LAYER_CACHE
+    invalidate_cache();
+#endif
     if (fine)
         std::cout << "Destroy backgrounds at " << x << ", " << y <<
             " (" << fine << ") not implemented" << std::endl;
@@ -984,6 +1017,9 @@ void Layer::paste(Image * img, int dest_x, int dest_y,
                   int src_x, int src_y, int src_width, int src_height,
                   int collision_type, int effect, const Color & color)
 {
+#ifdef CHOWDREN_LAYER_CACHE
+    invalidate_cache();
+#endif
     if (collision_type != 0 && collision_type != 1 && collision_type != 3 &&
         collision_type != 4)
     {
@@ -1032,6 +1068,285 @@ inline void sort_depth(FlatObjectList & list)
     std::sort(list.begin(), list.end(), sort_depth_comp);
 }
 
+#ifdef CHOWDREN_BACK_CAPTURE
+
+// maximum number of objects that share one background capture
+#define BACK_CAPTURE_MAX 64
+// a group is split if its union is this many times larger than the area
+// the objects actually need
+#define BACK_CAPTURE_SLACK 2
+
+inline bool has_back_capture(FrameObject * obj)
+{
+    return obj->effect != Render::NONE && obj->collision != NULL &&
+           shader_has_back(obj->effect);
+}
+
+// finds the run of back-sampling objects starting at 'start' that can share
+// a single background capture. objects in a run are consecutive in draw
+// order and do not overlap, so none of them can see another one's output.
+static FlatObjectList::const_iterator
+find_back_group(FlatObjectList::const_iterator start,
+                FlatObjectList::const_iterator end, int box[4])
+{
+    static int boxes[BACK_CAPTURE_MAX][4];
+    int count = 0;
+    int64_t area = 0;
+    FlatObjectList::const_iterator it;
+    for (it = start; it != end && count < BACK_CAPTURE_MAX; ++it) {
+        FrameObject * obj = *it;
+        if (!has_back_capture(obj))
+            break;
+        int * b = boxes[count];
+        obj->get_screen_aabb(b);
+        bool overlaps = false;
+        for (int i = 0; i < count; ++i) {
+            if (!collides(boxes[i], b))
+                continue;
+            overlaps = true;
+            break;
+        }
+        if (overlaps)
+            break;
+        int u[4];
+        if (count == 0) {
+            u[0] = b[0]; u[1] = b[1]; u[2] = b[2]; u[3] = b[3];
+        } else {
+            rect_union(box[0], box[1], box[2], box[3], b[0], b[1], b[2], b[3],
+                       u[0], u[1], u[2], u[3]);
+        }
+        int64_t new_area = area + int64_t(b[2] - b[0]) * (b[3] - b[1]);
+        int64_t union_area = int64_t(u[2] - u[0]) * (u[3] - u[1]);
+        if (count > 0 && union_area > new_area * BACK_CAPTURE_SLACK)
+            break;
+        area = new_area;
+        box[0] = u[0]; box[1] = u[1]; box[2] = u[2]; box[3] = u[3];
+        count++;
+    }
+    if (count < 2)
+        return start;
+    return it;
+}
+
+#endif
+
+int Layer::draw_instances(int v[4])
+{
+    static FlatObjectList draw_list;
+    draw_list.clear();
+    DrawCallback callback(draw_list, v);
+    broadphase.query(v, callback);
+
+    sort_depth(draw_list);
+
+    FlatObjectList::const_iterator it;
+    for (it = draw_list.begin(); it != draw_list.end(); ++it) {
+        FrameObject * obj = *it;
+        if (!(obj->flags & BACKGROUND))
+            break;
+        obj->draw();
+    }
+
+    PROFILE_BEGIN(Layer_draw_pasted);
+
+    // draw pasted items
+    if (back != NULL) {
+        back->draw(this, v);
+    }
+
+    PROFILE_END();
+
+#ifdef CHOWDREN_BACK_CAPTURE
+    // objects with back-sampling shaders that don't overlap share one copy
+    // of the framebuffer, everything else falls back to per-object copies
+    FlatObjectList::const_iterator group_end = it;
+    for (; it != draw_list.end(); ++it) {
+        if (it == group_end) {
+            Render::end_back_capture();
+            int box[4];
+            group_end = find_back_group(it, draw_list.end(), box);
+            if (group_end == it)
+                group_end = it + 1;
+            else
+                Render::begin_back_capture(box[0], box[1], box[2], box[3]);
+        }
+        (*it)->draw();
+    }
+    Render::end_back_capture();
+#else
+    for (; it != draw_list.end(); ++it) {
+        (*it)->draw();
+    }
+#endif
+
+    return int(draw_list.size());
+}
+
+#ifdef CHOWDREN_LAYER_CACHE
+
+// LayerCache
+
+LayerCache::LayerCache()
+: disabled(false)
+{
+    invalidate();
+}
+
+void LayerCache::invalidate()
+{
+    for (int i = 0; i < LAYER_CACHE_TILES; ++i) {
+        tiles[i].valid = false;
+    }
+}
+
+inline int get_tile_pos(int pos, int size)
+{
+    if (pos >= 0)
+        return (pos / size) * size;
+    return -(((-pos - 1) / size) + 1) * size;
+}
+
+void Layer::draw_tile(LayerCache::Tile & tile)
+{
+    if (tile.fbo.tex == 0)
+        tile.fbo.init(WINDOW_WIDTH, WINDOW_HEIGHT);
+
+    // objects that clip themselves to the window (e.g. quick backdrops) use
+    // the frame scroll position, so pretend the window is at the tile
+    Frame * frame = manager.frame;
+    int old_frame_x = frame->off_x;
+    int old_frame_y = frame->off_y;
+    frame->off_x = off_x + tile.x;
+    frame->off_y = off_y + tile.y;
+    int old_offset[2] = {Render::offset[0], Render::offset[1]};
+
+    tile.fbo.bind();
+    Render::set_view(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
+    Render::set_offset(-tile.x, -tile.y);
+    Render::clear(0, 0, 0, 0);
+
+    int v[4] = {tile.x, tile.y, tile.x + WINDOW_WIDTH,
+                tile.y + WINDOW_HEIGHT};
+    tile.draws = draw_instances(v);
+    tile.valid = true;
+
+    tile.fbo.unbind();
+    Render::set_view(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
+    Render::set_offset(old_offset[0], old_offset[1]);
+
+    frame->off_x = old_frame_x;
+    frame->off_y = old_frame_y;
+}
+
+bool Layer::draw_cache(int v[4])
+{
+    if (cache_dirty) {
+        cache_dirty = false;
+        cache_frames = 0;
+        if (cache != NULL)
+            cache->invalidate();
+    }
+
+    // only layers without regular instances are considered static
+    if (!instances.empty() || wrap_x || wrap_y)
+        return false;
+
+    if (cache_frames < LAYER_CACHE_DELAY) {
+        cache_frames++;
+        if (cache_frames < LAYER_CACHE_DELAY)
+            return false;
+        if (cache == NULL)
+            cache = new LayerCache;
+        // shaders that sample the background can't be drawn into a tile
+        cache->disabled = false;
+        FlatObjectList::const_iterator it;
+        for (it = background_instances.begin();
+             it != background_instances.end(); ++it) {
+            int effect = (*it)->effect;
+            if (effect == Render::NONE || !shader_has_back(effect))
+                continue;
+            cache->disabled = true;
+            break;
+        }
+    }
+
+    if (cache->disabled)
+        return false;
+
+    int tx1 = get_tile_pos(v[0], WINDOW_WIDTH);
+    int ty1 = get_tile_pos(v[1], WINDOW_HEIGHT);
+    int tx2 = get_tile_pos(v[2] - 1, WINDOW_WIDTH);
+    int ty2 = get_tile_pos(v[3] - 1, WINDOW_HEIGHT);
+
+    int count = ((tx2 - tx1) / WINDOW_WIDTH + 1) *
+                ((ty2 - ty1) / WINDOW_HEIGHT + 1);
+    if (count > LAYER_CACHE_TILES)
+        return false;
+
+    LayerCache::Tile * tiles = cache->tiles;
+    LayerCache::Tile * draw_tiles[LAYER_CACHE_TILES];
+    int i;
+
+    for (i = 0; i < LAYER_CACHE_TILES; ++i) {
+        tiles[i].used = false;
+    }
+
+    // reuse tiles that are still valid
+    int n = 0;
+    for (int ty = ty1; ty <= ty2; ty += WINDOW_HEIGHT)
+    for (int tx = tx1; tx <= tx2; tx += WINDOW_WIDTH) {
+        LayerCache::Tile * tile = NULL;
+        for (i = 0; i < LAYER_CACHE_TILES; ++i) {
+            LayerCache::Tile & t = tiles[i];
+            if (!t.valid || t.x != tx || t.y != ty)
+                continue;
+            tile = &t;
+            tile->used = true;
+            Render::stats.layer_cache_hits++;
+            Render::stats.layer_cache_saved += t.draws;
+            break;
+        }
+        draw_tiles[n++] = tile;
+    }
+
+    // render the missing tiles into tiles that are not on screen
+    n = 0;
+    for (int ty = ty1; ty <= ty2; ty += WINDOW_HEIGHT)
+    for (int tx = tx1; tx <= tx2; tx += WINDOW_WIDTH) {
+        if (draw_tiles[n] == NULL) {
+            LayerCache::Tile * tile = NULL;
+            for (i = 0; i < LAYER_CACHE_TILES; ++i) {
+                if (tiles[i].used)
+                    continue;
+                tile = &tiles[i];
+                if (!tile->valid)
+                    break;
+            }
+            tile->x = tx;
+            tile->y = ty;
+            tile->used = true;
+            draw_tile(*tile);
+            Render::stats.layer_cache_misses++;
+            draw_tiles[n] = tile;
+        }
+        n++;
+    }
+
+    Render::set_effect(Render::PREMUL);
+    for (i = 0; i < n; ++i) {
+        LayerCache::Tile * tile = draw_tiles[i];
+        Render::draw_tex(tile->x, tile->y,
+                         tile->x + WINDOW_WIDTH, tile->y + WINDOW_HEIGHT,
+                         Color(), tile->fbo.get_tex(),
+                         fbo_texcoords[0], fbo_texcoords[1],
+                         fbo_texcoords[2], fbo_texcoords[3]);
+    }
+    Render::disable_effect();
+    return true;
+}
+
+#endif
+
 void Layer::draw(int display_x, int display_y)
 {
     if (!visible)
@@ -1075,33 +1390,12 @@ void Layer::draw(int display_x, int display_y)
     int v[4] = {x1, y1, x2, y2};
 #endif
 
-    static FlatObjectList draw_list;
-    draw_list.clear();
-    DrawCallback callback(draw_list, v);
-    broadphase.query(v, callback);
-
-    sort_depth(draw_list);
-
-    FlatObjectList::const_iterator it;
-    for (it = draw_list.begin(); it != draw_list.end(); ++it) {
-        FrameObject * obj = *it;
-        if (!(obj->flags & BACKGROUND))
-            break;
-        obj->draw();
-    }
-
-    PROFILE_BEGIN(Layer_draw_pasted);
-
-    // draw pasted items
-    if (back != NULL) {
-        back->draw(this, v);
-    }
-
-    PROFILE_END();
-
-    for (; it != draw_list.end(); ++it) {
-        (*it)->draw();
-    }
+#ifdef CHOWDREN_LAYER_CACHE
+    if (!draw_cache(v))
+        draw_instances(v);
+#else
+    draw_instances(v);
+#endif
 
     if (blend_color.r != 255 || blend_color.g != 255 || blend_color.b != 255) {
         Render::set_effect(Render::LAYERCOLOR);
@@ -1154,6 +1448,16 @@ void FrameData::handle_pre_events()
 {
 }
 
+#ifdef CHOWDREN_FRAME_SNAPSHOT
+void FrameData::save_state(FrameSnapshot & snapshot)
+{
+}
+
+void FrameData::load_state(FrameSnapshot & snapshot)
+{
+}
+#endif
+
 // Frame
 
 Frame::Frame()
@@ -1161,6 +1465,10 @@ Frame::Frame()
   last_key(-1), next_frame(-1), loop_count(0), frame_time(0.0),
   index(-1)
 {
+#ifdef CHOWDREN_FRAME_SNAPSHOT
+    snapshot_id = 0;
+    restarted = false;
+#endif
 }
 
 void Frame::pause()
@@ -1359,11 +1667,50 @@ void Frame::clean_instances()
             instance->layer->remove_background_object(instance);
         else
             instance->layer->remove_object(instance);
+#ifdef CHOWDREN_FRAME_SNAPSHOT
+        if (instance->flags & SNAPSHOT) {
+            park_instance(instance);
+            continue;
+        }
+        if (instance->flags & BACKGROUND)
+            snapshot_id++;
+#endif
         instance->dealloc();
     }
     destroyed_instances.clear();
 }
 
+#ifdef CHOWDREN_FRAME_SNAPSHOT
+void Frame::park_instance(FrameObject * instance)
+{
+    if (instance->collision != NULL)
+        instance->collision->remove_proxy();
+    parked_instances.push_back(instance);
+}
+
+void Frame::free_parked_instances()
+{
+    FlatObjectList::const_iterator it;
+    for (it = parked_instances.begin(); it != parked_instances.end(); ++it)
+        (*it)->dealloc();
+    parked_instances.clear();
+    snapshot_id++;
+}
+
+// puts back the state the frame had after it was set up, so only the start
+// of frame events run again. fails if the snapshot can no longer be used
+bool Frame::restart_from_snapshot()
+{
+    if (!restart_snapshot.restore(this))
+        return false;
+    next_frame = -1;
+    loop_count = 0;
+    frame_time = 0.0;
+    restarted = true;
+    return true;
+}
+#endif
+
 void Frame::update_objects()
 {
 }
@@ -1384,7 +1731,20 @@ bool Frame::update()
     }
 
     if (loop_count == 0) {
-        data->init();
+#ifdef CHOWDREN_FRAME_SNAPSHOT
+        if (restarted)
+            restarted = false;
+        else
+#endif
+        {
+            FrameArena * old_arena = FrameArena::current;
+            FrameArena::current = &arena;
+            data->init();
+            FrameArena::current = old_arena;
+#ifdef CHOWDREN_FRAME_SNAPSHOT
+            restart_snapshot.take(this);
+#endif
+        }
         update_objects();
         data->on_start();
     } else {
@@ -1555,9 +1915,22 @@ void Frame::set_object_layer(FrameObject * instance, int new_layer)
         instance->collision->create_proxy();
 }
 
+DynamicLoop * Frame::find_loop(const std::string & name)
+{
+    if (loops == NULL || name.empty())
+        return NULL;
+    int index = loop_hash(&name[0], name.size());
+    if (index == -1)
+        return NULL;
+    return &loops[index];
+}
+
 int Frame::get_loop_index(const std::string & name)
 {
-    return *((*loops)[name].index);
+    DynamicLoop * loop = find_loop(name);
+    if (loop == NULL)
+        return 0;
+    return *loop->index;
 }
 
 void Frame::reset()
@@ -1572,9 +1945,15 @@ void Frame::reset()
         }
     }
 
+#ifdef CHOWDREN_FRAME_SNAPSHOT
+    restart_snapshot.clear();
+    free_parked_instances();
+#endif
+
     layers.clear();
     INSTANCE_MAP.clear();
     destroyed_instances.clear();
+    arena.reset();
     next_frame = -1;
     loop_count = 0;
     off_x = new_off_x = 0;
@@ -1591,7 +1970,8 @@ void Frame::reset()
 // FrameObject
 
 FrameObject::FrameObject(int x, int y, int type_id)
-: x(x), y(y), id(type_id), flags(SCROLL | VISIBLE), effect(Render::NONE),
+: x(x), y(y), layer(NULL), id(type_id), flags(SCROLL | VISIBLE),
+  effect(Render::NONE),
   alterables(NULL), shader_parameters(NULL), direction(0),
   movement(NULL), movements(NULL), movement_count(0), collision(NULL),
   collision_flags(0)
@@ -1625,8 +2005,12 @@ FrameObject::~FrameObject()
         delete[] movements;
     }
     delete shader_parameters;
-    if (!(flags & GLOBAL))
-        Alterables::destroy(alterables);
+    if (!(flags & GLOBAL)) {
+        if (flags & ARENA)
+            Alterables::release(alterables);
+        else
+            Alterables::destroy(alterables);
+    }
 
 #ifdef CHOWDREN_USE_VALUEADD
     delete extra_alterables;
@@ -1712,6 +2096,9 @@ void FrameObject::set_position(int new_x, int new_y)
 {
     if (new_x == x && new_y == y)
         return;
+#ifdef CHOWDREN_LAYER_CACHE
+    invalidate_layer_cache();
+#endif
     if (collision == NULL) {
         x = new_x;
         y = new_y;
@@ -1728,6 +2115,15 @@ void FrameObject::set_position(int new_x, int new_y)
     collision->update_proxy();
 }
 
+#ifdef CHOWDREN_LAYER_CACHE
+void FrameObject::invalidate_layer_cache()
+{
+    if (layer == NULL)
+        return;
+    layer->invalidate_cache();
+}
+#endif
+
 void FrameObject::set_global_position(int x, int y)
 {
     set_position(x - layer->off_x, y - layer->off_y);
@@ -1738,6 +2134,9 @@ void FrameObject::set_x(int new_x)
     new_x -= layer->off_x;
     if (x == new_x)
         return;
+#ifdef CHOWDREN_LAYER_CACHE
+    invalidate_layer_cache();
+#endif
     if (collision == NULL) {
         x = new_x;
         return;
@@ -1754,6 +2153,9 @@ void FrameObject::set_y(int new_y)
     new_y -= layer->off_y;
     if (y == new_y)
         return;
+#ifdef CHOWDREN_LAYER_CACHE
+    invalidate_layer_cache();
+#endif
     if (collision == NULL) {
         y = new_y;
         return;
@@ -1820,6 +2222,9 @@ void FrameObject::create_alterables()
 
 void FrameObject::set_visible(bool value)
 {
+#ifdef CHOWDREN_LAYER_CACHE
+    invalidate_layer_cache();
+#endif
     flash(0);
 
     if (value)
@@ -1830,6 +2235,9 @@ void FrameObject::set_visible(bool value)
 
 void FrameObject::set_blend_color(int color)
 {
+#ifdef CHOWDREN_LAYER_CACHE
+    invalidate_layer_cache();
+#endif
     int a = blend_color.a;
     blend_color = Color(color);
     blend_color.a = a;
@@ -2038,6 +2446,9 @@ int FrameObject::get_generic_height()
 
 void FrameObject::set_shader(int value)
 {
+#ifdef CHOWDREN_LAYER_CACHE
+    invalidate_layer_cache();
+#endif
     if (shader_parameters == NULL)
         shader_parameters = new ShaderParameters;
     effect = value;
@@ -2047,9 +2458,16 @@ void FrameObject::set_shader_parameter(const std::string & name, double value)
 {
     if (name.empty())
         return;
+    set_shader_parameter(hash_shader_parameter(&name[0], name.size()), value);
+}
+
+void FrameObject::set_shader_parameter(unsigned int hash, double value)
+{
+#ifdef CHOWDREN_LAYER_CACHE
+    invalidate_layer_cache();
+#endif
     if (shader_parameters == NULL)
         shader_parameters = new ShaderParameters;
-    unsigned int hash = hash_shader_parameter(&name[0], name.size());
     ShaderParameter * param = find_shader_parameter(hash);
     if (param == NULL) {
         shader_parameters->emplace_back();
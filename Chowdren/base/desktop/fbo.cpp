@@ -42,10 +42,10 @@ Framebuffer::~Framebuffer()
 
 void Framebuffer::init(int w, int h)
 {
-#ifdef CHOWDREN_USE_D3D
     this->w = w;
     this->h = h;
 
+#ifdef CHOWDREN_USE_D3D
     if (fbo_index == -1) {    
         for (fbo_index = 0; fbo_index < 32; ++fbo_index) {
             if (fbos[fbo_index] != NULL)
@@ -11,9 +11,10 @@ class Framebuffer
 {
 public:
     Texture tex;
+    int w, h;
 #ifdef CHOWDREN_USE_D3D
     IDirect3DSurface9 * fbo;
-    int fbo_index, w, h;
+    int fbo_index;
     static Framebuffer * fbos[32];
 #else
     GLuint fbo;
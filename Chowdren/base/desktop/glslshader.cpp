@@ -16,6 +16,7 @@ static ConstantTable constant_table;
 #endif
 
 BaseShader * BaseShader::current = NULL;
+unsigned int BaseShader::uniform_generation = 1;
 
 BaseShader::BaseShader(unsigned int id, int flags,
                        const char * texture_parameter)
@@ -95,7 +96,7 @@ void BaseShader::initialize()
     if (flags & SHADER_HAS_BACK)
         glUniform1i((GLint)get_uniform(BACKTEX_SAMPLER_NAME), 1);
     if (flags & SHADER_HAS_TEX_SIZE)
-        size_uniform = (GLint)get_uniform(SIZE_UNIFORM_NAME);
+        size_uniform = get_uniform(SIZE_UNIFORM_NAME);
 
     if (texture_parameter != NULL) {
         glUniform1i((GLint)get_uniform(texture_parameter), 2);
@@ -153,7 +154,7 @@ void BaseShader::begin(FrameObject * instance, int width, int height)
     if (flags & SHADER_HAS_BACK) {
         int box[4];
         instance->get_screen_aabb(box);
-        Texture t = Render::copy_rect(box[0], box[1], box[2], box[3]);
+        Texture t = Render::get_back_tex(box);
         TextureData & td = render_data.textures[t];
         render_data.device->SetTexture(back_sampler, td.texture);
     }
@@ -162,17 +163,17 @@ void BaseShader::begin(FrameObject * instance, int width, int height)
         render_data.device->SetPixelShader(frag_shader);
         render_data.device->SetVertexShader(vert_shader);
         current = this;
+        // constant registers are shared between shaders
+        uniform_generation++;
     }
 
-    if (flags & SHADER_HAS_TEX_SIZE) {
-        float v[4] = {1.0f / width, 1.0f / height, 0.0f, 0.0f};
-        render_data.device->SetPixelShaderConstantF(size_uniform, &v[0], 1);
-    }
+    if (flags & SHADER_HAS_TEX_SIZE)
+        set_vec2(size_uniform, 1.0f / width, 1.0f / height);
 #else
     if (flags & SHADER_HAS_BACK) {
         int box[4];
         instance->get_screen_aabb(box);
-        Texture t = Render::copy_rect(box[0], box[1], box[2], box[3]);
+        Texture t = Render::get_back_tex(box);
         glActiveTexture(GL_TEXTURE1);
         glBindTexture(GL_TEXTURE_2D, t);
         glActiveTexture(GL_TEXTURE0);
@@ -183,45 +184,95 @@ void BaseShader::begin(FrameObject * instance, int width, int height)
         current = this;
     }
 
-    if (flags & SHADER_HAS_TEX_SIZE) {
-        glUniform2f(size_uniform, 1.0f / width, 1.0f / height);
+    if (flags & SHADER_HAS_TEX_SIZE)
+        set_vec2(size_uniform, 1.0f / width, 1.0f / height);
+#endif
+}
+
+inline bool is_uniform_set(ShaderUniform & uniform, float a, float b,
+                           float c, float d)
+{
+    if (uniform.generation == BaseShader::uniform_generation &&
+        uniform.value[0] == a && uniform.value[1] == b &&
+        uniform.value[2] == c && uniform.value[3] == d)
+    {
+        Render::stats.uniform_skips++;
+        return true;
     }
+    uniform.generation = BaseShader::uniform_generation;
+    uniform.value[0] = a;
+    uniform.value[1] = b;
+    uniform.value[2] = c;
+    uniform.value[3] = d;
+    Render::stats.uniform_uploads++;
+    return false;
+}
+
+void BaseShader::set_int(ShaderUniform & uniform, int value)
+{
+    if (is_uniform_set(uniform, float(value), 0.0f, 0.0f, 0.0f))
+        return;
+#ifdef CHOWDREN_USE_D3D
+    render_data.device->SetPixelShaderConstantF(uniform, uniform.value, 1);
+#else
+    glUniform1i((GLint)uniform, value);
 #endif
 }
 
-void BaseShader::set_int(FrameObject * instance, int src, int uniform)
+void BaseShader::set_float(ShaderUniform & uniform, float value)
 {
-    int val = (int)instance->get_shader_parameter(src);
+    if (is_uniform_set(uniform, value, 0.0f, 0.0f, 0.0f))
+        return;
 #ifdef CHOWDREN_USE_D3D
-    float v[4] = {val, 0, 0, 0};
-    render_data.device->SetPixelShaderConstantF(uniform, &v[0], 1);
+    render_data.device->SetPixelShaderConstantF(uniform, uniform.value, 1);
 #else
-    glUniform1i((GLint)uniform, val);
+    glUniform1f((GLint)uniform, value);
 #endif
 }
 
-void BaseShader::set_float(FrameObject * instance, int src, int uniform)
+void BaseShader::set_vec2(ShaderUniform & uniform, float a, float b)
 {
+    if (is_uniform_set(uniform, a, b, 0.0f, 0.0f))
+        return;
 #ifdef CHOWDREN_USE_D3D
-    float v[4] = {instance->get_shader_parameter(src), 0.0f, 0.0f, 0.0f};
-    render_data.device->SetPixelShaderConstantF(uniform, &v[0], 1);
+    render_data.device->SetPixelShaderConstantF(uniform, uniform.value, 1);
 #else
-    glUniform1f((GLint)uniform, instance->get_shader_parameter(src));
+    glUniform2f((GLint)uniform, a, b);
 #endif
 }
 
-void BaseShader::set_vec4(FrameObject * instance, int src, int uniform)
+void BaseShader::set_vec4(ShaderUniform & uniform, float v[4])
 {
-    int val = (int)instance->get_shader_parameter(src);
-    float v[4];
-    convert_vec4(val, v[0], v[1], v[2], v[3]);
+    if (is_uniform_set(uniform, v[0], v[1], v[2], v[3]))
+        return;
 #ifdef CHOWDREN_USE_D3D
-    render_data.device->SetPixelShaderConstantF(uniform, &v[0], 1);
+    render_data.device->SetPixelShaderConstantF(uniform, uniform.value, 1);
 #else
     glUniform4f((GLint)uniform, v[0], v[1], v[2], v[3]);
 #endif
 }
 
+void BaseShader::set_int(FrameObject * instance, int src,
+                         ShaderUniform & uniform)
+{
+    set_int(uniform, (int)instance->get_shader_parameter(src));
+}
+
+void BaseShader::set_float(FrameObject * instance, int src,
+                           ShaderUniform & uniform)
+{
+    set_float(uniform, instance->get_shader_parameter(src));
+}
+
+void BaseShader::set_vec4(FrameObject * instance, int src,
+                          ShaderUniform & uniform)
+{
+    int val = (int)instance->get_shader_parameter(src);
+    float v[4];
+    convert_vec4(val, v[0], v[1], v[2], v[3]);
+    set_vec4(uniform, v);
+}
+
 void BaseShader::set_image(FrameObject * instance, int src)
 {
 #ifdef CHOWDREN_USE_D3D
@@ -290,33 +341,10 @@ int BaseShader::get_uniform(const char * value)
 
 #include "shadercommon.cpp"
 
-#ifdef CHOWDREN_USE_D3D
-
 void set_scale_uniform(float width, float height, float x_scale, float y_scale)
 {
-    float v[4];
-    v[0] = x_scale;
-    render_data.device->SetPixelShaderConstantF(pixelscale_shader.x_scale,
-                                                &v[0], 1);
-    v[0] = y_scale;
-    render_data.device->SetPixelShaderConstantF(pixelscale_shader.y_scale,
-                                                &v[0], 1);
-    v[0] = width;
-    render_data.device->SetPixelShaderConstantF(pixelscale_shader.x_size,
-                                                &v[0], 1);
-    v[0] = height;
-    render_data.device->SetPixelShaderConstantF(pixelscale_shader.y_size,
-                                                &v[0], 1);
+    BaseShader::set_float(pixelscale_shader.x_scale, x_scale);
+    BaseShader::set_float(pixelscale_shader.y_scale, y_scale);
+    BaseShader::set_float(pixelscale_shader.x_size, width);
+    BaseShader::set_float(pixelscale_shader.y_size, height);
 }
-
-#else
-
-void set_scale_uniform(float width, float height, float x_scale, float y_scale)
-{
-    glUniform1f(pixelscale_shader.x_scale, x_scale);
-    glUniform1f(pixelscale_shader.y_scale, y_scale);
-    glUniform1f(pixelscale_shader.x_size, width);
-    glUniform1f(pixelscale_shader.y_size, height);
-}
-
-#endif
\ No newline at end of file
@@ -6,21 +6,48 @@
 
 class FrameObject;
 
+// uniform location with the last value uploaded to it, so unchanged values
+// are not sent again for every object drawn with a shader
+struct ShaderUniform
+{
+    int location;
+    unsigned int generation;
+    float value[4];
+
+    ShaderUniform()
+    : location(-1), generation(0)
+    {
+    }
+
+    ShaderUniform & operator=(int new_location)
+    {
+        location = new_location;
+        generation = 0;
+        return *this;
+    }
+
+    operator int() const
+    {
+        return location;
+    }
+};
+
 class BaseShader
 {
 public:
     static BaseShader * current;
+    static unsigned int uniform_generation;
 
 #ifdef CHOWDREN_USE_D3D
     int tex_sampler;
     int back_sampler;
     int tex_param_sampler;
-    int size_uniform;
+    ShaderUniform size_uniform;
     IDirect3DVertexShader9 * vert_shader;
     IDirect3DPixelShader9 * frag_shader;
 #else
     GLhandleARB program;
-    GLint size_uniform;
+    ShaderUniform size_uniform;
     GLhandleARB attach_source(FSFile & fp, GLenum type);
 #endif
     bool initialized;
@@ -34,10 +61,17 @@ public:
     int get_uniform(const char * value);
     virtual void initialize_parameters();
     void begin(FrameObject * instance, int width, int height);
-    static void set_int(FrameObject * instance, int src, int uniform);
-    static void set_float(FrameObject * instance, int src, int uniform);
-    static void set_vec4(FrameObject * instance, int src, int uniform);
+    static void set_int(FrameObject * instance, int src,
+                        ShaderUniform & uniform);
+    static void set_float(FrameObject * instance, int src,
+                          ShaderUniform & uniform);
+    static void set_vec4(FrameObject * instance, int src,
+                         ShaderUniform & uniform);
     static void set_image(FrameObject * instance, int src);
+    static void set_int(ShaderUniform & uniform, int value);
+    static void set_float(ShaderUniform & uniform, float value);
+    static void set_vec2(ShaderUniform & uniform, float a, float b);
+    static void set_vec4(ShaderUniform & uniform, float v[4]);
 };
 
 void set_scale_uniform(float width, float height,
@@ -1872,7 +1872,15 @@ std::string convert_path(const std::string & v)
 
 void platform_print_stats()
 {
-
+    std::cout << "Uniform uploads: " << Render::stats.uniform_uploads
+        << " (skipped " << Render::stats.uniform_skips << ")" << std::endl;
+    std::cout << "Background copies: " << Render::stats.back_copies
+        << " (shared " << Render::stats.back_shared << ")" << std::endl;
+    std::cout << "Layer cache tiles: " << Render::stats.layer_cache_hits
+        << " hits, " << Render::stats.layer_cache_misses << " misses, "
+        << Render::stats.layer_cache_saved << " draws saved" << std::endl;
+    std::cout << "Draw calls: " << Render::stats.draw_calls
+        << " (" << Render::stats.quads << " quads)" << std::endl;
 }
 
 
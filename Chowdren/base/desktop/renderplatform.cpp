@@ -4,7 +4,9 @@
 
 RenderData render_data;
 
-float render_texcoords2[12] = {
+// sized for a full vertex buffer, since the array is read for every vertex
+// drawn. only the first quad is used by the back texture
+float render_texcoords2[12 * RENDER_BUFFER] = {
     0.0f, 1.0f,
     1.0f, 1.0f,
     1.0f, 0.0f,
@@ -315,6 +317,26 @@ Texture Render::create_tex(void * pixels, Format f, int width, int height)
     return tex;
 }
 
+void Render::update_tex(Texture tex, void * pixels, int pitch,
+                        int x, int y, int w, int h)
+{
+    TextureData & t = render_data.textures[tex];
+    RECT area = {x, y, x + w, y + h};
+    D3DLOCKED_RECT rect;
+    t.texture->LockRect(0, &rect, &area, 0);
+    unsigned char * src = (unsigned char*)pixels;
+    unsigned char * dst = (unsigned char*)rect.pBits;
+    for (int i = 0; i < h; ++i) {
+        if (render_data.has_sse2)
+            load_bgra_sse(w, 1, src, dst, rect.Pitch);
+        else
+            load_bgra(w, 1, src, dst, rect.Pitch);
+        src += pitch * 4;
+        dst += rect.Pitch;
+    }
+    t.texture->UnlockRect(0);
+}
+
 Texture Render::copy_rect(int x1, int in_y1, int x2, int in_y2)
 {
     int y1 = current_fbo->h - in_y2;
@@ -330,6 +352,7 @@ Texture Render::copy_rect(int x1, int in_y1, int x2, int in_y2)
     RECT src = {xx1, yy1, xx2, yy2};
     RECT dst = {xx1 - x1, yy1 - y1, xx2 - x1, yy2 - y1};
 
+    render_data.back_capture = false;
     d3d_set_backtex_size(w, h);
     IDirect3DSurface9 * surface;
     TextureData & td = render_data.textures[render_data.back_tex];
@@ -341,3 +364,62 @@ Texture Render::copy_rect(int x1, int in_y1, int x2, int in_y2)
 }
 
 #endif
+
+// background capture
+
+static void set_back_texcoords(float u1, float v1, float u2, float v2)
+{
+    const float coords[12] = {
+        u1, v1,
+        u2, v1,
+        u2, v2,
+
+        u2, v2,
+        u1, v2,
+        u1, v1
+    };
+#ifdef CHOWDREN_USE_D3D
+    for (int i = 0; i < 6; ++i) {
+        render_data.vertices[i].texcoord2[0] = coords[i*2];
+        render_data.vertices[i].texcoord2[1] = coords[i*2+1];
+    }
+#else
+    memcpy(render_texcoords2, coords, sizeof(coords));
+#endif
+}
+
+void Render::begin_back_capture(int x1, int y1, int x2, int y2)
+{
+    if (x2 <= x1 || y2 <= y1)
+        return;
+    copy_rect(x1, y1, x2, y2);
+    stats.back_copies++;
+    render_data.back_capture = true;
+    render_data.back_box[0] = x1;
+    render_data.back_box[1] = y1;
+    render_data.back_box[2] = x2;
+    render_data.back_box[3] = y2;
+}
+
+void Render::end_back_capture()
+{
+    render_data.back_capture = false;
+}
+
+Texture Render::get_back_tex(int box[4])
+{
+    int * c = render_data.back_box;
+    if (render_data.back_capture && contains(c, box)) {
+        // the capture is flipped vertically, like a regular copy_rect
+        float w = float(c[2] - c[0]);
+        float h = float(c[3] - c[1]);
+        set_back_texcoords((box[0] - c[0]) / w, (c[3] - box[1]) / h,
+                           (box[2] - c[0]) / w, (c[3] - box[3]) / h);
+        stats.back_shared++;
+        return render_data.back_tex;
+    }
+
+    set_back_texcoords(0.0f, 1.0f, 1.0f, 0.0f);
+    stats.back_copies++;
+    return copy_rect(box[0], box[1], box[2], box[3]);
+}
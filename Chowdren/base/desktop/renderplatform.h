@@ -7,8 +7,10 @@
 #include <string.h>
 #include "glslshader.h"
 
-// XXX consider merging drawcalls
-#define RENDER_BUFFER 1
+// number of quads that fit in the vertex buffer. single draws only use the
+// first one, runs of quads with one texture (Render::draw_tex_run) are
+// drawn RENDER_BUFFER quads at a time
+#define RENDER_BUFFER 16
 
 #ifdef CHOWDREN_USE_D3D
 struct TextureData
@@ -36,7 +38,7 @@ struct RenderData
         float texcoord2[2];
     };
 
-    Vertex vertices[6];
+    Vertex vertices[RENDER_BUFFER * 6];
     D3DTEXTUREFILTERTYPE last_sampler;
     bool has_sse2;
     int backtex_width, backtex_height;
@@ -46,6 +48,8 @@ struct RenderData
     float texcoord1[(RENDER_BUFFER * 2) * 6];
 #endif
     Texture last_tex, white_tex, back_tex;
+    bool back_capture;
+    int back_box[4];
     int effect;
     float adjust_x, adjust_y;
     float trans_x, trans_y;
@@ -112,6 +116,14 @@ inline void Render::set_view(int x, int y, int w, int h)
     render_data.viewport[3] = h;
 }
 
+inline void Render::get_view(int view[4])
+{
+    view[0] = render_data.viewport[0];
+    view[1] = render_data.viewport[1];
+    view[2] = render_data.viewport[2];
+    view[3] = render_data.viewport[3];
+}
+
 inline void Render::clear(Color c)
 {
 #ifdef CHOWDREN_USE_D3D
@@ -168,6 +180,31 @@ inline Texture Render::create_tex(void * pixels, Format f,
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     return tex;
 }
+
+inline void Render::update_tex(Texture tex, void * pixels, int pitch,
+                               int x, int y, int w, int h)
+{
+    set_tex(tex);
+#ifdef CHOWDREN_USE_GLES2
+    // no GL_UNPACK_ROW_LENGTH, so partial rows go up one at a time
+    if (pitch == w) {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, w, h, GL_RGBA,
+                        GL_UNSIGNED_BYTE, pixels);
+        return;
+    }
+    unsigned int * row = (unsigned int*)pixels;
+    for (int i = 0; i < h; ++i) {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, x, y + i, w, 1, GL_RGBA,
+                        GL_UNSIGNED_BYTE, row);
+        row += pitch;
+    }
+#else
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, pitch);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, w, h, GL_RGBA, GL_UNSIGNED_BYTE,
+                    pixels);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+#endif
+}
 #endif
 
 inline void Render::delete_tex(Texture tex)
@@ -222,14 +259,14 @@ inline void insert_quad(float * p)
     pp[5].pos[1] = y1;
 }
 
-inline void insert_quad(int x1, int y1, int x2, int y2)
+inline void insert_quad(int x1, int y1, int x2, int y2, int index = 0)
 {
     float fx1 = transform_x(x1);
     float fx2 = transform_x(x2);
     float fy1 = transform_y(y1);
     float fy2 = transform_y(y2);
 
-    RenderData::Vertex * p = &render_data.vertices[0];
+    RenderData::Vertex * p = &render_data.vertices[index * 6];
 
     // 1
     p[0].pos[0] = fx1; p[0].pos[1] = fy1;
@@ -242,12 +279,12 @@ inline void insert_quad(int x1, int y1, int x2, int y2)
     p[5].pos[0] = fx1; p[5].pos[1] = fy1;
 }
 
-inline void insert_color(Color c)
+inline void insert_color(Color c, int quads = 1)
 {
     unsigned int cc = D3DCOLOR_ARGB(c.a, c.r, c.g, c.b);
 
     RenderData::Vertex * p = &render_data.vertices[0];
-    for (int i = 0; i < 6; ++i)
+    for (int i = 0; i < quads * 6; ++i)
         p[i].color = cc;
 }
 
@@ -289,9 +326,10 @@ inline void insert_texcoord1()
     }
 }
 
-inline void insert_texcoord1(float fx1, float fy1, float fx2, float fy2)
+inline void insert_texcoord1(float fx1, float fy1, float fx2, float fy2,
+                             int index = 0)
 {
-    RenderData::Vertex * p = &render_data.vertices[0];
+    RenderData::Vertex * p = &render_data.vertices[index * 6];
 
     // 1
     p->texcoord1[0] = fx1; p->texcoord1[1] = fy1; p++;
@@ -333,14 +371,14 @@ inline void insert_quad(float * p)
     *pp++ = y1;
 }
 
-inline void insert_quad(int x1, int y1, int x2, int y2)
+inline void insert_quad(int x1, int y1, int x2, int y2, int index = 0)
 {
     float fx1 = transform_x(x1);
     float fx2 = transform_x(x2);
     float fy1 = transform_y(y1);
     float fy2 = transform_y(y2);
 
-    float * p = &render_data.positions[0];
+    float * p = &render_data.positions[index * 12];
 
     // 1
     *p++ = fx1; *p++ = fy1;
@@ -353,14 +391,14 @@ inline void insert_quad(int x1, int y1, int x2, int y2)
     *p++ = fx1; *p++ = fy1;
 }
 
-inline void insert_color(Color c)
+inline void insert_color(Color c, int quads = 1)
 {
     unsigned int cc;
     // rely on endianness
     memcpy(&cc, &c, sizeof(Color));
 
     unsigned int * p = &render_data.colors[0];
-    for (int i = 0; i < 6; ++i)
+    for (int i = 0; i < quads * 6; ++i)
         *p++ = cc;
 }
 
@@ -403,9 +441,10 @@ inline void insert_texcoord1()
            sizeof(render_texcoords));
 }
 
-inline void insert_texcoord1(float fx1, float fy1, float fx2, float fy2)
+inline void insert_texcoord1(float fx1, float fy1, float fx2, float fy2,
+                             int index = 0)
 {
-    float * p = &render_data.texcoord1[0];
+    float * p = &render_data.texcoord1[index * 12];
 
     // 1
     *p++ = fx1; *p++ = fy1;
@@ -454,14 +493,27 @@ inline void Render::draw_quad(float * p, Color c)
 }
 
 #ifdef CHOWDREN_USE_D3D
-inline void draw_tex_impl(Texture t)
+inline void draw_tex_impl(Texture t, int quads = 1)
 {
-    render_data.device->DrawPrimitiveUP(D3DPT_TRIANGLELIST, 2,
+    render_data.device->DrawPrimitiveUP(D3DPT_TRIANGLELIST, quads * 2,
                                         &render_data.vertices[0],
                                         sizeof(RenderData::Vertex));
 }
 #endif
 
+// quads is the number of image tiles the draw call covers, so repeated
+// draws can be compared against the per-tile path in the stats
+inline void flush_draw(Texture t, unsigned int quads = 1)
+{
+    Render::stats.draw_calls++;
+    Render::stats.quads += quads;
+#ifdef CHOWDREN_USE_D3D
+    draw_tex_impl(t);
+#else
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+#endif
+}
+
 inline void Render::draw_tex(int x1, int y1, int x2, int y2, Color c,
                              Texture t)
 {
@@ -471,11 +523,7 @@ inline void Render::draw_tex(int x1, int y1, int x2, int y2, Color c,
     insert_color(c);
     insert_texcoord1();
 
-#ifdef CHOWDREN_USE_D3D
-    draw_tex_impl(t);
-#else
-    glDrawArrays(GL_TRIANGLES, 0, 6);
-#endif
+    flush_draw(t);
 }
 
 inline void Render::draw_tex(int x1, int y1, int x2, int y2, Color c,
@@ -488,11 +536,7 @@ inline void Render::draw_tex(int x1, int y1, int x2, int y2, Color c,
     insert_color(c);
     insert_texcoord1(tx1, ty1, tx2, ty2);
 
-#ifdef CHOWDREN_USE_D3D
-    draw_tex_impl(t);
-#else
-    glDrawArrays(GL_TRIANGLES, 0, 6);
-#endif
+    flush_draw(t);
 }
 
 inline void Render::draw_tex(float * p, Color c, Texture t)
@@ -503,13 +547,75 @@ inline void Render::draw_tex(float * p, Color c, Texture t)
     insert_texcoord1();
     insert_quad(p);
 
+    flush_draw(t);
+}
+
+inline bool Render::draw_tex_repeat(int x1, int y1, int x2, int y2, Color c,
+                                    Texture t,
+                                    float tx1, float ty1, float tx2, float ty2,
+                                    unsigned int tiles)
+{
+#ifdef CHOWDREN_USE_GLES2
+    // NPOT textures cannot use GL_REPEAT on GLES2
+    return false;
+#else
+    begin_draw(t);
+
+    insert_quad(x1, y1, x2, y2);
+    insert_color(c);
+    insert_texcoord1(tx1, ty1, tx2, ty2);
+
 #ifdef CHOWDREN_USE_D3D
-    draw_tex_impl(t);
+    int sampler = BaseShader::current->tex_sampler;
+    render_data.device->SetSamplerState(sampler, D3DSAMP_ADDRESSU,
+                                        D3DTADDRESS_WRAP);
+    render_data.device->SetSamplerState(sampler, D3DSAMP_ADDRESSV,
+                                        D3DTADDRESS_WRAP);
+    flush_draw(t, tiles);
+    render_data.device->SetSamplerState(sampler, D3DSAMP_ADDRESSU,
+                                        D3DTADDRESS_CLAMP);
+    render_data.device->SetSamplerState(sampler, D3DSAMP_ADDRESSV,
+                                        D3DTADDRESS_CLAMP);
 #else
-    glDrawArrays(GL_TRIANGLES, 0, 6);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    flush_draw(t, tiles);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+#endif
+    return true;
 #endif
 }
 
+inline void Render::draw_tex_run(int x, int y, const int * boxes,
+                                 const float * texcoords, int count,
+                                 Color c, Texture t)
+{
+    begin_draw(t);
+    insert_color(c, std::min(count, RENDER_BUFFER));
+
+    while (count > 0) {
+        int quads = std::min(count, RENDER_BUFFER);
+        for (int i = 0; i < quads; ++i) {
+            insert_quad(x + boxes[0], y + boxes[1],
+                        x + boxes[2], y + boxes[3], i);
+            insert_texcoord1(texcoords[0], texcoords[1],
+                             texcoords[2], texcoords[3], i);
+            boxes += 4;
+            texcoords += 4;
+        }
+        count -= quads;
+
+        Render::stats.draw_calls++;
+        Render::stats.quads += quads;
+#ifdef CHOWDREN_USE_D3D
+        draw_tex_impl(t, quads);
+#else
+        glDrawArrays(GL_TRIANGLES, 0, quads * 6);
+#endif
+    }
+}
+
 inline void Render::draw_horizontal_gradient(int x1, int y1, int x2, int y2,
                                              Color c1, Color c2)
 {
@@ -519,11 +625,7 @@ inline void Render::draw_horizontal_gradient(int x1, int y1, int x2, int y2,
     insert_horizontal_color(c1, c2);
     insert_texcoord1();
 
-#ifdef CHOWDREN_USE_D3D
-    draw_tex_impl(render_data.white_tex);
-#else
-    glDrawArrays(GL_TRIANGLES, 0, 6);
-#endif
+    flush_draw(render_data.white_tex);
 }
 
 inline void Render::draw_vertical_gradient(int x1, int y1, int x2, int y2,
@@ -535,11 +637,7 @@ inline void Render::draw_vertical_gradient(int x1, int y1, int x2, int y2,
     insert_vertical_color(c1, c2);
     insert_texcoord1();
 
-#ifdef CHOWDREN_USE_D3D
-    draw_tex_impl(render_data.white_tex);
-#else
-    glDrawArrays(GL_TRIANGLES, 0, 6);
-#endif
+    flush_draw(render_data.white_tex);
 }
 
 inline void Render::set_effect(int effect, FrameObject * obj,
@@ -568,6 +666,7 @@ inline Texture Render::copy_rect(int x1, int y1, int x2, int y2)
     int height = y2 - y1;
 
     int y = WINDOW_HEIGHT - y2;
+    render_data.back_capture = false;
     set_tex(render_data.back_tex);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height,
                  0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
@@ -8,16 +8,21 @@
 
 #include "types.h"
 #include <list>
+#include <stdlib.h>
 #include "broadphase.h"
 #include "frameobject.h"
 #include "color.h"
 #include "instancemap.h"
 #include "bitarray.h"
 
-#ifdef CHOWDREN_PASTE_CACHE
+#if defined(CHOWDREN_PASTE_CACHE) || defined(CHOWDREN_LAYER_CACHE)
 #include "fbo.h"
 #endif
 
+#ifdef CHOWDREN_FRAME_SNAPSHOT
+#include "snapshot.h"
+#endif
+
 class Background;
 class BackgroundItem;
 class CollisionBase;
@@ -27,6 +32,32 @@ typedef boost::intrusive::member_hook<FrameObject, LayerPos,
                                       &FrameObject::layer_pos> LayerHook;
 typedef boost::intrusive::list<FrameObject, LayerHook> LayerInstances;
 
+#ifdef CHOWDREN_LAYER_CACHE
+// number of window-sized tiles kept per cached layer
+#define LAYER_CACHE_TILES 4
+// number of unchanged frames before a layer is drawn from its cache
+#define LAYER_CACHE_DELAY 2
+
+class LayerCache
+{
+public:
+    struct Tile
+    {
+        int x, y;
+        int draws;
+        bool valid;
+        bool used;
+        Framebuffer fbo;
+    };
+
+    Tile tiles[LAYER_CACHE_TILES];
+    bool disabled;
+
+    LayerCache();
+    void invalidate();
+};
+#endif
+
 class Layer
 {
 public:
@@ -50,6 +81,12 @@ public:
     float depth;
 #endif
 
+#ifdef CHOWDREN_LAYER_CACHE
+    LayerCache * cache;
+    bool cache_dirty;
+    int cache_frames;
+#endif
+
     Layer();
     Layer(int index, double coeff_x, double coeff_y, bool visible,
           bool wrap_x, bool wrap_y);
@@ -78,10 +115,21 @@ public:
                int src_x, int src_y, int src_width, int src_height,
                int collision_type, int effect, const Color & color);
     void draw(int off_x, int off_y);
+    int draw_instances(int v[4]);
     void set_visible(bool value);
     void show();
     void hide();
 
+#ifdef CHOWDREN_LAYER_CACHE
+    void invalidate_cache()
+    {
+        cache_dirty = true;
+    }
+
+    bool draw_cache(int v[4]);
+    void draw_tile(LayerCache::Tile & tile);
+#endif
+
 #ifdef CHOWDREN_HAS_MRT
     int remote;
     void set_remote(int value);
@@ -152,7 +200,30 @@ public:
     }
 };
 
-typedef hash_map<std::string, DynamicLoop> DynamicLoops;
+// generated perfect hash that maps a loop name to its index in the frame's
+// dynamic loop table, or -1 if no such loop exists
+typedef int (*DynamicLoopHash)(const char * str, unsigned int len);
+
+// used for "prefix" + Str$(n) loop names, returns false if the value would
+// not turn into an integer string
+template <class T>
+inline bool get_loop_number(T value, int & out)
+{
+    out = int(value);
+    return out == value;
+}
+
+inline bool get_loop_number(const std::string & value, int & out)
+{
+    if (value.empty())
+        return false;
+    char * end;
+    out = int(strtol(value.c_str(), &end, 10));
+    if (*end != '\0')
+        return false;
+    // reject forms like "01" or "+1" that don't match the generated names
+    return number_to_string(out) == value;
+}
 
 class GameManager;
 class GlobalValues;
@@ -173,6 +244,10 @@ public:
     virtual void on_app_end();
     virtual void handle_events();
     virtual void handle_pre_events();
+#ifdef CHOWDREN_FRAME_SNAPSHOT
+    virtual void save_state(FrameSnapshot & snapshot);
+    virtual void load_state(FrameSnapshot & snapshot);
+#endif
 };
 
 
@@ -181,11 +256,15 @@ class Frame
 public:
     typedef void (Frame::*EventFunction)();
 
+    // declared first, so instances held by the other members are destroyed
+    // before their memory
+    FrameArena arena;
     int width, height;
     int virtual_width, virtual_height;
     int index;
     Color background_color;
-    DynamicLoops * loops;
+    DynamicLoop * loops;
+    DynamicLoopHash loop_hash;
     FrameData * data;
     InstanceMap instances;
     FlatObjectList destroyed_instances;
@@ -209,6 +288,20 @@ public:
     FrameObject * col_instance_1;
     FrameObject * col_instance_2;
 
+#ifdef CHOWDREN_FRAME_SNAPSHOT
+    // instances destroyed while a snapshot refers to them. snapshot_id
+    // changes when instances a snapshot may refer to are freed
+    FlatObjectList parked_instances;
+    unsigned int snapshot_id;
+    // taken after the frame is set up, and restored on a frame restart
+    FrameSnapshot restart_snapshot;
+    bool restarted;
+
+    void park_instance(FrameObject * instance);
+    void free_parked_instances();
+    bool restart_from_snapshot();
+#endif
+
     Frame();
     void reset();
     bool update();
@@ -220,6 +313,7 @@ public:
     FrameObject * add_object(FrameObject * object, Layer * layer);
     void add_background_object(FrameObject * object, int layer_index);
     void set_object_layer(FrameObject * object, int new_layer);
+    DynamicLoop * find_loop(const std::string & name);
     int get_loop_index(const std::string & name);
     void set_timer(double value);
     void set_lives(int lives);
@@ -24,6 +24,7 @@ class Image;
 class FrameObject;
 class Movement;
 class Layer;
+class FrameSnapshot;
 
 class FixedValue
 {
@@ -110,6 +111,8 @@ enum ObjectFlags
     REPEAT_BACK_COLLISION = (1 << 11),
     LAYER_VISIBLE = (1 << 12),
     DISABLE_COL = (1 << 13),
+    ARENA = (1 << 14),
+    SNAPSHOT = (1 << 15),
 
     ALL_VISIBLE = VISIBLE | LAYER_VISIBLE
 };
@@ -252,8 +255,10 @@ typedef boost::intrusive::list_member_hook<LinkMode> LayerPos;
 #define FRAMEOBJECT_HEAD(X) static ObjectPool<X> pool; \
                             void dealloc() \
                             { \
+                                bool in_arena = (flags & ARENA) != 0; \
                                 this->X::~X(); \
-                                pool.destroy(this); \
+                                if (!in_arena) \
+                                    pool.destroy(this); \
                             };
 
 #define FRAMEOBJECT_IMPL(X) ObjectPool<X> X::pool;
@@ -346,8 +351,10 @@ public:
     virtual ~FrameObject();
     virtual void dealloc()
     {
+        bool in_arena = (flags & ARENA) != 0;
         this->FrameObject::~FrameObject();
-        pool.destroy(this);
+        if (!in_arena)
+            pool.destroy(this);
     }
 
     FrameObject(int x, int y, int type_id);
@@ -384,6 +391,7 @@ public:
     void set_layer(int layer);
     void set_shader(int effect);
     void set_shader_parameter(const std::string & name, double value);
+    void set_shader_parameter(unsigned int hash, double value);
     void set_shader_parameter(const std::string & name, Image & image);
     void set_shader_parameter(const std::string & name, const Color & color);
     void set_shader_parameter(const std::string & name,
@@ -419,6 +427,13 @@ public:
     virtual void set_animation(int value);
     virtual void set_backdrop_offset(int dx, int dy);
     void get_screen_aabb(int box[4]);
+#ifdef CHOWDREN_FRAME_SNAPSHOT
+    virtual void save_state(FrameSnapshot & snapshot);
+    virtual void load_state(FrameSnapshot & snapshot);
+#endif
+#ifdef CHOWDREN_LAYER_CACHE
+    void invalidate_layer_cache();
+#endif
     void update_inactive();
     void update_kill();
     bool is_near_border(int border);
@@ -467,6 +482,20 @@ public:
 #endif
 };
 
+// instances created while a frame sets up its startup instances come from
+// the frame arena instead of the pool of the type
+
+template <class T, class P>
+inline FrameObject * create_instance(ObjectPool<P> & pool, int x, int y)
+{
+    FrameArena * arena = FrameArena::current;
+    if (arena == NULL)
+        return new (pool.create()) T(x, y);
+    FrameObject * obj = new (arena->allocate(sizeof(T))) T(x, y);
+    obj->flags |= ARENA;
+    return obj;
+}
+
 typedef vector<FrameObject*> FlatObjectList;
 
 #define LAST_SELECTED 0
@@ -500,6 +529,12 @@ When the current selection is cleared, the first item points to the end of
 the array, so the most recently added instance is always iterated first.
 The next instance will be set to current_index-1, etc., until the first item
 is met. The first item is then always the last item pointed to by another item.
+
+Since clearing the selection happens for almost every event, it does not
+write these links. Instead, all_selected is set, and the links up to the
+start of the list are implied to be current_index-1. Iterators walk down the
+indices directly in that state, and the links are only written out by
+materialize() when something actually changes the selection.
 */
 
 class ObjectList
@@ -510,9 +545,10 @@ public:
     typedef ObjectListItems::iterator iterator;
     unsigned int saved_start;
     vector<int> saved_items;
+    bool all_selected;
 
     ObjectList()
-    : back_obj(NULL)
+    : back_obj(NULL), all_selected(false)
     {
         items.resize(1);
         ObjectListItem & item = items[0];
@@ -545,6 +581,11 @@ public:
     void add_back()
     {
         int i = items.size() - 1;
+        if (all_selected && items[0].next == (unsigned int)(i-1)) {
+            items[0].next = i;
+            return;
+        }
+        materialize();
         ObjectListItem & item = items[i];
         item.next = items[0].next;
         items[0].next = i;
@@ -552,18 +593,27 @@ public:
 
     ObjectList & clear_selection()
     {
-        int size = items.size();
-        items[0].next = size-1;
-        for (int i = 1; i < size; i++)
-            items[i].next = i-1;
+        items[0].next = items.size()-1;
+        all_selected = true;
         return *this;
     }
 
+    void materialize()
+    {
+        if (!all_selected)
+            return;
+        all_selected = false;
+        int start = items[0].next;
+        for (int i = 1; i <= start; i++)
+            items[i].next = i-1;
+    }
+
     int get_selection_size();
 
     void empty_selection()
     {
         items[0].next = LAST_SELECTED;
+        all_selected = false;
     }
 
     bool has_selection() const
@@ -610,6 +660,7 @@ public:
         back_obj = NULL;
         items.resize(1);
         items[0].next = LAST_SELECTED;
+        all_selected = false;
     }
 
     void remove(FrameObject * obj)
@@ -621,12 +672,15 @@ public:
 
         items.resize(items.size()-1);
         back_obj = items.back().obj;
+        if (all_selected && items[0].next >= items.size())
+            items[0].next = items.size()-1;
     }
 
     void select_single(FrameObject * obj)
     {
         items[0].next = obj->index;
         items[obj->index].next = LAST_SELECTED;
+        all_selected = false;
     }
 
     void save_selection();
@@ -638,6 +692,7 @@ public:
 class ObjectIterator
 {
 public:
+    ObjectList * list;
     ObjectListItem * items;
     int index;
     int last;
@@ -648,7 +703,8 @@ public:
 #endif
 
     ObjectIterator(ObjectList & list)
-    : items(&list.items[0]), index(list.items[0].next), last(0), selected(true)
+    : list(&list), items(&list.items[0]), index(list.items[0].next), last(0),
+      selected(true)
     {
 #ifdef CHOWDREN_ITER_INDEX
         current_index = 0;
@@ -666,8 +722,10 @@ public:
         current_index++;
 #endif
 
+        // all_selected is read for every step, since a nested iterator or
+        // an action may change the selection while this one walks it
         last = selected ? index : last;
-        index = items[index].next;
+        index = list->all_selected ? index - 1 : items[index].next;
         selected = true;
     }
 
@@ -678,6 +736,7 @@ public:
 
     void deselect()
     {
+        list->materialize();
         selected = false;
         items[last].next = items[index].next;
     }
@@ -691,6 +750,7 @@ public:
     {
         items[0].next = index;
         items[index].next = LAST_SELECTED;
+        list->all_selected = false;
     }
 };
 
@@ -878,6 +938,7 @@ class QualifierIterator
 {
 public:
     ObjectList ** lists;
+    ObjectList * list;
     ObjectListItem * items;
     int list_index;
     int index;
@@ -905,7 +966,7 @@ public:
     void next_list()
     {
         while (true) {
-            ObjectList * list = lists[list_index];
+            list = lists[list_index];
             if (list == NULL) {
                 items = NULL;
                 break;
@@ -924,7 +985,7 @@ public:
         current_index++;
 #endif
         last = selected ? index : last;
-        index = items[index].next;
+        index = list->all_selected ? index - 1 : items[index].next;
         selected = true;
         if (index != LAST_SELECTED)
             return;
@@ -940,6 +1001,7 @@ public:
 
     void deselect()
     {
+        list->materialize();
         selected = false;
         items[last].next = items[index].next;
     }
@@ -962,6 +1024,7 @@ public:
         }
         items[0].next = index;
         items[index].next = LAST_SELECTED;
+        list->all_selected = false;
     }
 };
 
@@ -1024,6 +1087,7 @@ inline void ObjectList::save_selection()
 
 inline void ObjectList::restore_selection()
 {
+    all_selected = false;
     items[0].next = saved_start;
     int last = saved_start;
     for (int i = saved_start-1; i >= 1; i--) {
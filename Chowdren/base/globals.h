@@ -3,16 +3,38 @@
 
 #include "types.h"
 #include "stringcommon.h"
+#include "internstring.h"
 #include <string>
 #include "dynnum.h"
 
+// change stamps are taken from a single counter, so a stamp can be compared
+// against any stamp taken before it. indices that have not been set since
+// the container was created use the stamp of the container itself.
+
+extern uint64_t global_change_stamp;
+
+inline uint64_t next_change_stamp()
+{
+    return ++global_change_stamp;
+}
+
 class GlobalValues
 {
 public:
     vector<DynamicNumber> values;
+    vector<uint64_t> stamps;
+    uint64_t base_stamp;
 
     GlobalValues()
+    : base_stamp(next_change_stamp())
+    {
+    }
+
+    uint64_t get_stamp(size_t index)
     {
+        if (index >= stamps.size())
+            return base_stamp;
+        return stamps[index];
     }
 
     DynamicNumber get(size_t index)
@@ -33,8 +55,10 @@ public:
     {
         if (index >= values.size()) {
             values.resize(index + 1);
+            stamps.resize(index + 1, base_stamp);
         }
         values[index] = value;
+        stamps[index] = next_change_stamp();
     }
 
     void add(size_t index, DynamicNumber value)
@@ -51,10 +75,20 @@ public:
 class GlobalStrings
 {
 public:
-    vector<std::string> values;
+    vector<InternString> values;
+    vector<uint64_t> stamps;
+    uint64_t base_stamp;
 
     GlobalStrings()
+    : base_stamp(next_change_stamp())
+    {
+    }
+
+    uint64_t get_stamp(size_t index)
     {
+        if (index >= stamps.size())
+            return base_stamp;
+        return stamps[index];
     }
 
     const std::string & get(size_t index)
@@ -62,15 +96,71 @@ public:
         if (index >= values.size()) {
             return empty_string;
         }
+        return values[index].get();
+    }
+
+    const InternString & get_intern(size_t index)
+    {
+        if (index >= values.size())
+            return empty_intern;
         return values[index];
     }
 
     void set(size_t index, const std::string & value)
     {
-        if (index >= values.size())
+        if (index >= values.size()) {
             values.resize(index + 1);
-        values[index] = value;
+            stamps.resize(index + 1, base_stamp);
+        }
+        values[index].set(value);
+        stamps[index] = next_change_stamp();
     }
 };
 
+// the inputs of an event group were unchanged since its last evaluation if
+// none of their stamps are newer than the stamp taken before it. the stamp is
+// only kept if the conditions failed, so the group can be skipped. stamps
+// taken before the current frame was set or restarted are never valid.
+
+extern uint64_t event_stamp_start;
+
+inline void reset_event_stamps()
+{
+    event_stamp_start = next_change_stamp();
+}
+
+class EventStamp
+{
+public:
+    GlobalValues * values;
+    GlobalStrings * strings;
+    uint64_t stamp;
+
+    EventStamp()
+    : values(NULL), strings(NULL), stamp(0)
+    {
+    }
+
+    bool is_valid(GlobalValues * values, GlobalStrings * strings)
+    {
+        return stamp != 0 && stamp >= event_stamp_start &&
+               this->values == values && this->strings == strings;
+    }
+
+    void start(GlobalValues * values, GlobalStrings * strings)
+    {
+        this->values = values;
+        this->strings = strings;
+        stamp = global_change_stamp;
+    }
+
+    void invalidate()
+    {
+        stamp = 0;
+    }
+};
+
+extern unsigned int event_check_count;
+extern unsigned int event_skip_count;
+
 #endif // GLOBALS_H
@@ -0,0 +1,106 @@
+#include "glyphset.h"
+#include <algorithm>
+#include <stdlib.h>
+#include <string.h>
+
+typedef hash_map<Image**, GlyphSet*> GlyphSetMap;
+
+// never freed, since images in static objects may be unloaded after the
+// map would have been destroyed
+
+static GlyphSetMap & get_glyph_sets()
+{
+    static GlyphSetMap * sets = new GlyphSetMap;
+    return *sets;
+}
+
+static unsigned int last_glyph_set_id = 0;
+
+static GlyphSet * create_glyph_set(Image ** images, int count)
+{
+    GlyphSet * set = new GlyphSet;
+    set->images = images;
+    set->count = count;
+    set->id = ++last_glyph_set_id;
+    set->tex = 0;
+
+    // decoded copies, since the texture upload frees the pixels of the
+    // images themselves
+    Image * copies[MAX_GLYPHS];
+    int width = 0;
+    int height = 0;
+    bool valid = true;
+    for (int i = 0; i < count; ++i) {
+        Image * image = images[i]->copy();
+        copies[i] = image;
+        if (image->image == NULL)
+            valid = false;
+        // leave a column between glyphs, so filtering does not bleed
+        width += image->width + 1;
+        height = std::max<int>(height, image->height);
+    }
+
+    if (valid && width > 0 && height > 0) {
+        unsigned int * pixels = (unsigned int*)calloc(width * height,
+                                                      sizeof(unsigned int));
+        int x = 0;
+        for (int i = 0; i < count; ++i) {
+            Image * image = copies[i];
+            int w = image->width;
+            int h = image->height;
+            unsigned int * src = (unsigned int*)image->image;
+            for (int y = 0; y < h; ++y)
+                memcpy(pixels + y * width + x, src + y * w,
+                       w * sizeof(unsigned int));
+            set->width[i] = w;
+            set->height[i] = h;
+            set->coords[i][0] = x / float(width);
+            set->coords[i][1] = 0.0f;
+            set->coords[i][2] = (x + w) / float(width);
+            set->coords[i][3] = h / float(height);
+            x += w + 1;
+        }
+        set->tex = Render::create_tex(pixels, Render::RGBA, width, height);
+        Render::set_filter(set->tex,
+                           (images[0]->flags & Image::LINEAR_FILTER) != 0);
+        free(pixels);
+    }
+
+    for (int i = 0; i < count; ++i) {
+        delete copies[i];
+        // a set that could not be made is also dropped with its images, so
+        // it is tried again once they load
+        images[i]->flags |= Image::GLYPHS;
+    }
+    return set;
+}
+
+GlyphSet * get_glyph_set(Image ** images, int count)
+{
+    GlyphSetMap & sets = get_glyph_sets();
+    GlyphSetMap::const_iterator it = sets.find(images);
+    if (it != sets.end())
+        return it->second;
+    GlyphSet * set = create_glyph_set(images, count);
+    sets[images] = set;
+    return set;
+}
+
+void free_glyph_sets(Image * image)
+{
+    image->flags &= ~Image::GLYPHS;
+    GlyphSetMap & sets = get_glyph_sets();
+    GlyphSetMap::iterator it = sets.begin();
+    while (it != sets.end()) {
+        GlyphSet * set = it->second;
+        Image ** end = set->images + set->count;
+        if (std::find(set->images, end, image) == end) {
+            ++it;
+            continue;
+        }
+        if (set->tex != 0)
+            Render::delete_tex(set->tex);
+        delete set;
+        it = sets.erase(it);
+    }
+}
@@ -0,0 +1,42 @@
+#ifndef CHOWDREN_GLYPHSET_H
+#define CHOWDREN_GLYPHSET_H
+
+#include "image.h"
+
+// images packed into one texture, so a string of them can be drawn as a
+// single run of quads. there is one set per image list, kept until one of
+// its images is unloaded or changed. every set gets a new id, so users can
+// tell when the set of a list was made again
+
+#define MAX_GLYPHS 16
+
+struct GlyphSet
+{
+    Image ** images;
+    int count;
+    unsigned int id;
+    Texture tex;
+    short width[MAX_GLYPHS], height[MAX_GLYPHS];
+    float coords[MAX_GLYPHS][4];
+
+    // adds the quad of a glyph with its right edge at x, and moves x to its
+    // left edge. the quad sits on y = 0, like an image with its hotspot at
+    // the bottom right
+    void add_left(int index, int & x, vector<int> & boxes,
+                  vector<float> & texcoords)
+    {
+        int w = width[index];
+        int h = height[index];
+        boxes.push_back(x - w);
+        boxes.push_back(-h);
+        boxes.push_back(x);
+        boxes.push_back(0);
+        texcoords.insert(texcoords.end(), coords[index], coords[index] + 4);
+        x -= w;
+    }
+};
+
+GlyphSet * get_glyph_set(Image ** images, int count);
+void free_glyph_sets(Image * image);
+
+#endif // CHOWDREN_GLYPHSET_H
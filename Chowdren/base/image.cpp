@@ -10,6 +10,8 @@
 #include "mathcommon.h"
 #include "assetfile.h"
 #include "render.h"
+#include "blockcodec.h"
+#include "glyphset.h"
 
 #define STBI_NO_STDIO
 #define STBI_NO_HDR
@@ -110,8 +112,14 @@ void Image::set_static()
     flags |= STATIC;
 }
 
+#ifdef CHOWDREN_IMAGE_STATS
+static double decode_time = 0.0;
+static unsigned int decode_in = 0;
+static unsigned int decode_out = 0;
+#endif
+
 template <typename T>
-inline void load_image_info(Image & image, T & stream,
+inline void load_image_info(Image & image, T & stream, int & codec,
                             unsigned int & size, unsigned int & out_size)
 {
     image.width = stream.read_uint16();
@@ -120,11 +128,29 @@ inline void load_image_info(Image & image, T & stream,
     image.hotspot_y = stream.read_int16();
     image.action_x = stream.read_int16();
     image.action_y = stream.read_int16();
+    codec = stream.read_uint8();
     size = stream.read_uint32();
     out_size = image.width * image.height * 4;
     image.image = (unsigned char*)STBI_MALLOC(out_size);
 }
 
+static int decode_image(Image & image, AssetFile & fp, int & codec)
+{
+    fp.set_item(image.handle, AssetFile::IMAGE_DATA);
+    FileStream stream(fp);
+    unsigned int size, out_size;
+    load_image_info(image, stream, codec, size, out_size);
+    unsigned char * buf = new unsigned char[size];
+    fp.read(buf, size);
+    int ret = decode_block(codec, buf, size, image.image, out_size);
+    delete[] buf;
+#ifdef CHOWDREN_IMAGE_STATS
+    decode_in += size;
+    decode_out += out_size;
+#endif
+    return ret;
+}
+
 void Image::load()
 {
     flags |= USED;
@@ -137,9 +163,13 @@ void Image::load()
         return;
     }
 
+    int codec;
     unsigned int size, out_size;
     unsigned char * buf;
     int ret;
+#ifdef CHOWDREN_IMAGE_STATS
+    double start_time = platform_get_time();
+#endif
     if (startup_data) {
         unsigned int start = AssetFile::get_offset(0, AssetFile::IMAGE_DATA);
         unsigned int self = AssetFile::get_offset(handle,
@@ -147,32 +177,48 @@ void Image::load()
         unsigned int offset = self - start;
         ArrayStream stream((char*)startup_data, startup_size);
         stream.seek(offset);
-        load_image_info(*this, stream, size, out_size);
+        load_image_info(*this, stream, codec, size, out_size);
         buf = &startup_data[stream.pos];
-        ret = stbi_zlib_decode_buffer((char*)image, out_size,
-                                      (const char*)buf, size);
+        ret = decode_block(codec, buf, size, image, out_size);
+#ifdef CHOWDREN_IMAGE_STATS
+        decode_in += size;
+        decode_out += out_size;
+#endif
     } else {
         open_image_file();
-        image_file.set_item(handle, AssetFile::IMAGE_DATA);
-        FileStream stream(image_file);
-        load_image_info(*this, stream, size, out_size);
-        buf = new unsigned char[size];
-        image_file.read(buf, size);
-        ret = stbi_zlib_decode_buffer((char*)image, out_size,
-                                      (const char*)buf, size);
-        delete[] buf;
+        ret = decode_image(*this, image_file, codec);
     }
 
+#ifdef CHOWDREN_IMAGE_STATS
+    decode_time += platform_get_time() - start_time;
+#endif
+
     if (ret < 0) {
         std::cout << "Could not load image " << handle << std::endl;
-        std::cout << stbi_failure_reason() << std::endl;
+        if (codec == ZLIB_CODEC)
+            std::cout << stbi_failure_reason() << std::endl;
+        else
+            std::cout << "Invalid block for codec " << codec << std::endl;
         stbi_image_free(image);
         image = NULL;
     }
 }
 
+void print_image_stats()
+{
+#ifdef CHOWDREN_IMAGE_STATS
+    double mb_out = decode_out / (1024.0 * 1024.0);
+    std::cout << "Image decode: " << decode_in << " -> " << decode_out
+        << " bytes in " << decode_time << " s ("
+        << (decode_time > 0.0 ? mb_out / decode_time : 0.0) << " MB/s)"
+        << std::endl;
+#endif
+}
+
 void Image::unload()
 {
+    if (flags & GLYPHS)
+        free_glyph_sets(this);
     if (image != NULL)
         stbi_image_free(image);
     if (tex != 0)
@@ -192,6 +238,8 @@ void Image::replace(const Color & from, const Color & to)
         std::cout << "Could not replace color in unloaded image" << std::endl;
         return;
     }
+    if (flags & GLYPHS)
+        free_glyph_sets(this);
     for (int i = 0; i < width * height; i++) {
         unsigned char * c = &image[i*4];
         if (c[0] != from.r || c[1] != from.g || c[2] != from.b)
@@ -537,6 +585,174 @@ Image * get_internal_image(unsigned int i)
     return internal_images[i];
 }
 
+// loading of the images of the next frames on a worker thread. the worker
+// only touches its own Image objects and asset file. stb_image's inflate
+// keeps global state, so zlib blocks are only read there and decoded on the
+// main thread when the images are used. LZ4 blocks are decoded right away.
+
+#ifdef CHOWDREN_PREPARE_IMAGES
+#include "thread.h"
+
+struct PreparedImage
+{
+    Image * image;
+    int codec;
+    // compressed block, or NULL if the image is already decoded
+    unsigned char * data;
+    unsigned int size, out_size;
+};
+
+static Thread prepare_thread;
+static vector<unsigned short> prepare_handles;
+static vector<PreparedImage> prepared_images;
+
+static int prepare_images_thread(void * data)
+{
+    AssetFile fp;
+    fp.open();
+    for (unsigned int i = 0; i < prepare_handles.size(); ++i) {
+        PreparedImage prepared;
+        Image * image = new Image(prepare_handles[i]);
+        prepared.image = image;
+        fp.set_item(image->handle, AssetFile::IMAGE_DATA);
+        FileStream stream(fp);
+        load_image_info(*image, stream, prepared.codec, prepared.size,
+                        prepared.out_size);
+        prepared.data = new unsigned char[prepared.size];
+        fp.read(prepared.data, prepared.size);
+        if (prepared.codec == LZ4_CODEC) {
+            int ret = decode_block(prepared.codec, prepared.data,
+                                   prepared.size, image->image,
+                                   prepared.out_size);
+            delete[] prepared.data;
+            prepared.data = NULL;
+            if (ret < 0) {
+                delete image;
+                continue;
+            }
+        }
+        prepared_images.push_back(prepared);
+    }
+    fp.close();
+    return 0;
+}
+
+// finishes a decode on the main thread. returns false if it failed
+static bool decode_prepared(PreparedImage & prepared)
+{
+#ifdef CHOWDREN_IMAGE_STATS
+    decode_in += prepared.size;
+    decode_out += prepared.out_size;
+#endif
+    if (prepared.data == NULL)
+        return true;
+#ifdef CHOWDREN_IMAGE_STATS
+    double start_time = platform_get_time();
+#endif
+    int ret = decode_block(prepared.codec, prepared.data, prepared.size,
+                           prepared.image->image, prepared.out_size);
+    delete[] prepared.data;
+    prepared.data = NULL;
+#ifdef CHOWDREN_IMAGE_STATS
+    decode_time += platform_get_time() - start_time;
+#endif
+    return ret >= 0;
+}
+
+// waits for the worker and moves the prepared images that are in handles
+// into the cache. the others were for a frame that was not switched to, so
+// they are freed. handles are sorted, as written by the exporter
+static void finish_prepared_images(const unsigned short * handles,
+                                   int count)
+{
+    if (!prepare_thread.is_running())
+        return;
+    double start_time = platform_get_time();
+    prepare_thread.wait();
+    double stall_time = platform_get_time() - start_time;
+
+    int used = 0;
+    vector<PreparedImage>::iterator it;
+    for (it = prepared_images.begin(); it != prepared_images.end(); ++it) {
+        PreparedImage & prepared_image = *it;
+        Image * prepared = prepared_image.image;
+        unsigned short handle = prepared->handle;
+        Image * image = internal_images[handle];
+        if (!std::binary_search(handles, handles + count, handle) ||
+            (image != NULL && (image->tex != 0 || image->image != NULL)) ||
+            !decode_prepared(prepared_image))
+        {
+            delete[] prepared_image.data;
+            delete prepared;
+            continue;
+        }
+        used++;
+        if (image == NULL) {
+            prepared->flags |= Image::CACHED;
+            internal_images[handle] = prepared;
+            continue;
+        }
+        image->width = prepared->width;
+        image->height = prepared->height;
+        image->hotspot_x = prepared->hotspot_x;
+        image->hotspot_y = prepared->hotspot_y;
+        image->action_x = prepared->action_x;
+        image->action_y = prepared->action_y;
+        image->image = prepared->image;
+        prepared->image = NULL;
+        delete prepared;
+    }
+    std::cout << "Prepared " << used << " of " << prepared_images.size()
+        << " images, stalled for " << stall_time << " s" << std::endl;
+    prepared_images.clear();
+}
+
+void prepare_images(const unsigned short * handles, int count)
+{
+    // images prepared for a frame that was not switched to
+    finish_prepared_images(NULL, 0);
+
+    // make sure the asset table is read before the worker starts
+    AssetFile::get_offset(0, AssetFile::IMAGE_DATA);
+
+    prepare_handles.clear();
+    for (int i = 0; i < count; ++i) {
+        unsigned short handle = handles[i];
+        Image * image = internal_images[handle];
+        if (image != NULL && (image->tex != 0 || image->image != NULL))
+            continue;
+        prepare_handles.push_back(handle);
+    }
+    if (prepare_handles.empty())
+        return;
+    prepare_thread.start(prepare_images_thread, NULL, "ImagePrepare");
+}
+
+void use_prepared_images(const unsigned short * handles, int count)
+{
+    finish_prepared_images(handles, count);
+
+    // keep the images of the new frame through the next cache flush
+    for (int i = 0; i < count; ++i) {
+        Image * image = internal_images[handles[i]];
+        if (image == NULL || (image->tex == 0 && image->image == NULL))
+            continue;
+        image->flags |= Image::USED;
+    }
+}
+
+#else
+
+void prepare_images(const unsigned short * handles, int count)
+{
+}
+
+void use_prepared_images(const unsigned short * handles, int count)
+{
+}
+
+#endif
+
 Image * get_image_cache(const std::string & filename, int hot_x, int hot_y,
                         int act_x, int act_y, TransparentColor color)
 {
@@ -628,6 +844,7 @@ void preload_images()
 
     dt = platform_get_time() - start_time;
     std::cout << "Image preload took " << dt << std::endl;
+    print_image_stats();
 }
 #else
 void preload_images()
@@ -661,6 +878,7 @@ void preload_images()
 #endif
     double dt = platform_get_time() - start_time;
     std::cout << "Image preload took " << dt << std::endl;
+    print_image_stats();
 }
 #endif
 
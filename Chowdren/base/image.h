@@ -24,6 +24,8 @@ public:
         STATIC = 1 << 3,
         KEEP = 1 << 4,
         LINEAR_FILTER = 1 << 5,
+        // packed into a glyph set, see glyphset.h
+        GLYPHS = 1 << 6,
 #ifdef CHOWDREN_QUICK_SCALE
         DEFAULT_FLAGS = 0
 #else
@@ -103,6 +105,9 @@ void set_image_cache(const std::string & filename, FileImage * image);
 void reset_image_cache();
 void flush_image_cache();
 void preload_images();
+void prepare_images(const unsigned short * handles, int count);
+void use_prepared_images(const unsigned short * handles, int count);
+void print_image_stats();
 
 extern Image dummy_image;
 
@@ -0,0 +1,38 @@
+#include "internstring.h"
+
+const InternString empty_intern;
+
+// never freed, since handles in static objects may be released after the
+// table would have been destroyed
+
+static InternTable & get_intern_table()
+{
+    static InternTable * table = new InternTable;
+    return *table;
+}
+
+InternEntry * intern_acquire(const std::string & value)
+{
+    if (value.empty())
+        return NULL;
+    InternTable & table = get_intern_table();
+    InternTable::iterator it = table.find(value);
+    if (it == table.end())
+        it = table.insert(InternTable::value_type(value, 0)).first;
+    it->second++;
+    return &*it;
+}
+
+void intern_release(InternEntry * entry)
+{
+    entry->second--;
+    if (entry->second != 0)
+        return;
+    InternTable & table = get_intern_table();
+    table.erase(table.find(entry->first));
+}
+
+unsigned int get_intern_count()
+{
+    return get_intern_table().size();
+}
@@ -0,0 +1,90 @@
+#ifndef CHOWDREN_INTERNSTRING_H
+#define CHOWDREN_INTERNSTRING_H
+
+#include <string>
+#include "types.h"
+#include "stringcommon.h"
+
+// handle to a reference counted string in a global table, so equal values
+// share one std::string. copying a handle only changes a count, and two
+// handles are equal exactly if they point to the same entry, so comparing
+// against a constant interned by the exporter is a pointer compare.
+// the empty string has no entry.
+
+typedef hash_map<std::string, unsigned int> InternTable;
+typedef InternTable::value_type InternEntry;
+
+InternEntry * intern_acquire(const std::string & value);
+void intern_release(InternEntry * entry);
+// number of distinct strings in the table
+unsigned int get_intern_count();
+
+class InternString
+{
+public:
+    InternEntry * entry;
+
+    InternString()
+    : entry(NULL)
+    {
+    }
+
+    explicit InternString(const std::string & value)
+    : entry(intern_acquire(value))
+    {
+    }
+
+    InternString(const InternString & other)
+    : entry(other.entry)
+    {
+        if (entry != NULL)
+            entry->second++;
+    }
+
+    ~InternString()
+    {
+        if (entry != NULL)
+            intern_release(entry);
+    }
+
+    InternString & operator=(const InternString & other)
+    {
+        if (other.entry != NULL)
+            other.entry->second++;
+        if (entry != NULL)
+            intern_release(entry);
+        entry = other.entry;
+        return *this;
+    }
+
+    void set(const std::string & value)
+    {
+        if (entry != NULL) {
+            if (entry->first == value)
+                return;
+            intern_release(entry);
+        }
+        entry = intern_acquire(value);
+    }
+
+    const std::string & get() const
+    {
+        if (entry == NULL)
+            return empty_string;
+        return entry->first;
+    }
+
+    bool operator==(const InternString & other) const
+    {
+        return entry == other.entry;
+    }
+
+    bool operator!=(const InternString & other) const
+    {
+        return entry != other.entry;
+    }
+};
+
+extern const InternString empty_intern;
+
+#endif // CHOWDREN_INTERNSTRING_H
@@ -4,6 +4,10 @@
 #include "mathcommon.h"
 #include <iostream>
 
+#ifdef CHOWDREN_FRAME_SNAPSHOT
+#include "snapshot.h"
+#endif
+
 inline double get_pixels(int speed)
 {
     return speed / 8.0;
@@ -1024,3 +1028,120 @@ void EightDirections::update()
     move(add_x * m, add_y * m);
     last_move = m;
 }
+
+#ifdef CHOWDREN_FRAME_SNAPSHOT
+
+void Movement::save_state(FrameSnapshot & snapshot)
+{
+    snapshot.write(speed);
+    snapshot.write(max_speed);
+    snapshot.write(old_x);
+    snapshot.write(old_y);
+    snapshot.write(add_x);
+    snapshot.write(add_y);
+    snapshot.write(back_col);
+    snapshot.write(directions);
+    snapshot.write(flags);
+}
+
+void Movement::load_state(FrameSnapshot & snapshot)
+{
+    snapshot.read(speed);
+    snapshot.read(max_speed);
+    snapshot.read(old_x);
+    snapshot.read(old_y);
+    snapshot.read(add_x);
+    snapshot.read(add_y);
+    snapshot.read(back_col);
+    snapshot.read(directions);
+    snapshot.read(flags);
+    clear_collisions();
+}
+
+void PathMovement::save_state(FrameSnapshot & snapshot)
+{
+    Movement::save_state(snapshot);
+    snapshot.write(current_node);
+    snapshot.write(distance_left);
+    snapshot.write(dir);
+    snapshot.write(node_changed);
+    snapshot.write(start_x);
+    snapshot.write(start_y);
+}
+
+void PathMovement::load_state(FrameSnapshot & snapshot)
+{
+    Movement::load_state(snapshot);
+    snapshot.read(current_node);
+    snapshot.read(distance_left);
+    snapshot.read(dir);
+    snapshot.read(node_changed);
+    snapshot.read(start_x);
+    snapshot.read(start_y);
+}
+
+void PinballMovement::save_state(FrameSnapshot & snapshot)
+{
+    Movement::save_state(snapshot);
+    snapshot.write(deceleration);
+    snapshot.write(gravity);
+    snapshot.write(x_speed);
+    snapshot.write(y_speed);
+}
+
+void PinballMovement::load_state(FrameSnapshot & snapshot)
+{
+    Movement::load_state(snapshot);
+    snapshot.read(deceleration);
+    snapshot.read(gravity);
+    snapshot.read(x_speed);
+    snapshot.read(y_speed);
+}
+
+void BallMovement::save_state(FrameSnapshot & snapshot)
+{
+    Movement::save_state(snapshot);
+    snapshot.write(deceleration);
+    snapshot.write(speed_change);
+    snapshot.write(has_back_col);
+    snapshot.write(stop_speed);
+}
+
+void BallMovement::load_state(FrameSnapshot & snapshot)
+{
+    Movement::load_state(snapshot);
+    snapshot.read(deceleration);
+    snapshot.read(speed_change);
+    snapshot.read(has_back_col);
+    snapshot.read(stop_speed);
+}
+
+void VectorMovement::save_state(FrameSnapshot & snapshot)
+{
+    Movement::save_state(snapshot);
+    snapshot.write(angle);
+}
+
+void VectorMovement::load_state(FrameSnapshot & snapshot)
+{
+    Movement::load_state(snapshot);
+    snapshot.read(angle);
+}
+
+void EightDirections::save_state(FrameSnapshot & snapshot)
+{
+    Movement::save_state(snapshot);
+    snapshot.write(last_move);
+    snapshot.write(acceleration);
+    snapshot.write(deceleration);
+}
+
+void EightDirections::load_state(FrameSnapshot & snapshot)
+{
+    Movement::load_state(snapshot);
+    snapshot.read(last_move);
+    snapshot.read(acceleration);
+    snapshot.read(deceleration);
+}
+
+#endif // CHOWDREN_FRAME_SNAPSHOT
@@ -58,6 +58,10 @@ public:
     void add_collision(FrameObject * obj);
     void set_background_collision();
     void clear_collisions();
+#ifdef CHOWDREN_FRAME_SNAPSHOT
+    virtual void save_state(FrameSnapshot & snapshot);
+    virtual void load_state(FrameSnapshot & snapshot);
+#endif
 };
 
 class StaticMovement : public Movement
@@ -113,6 +117,10 @@ public:
     bool is_path_finished();
     bool is_node_reached();
     void reverse();
+#ifdef CHOWDREN_FRAME_SNAPSHOT
+    void save_state(FrameSnapshot & snapshot);
+    void load_state(FrameSnapshot & snapshot);
+#endif
 };
 
 class PinballMovement : public Movement
@@ -131,6 +139,10 @@ public:
     void set_gravity(int value);
     void set_speed(int value);
     void set_direction(int value);
+#ifdef CHOWDREN_FRAME_SNAPSHOT
+    void save_state(FrameSnapshot & snapshot);
+    void load_state(FrameSnapshot & snapshot);
+#endif
 };
 
 class BallMovement : public Movement
@@ -150,6 +162,10 @@ public:
     void start();
     void set_deceleration(int value);
     void set_speed(int speed);
+#ifdef CHOWDREN_FRAME_SNAPSHOT
+    void save_state(FrameSnapshot & snapshot);
+    void load_state(FrameSnapshot & snapshot);
+#endif
 };
 
 class VectorMovement : public Movement
@@ -162,6 +178,10 @@ public:
     void look_at(int x, int y);
     void start();
     void stop(bool collision);
+#ifdef CHOWDREN_FRAME_SNAPSHOT
+    void save_state(FrameSnapshot & snapshot);
+    void load_state(FrameSnapshot & snapshot);
+#endif
 };
 
 class ShootMovement : public Movement
@@ -183,6 +203,10 @@ public:
     void set_acceleration(int value);
     void start();
     void stop(bool collision);
+#ifdef CHOWDREN_FRAME_SNAPSHOT
+    void save_state(FrameSnapshot & snapshot);
+    void load_state(FrameSnapshot & snapshot);
+#endif
 };
 
 class MoveItMovement : public Movement
@@ -3,6 +3,10 @@
 #include "render.h"
 #include "transition.h"
 
+#ifdef CHOWDREN_FRAME_SNAPSHOT
+#include "snapshot.h"
+#endif
+
 // Active
 
 Active::Active(int x, int y, int type_id)
@@ -612,3 +616,71 @@ public:
 
 static DefaultActive default_active;
 FrameObject * default_active_instance = &default_active;
+
+#ifdef CHOWDREN_FRAME_SNAPSHOT
+
+void Active::save_state(FrameSnapshot & snapshot)
+{
+    FrameObject::save_state(snapshot);
+    snapshot.write(animation);
+    snapshot.write(forced_animation);
+    snapshot.write(current_animation);
+    snapshot.write(animation_finished);
+    snapshot.write(animation_frame);
+    snapshot.write(forced_frame);
+    snapshot.write(animation_direction);
+    snapshot.write(forced_direction);
+    snapshot.write(forced_speed);
+    snapshot.write(loop_count);
+    snapshot.write(counter);
+    snapshot.write(angle);
+    snapshot.write(x_scale);
+    snapshot.write(y_scale);
+    snapshot.write(active_flags);
+    snapshot.write(last_dir);
+    snapshot.write(direction_data);
+    snapshot.write(image);
+    snapshot.write(flash_time);
+    snapshot.write(flash_interval);
+    snapshot.write(fade_time);
+    snapshot.write(fade_duration);
+}
+
+void Active::load_state(FrameSnapshot & snapshot)
+{
+    FrameObject::load_state(snapshot);
+    snapshot.read(animation);
+    snapshot.read(forced_animation);
+    snapshot.read(current_animation);
+    snapshot.read(animation_finished);
+    snapshot.read(animation_frame);
+    snapshot.read(forced_frame);
+    snapshot.read(animation_direction);
+    snapshot.read(forced_direction);
+    snapshot.read(forced_speed);
+    snapshot.read(loop_count);
+    snapshot.read(counter);
+    snapshot.read(angle);
+    snapshot.read(x_scale);
+    snapshot.read(y_scale);
+    snapshot.read(active_flags);
+    snapshot.read(last_dir);
+    snapshot.read(direction_data);
+    snapshot.read(image);
+    snapshot.read(flash_time);
+    snapshot.read(flash_interval);
+    snapshot.read(fade_time);
+    snapshot.read(fade_duration);
+
+    if (image == NULL)
+        return;
+    sprite_col.image = image;
+    sprite_col.hotspot_x = image->hotspot_x;
+    sprite_col.hotspot_y = image->hotspot_y;
+    sprite_col.x_scale = x_scale;
+    sprite_col.y_scale = y_scale;
+    sprite_col.set_angle(angle);
+    update_action_point();
+}
+
+#endif // CHOWDREN_FRAME_SNAPSHOT
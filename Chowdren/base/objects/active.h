@@ -108,6 +108,10 @@ public:
               int hot_x, int hot_y, int action_x, int action_y,
               TransparentColor transparent_color);
     void replace_color(const Color & from, const Color & to);
+#ifdef CHOWDREN_FRAME_SNAPSHOT
+    void save_state(FrameSnapshot & snapshot);
+    void load_state(FrameSnapshot & snapshot);
+#endif
 
     float get_angle()
     {
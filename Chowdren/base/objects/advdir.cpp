@@ -1,5 +1,7 @@
 #include "objects/advdir.h"
 #include "mathcommon.h"
+#include "common.h"
+#include <float.h>
 
 // AdvancedDirection
 
@@ -8,36 +10,194 @@ AdvancedDirection::AdvancedDirection(int x, int y, int type_id)
 {
 }
 
-void AdvancedDirection::find_closest(ObjectList & instances, int x, int y)
+// below this many instances, a linear search is faster than walking the
+// broadphase
+#define CLOSEST_GRID_MIN 32
+// hotspots of rotated and scaled sprites can be rounded just outside of
+// their collision box
+#define CLOSEST_SLACK 2
+
+// ranks an instance by where it is in the lists, so that ties do not depend
+// on the order a search visits them in. later lists rank higher, and in a
+// list, lower indices do. that is the instance the iterators visit last,
+// which won ties in the original linear search. returns 0 if the instance
+// is in none of the lists.
+static int get_rank(ObjectList ** lists, int count, FrameObject * obj,
+                    ObjectList ** found = NULL)
+{
+    int base = 0;
+    for (int i = 0; i < count; i++) {
+        ObjectList & list = *lists[i];
+        int size = list.size();
+        if (obj->index >= 1 && obj->index <= size &&
+            list.items[obj->index].obj == obj) {
+            if (found != NULL)
+                *found = &list;
+            return base + size - obj->index + 1;
+        }
+        base += size;
+    }
+    return 0;
+}
+
+// the count nearest instances found so far, nearest first. of two
+// instances at the same distance, the one with the higher rank comes first.
+class ClosestSet
+{
+public:
+    struct Item
+    {
+        FrameObject * obj;
+        float dist;
+        int rank;
+    };
+
+    vector<Item> & items;
+    int count;
+
+    ClosestSet(vector<Item> & items, int count)
+    : items(items), count(count)
+    {
+        items.clear();
+    }
+
+    static bool is_before(float dist, int rank, const Item & other)
+    {
+        if (dist != other.dist)
+            return dist < other.dist;
+        return rank > other.rank;
+    }
+
+    void add(FrameObject * obj, float dist, int rank)
+    {
+        int size = int(items.size());
+        if (size == count) {
+            if (!is_before(dist, rank, items[size - 1]))
+                return;
+            items.pop_back();
+            size--;
+        }
+        int i = size;
+        while (i > 0 && is_before(dist, rank, items[i - 1]))
+            i--;
+        Item item = {obj, dist, rank};
+        items.insert(items.begin() + i, item);
+    }
+
+    float get_radius()
+    {
+        if (int(items.size()) < count)
+            return FLT_MAX;
+        return items.back().dist + CLOSEST_SLACK;
+    }
+};
+
+static vector<ClosestSet::Item> closest_items;
+
+// searches the layer broadphases outwards from (x, y). only used when every
+// list has all of its instances selected, since then whether a candidate is
+// selected follows from its index
+class ClosestSearch
+{
+public:
+    ObjectList ** lists;
+    int count;
+    int x, y;
+    ClosestSet & result;
+
+    ClosestSearch(ObjectList ** lists, int count, int x, int y,
+                  ClosestSet & result)
+    : lists(lists), count(count), x(x), y(y), result(result)
+    {
+    }
+
+    static bool is_usable(ObjectList ** lists, int count)
+    {
+        for (int i = 0; i < count; i++) {
+            if (!lists[i]->all_selected)
+                return false;
+        }
+        return true;
+    }
+
+    inline bool on_callback(void * data)
+    {
+        FrameObject * obj = (FrameObject*)data;
+        ObjectList * list;
+        int rank = get_rank(lists, count, obj, &list);
+        if (rank == 0 || obj->index > int(list->items[0].next))
+            return true;
+        result.add(obj, get_distance(x, y, obj->x, obj->y), rank);
+        return true;
+    }
+
+    float get_radius()
+    {
+        return result.get_radius();
+    }
+
+    void run(Frame * frame)
+    {
+        vector<Layer>::iterator it;
+        for (it = frame->layers.begin(); it != frame->layers.end(); ++it)
+            it->broadphase.query_nearest(x, y, *this);
+    }
+};
+
+void AdvancedDirection::set_closest()
+{
+    closest_list.clear();
+    vector<ClosestSet::Item>::const_iterator it;
+    for (it = closest_items.begin(); it != closest_items.end(); ++it)
+        closest_list.push_back(it->obj);
+    closest = closest_list.empty() ? NULL : closest_list[0];
+}
+
+void AdvancedDirection::find_closest(ObjectList & instances, int x, int y,
+                                     bool boxed, int count)
 {
-    float lowest_dist;
-    closest = NULL;
-    for (ObjectIterator it(instances); !it.end(); ++it) {
-        FrameObject * instance = *it;
-        float dist = get_distance(x, y, instance->x, instance->y);
-        if (closest != NULL && dist > lowest_dist)
-            continue;
-        closest = instance;
-        lowest_dist = dist;
+    ClosestSet result(closest_items, count);
+    ObjectList * lists[1] = {&instances};
+    if (boxed && instances.size() >= CLOSEST_GRID_MIN &&
+        ClosestSearch::is_usable(lists, 1)) {
+        ClosestSearch search(lists, 1, x, y, result);
+        search.run(frame);
+    } else {
+        for (ObjectIterator it(instances); !it.end(); ++it) {
+            FrameObject * instance = *it;
+            float dist = get_distance(x, y, instance->x, instance->y);
+            result.add(instance, dist, get_rank(lists, 1, instance));
+        }
     }
+    set_closest();
 }
 
-void AdvancedDirection::find_closest(QualifierList & instances, int x, int y)
+void AdvancedDirection::find_closest(QualifierList & instances, int x, int y,
+                                     bool boxed, int count)
 {
-    float lowest_dist;
-    closest = NULL;
-    for (QualifierIterator it(instances); !it.end(); ++it) {
-        FrameObject * instance = *it;
-        float dist = get_distance(x, y, instance->x, instance->y);
-        if (closest != NULL && dist > lowest_dist)
-            continue;
-        closest = instance;
-        lowest_dist = dist;
+    ClosestSet result(closest_items, count);
+    if (boxed && instances.size() >= CLOSEST_GRID_MIN &&
+        ClosestSearch::is_usable(instances.items, instances.count)) {
+        ClosestSearch search(instances.items, instances.count, x, y,
+                             result);
+        search.run(frame);
+    } else {
+        for (QualifierIterator it(instances); !it.end(); ++it) {
+            FrameObject * instance = *it;
+            float dist = get_distance(x, y, instance->x, instance->y);
+            result.add(instance, dist,
+                       get_rank(instances.items, instances.count, instance));
+        }
     }
+    set_closest();
 }
 
 FixedValue AdvancedDirection::get_closest(int n)
 {
+    // only the count nearest instances are kept, so like before, indices
+    // past them give the closest one
+    if (n >= 0 && n < int(closest_list.size()))
+        return closest_list[n]->get_fixed();
     return closest->get_fixed();
 }
 
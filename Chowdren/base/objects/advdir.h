@@ -9,10 +9,15 @@ public:
     FRAMEOBJECT_HEAD(AdvancedDirection)
 
     FrameObject * closest;
+    // the nearest instances of the last search, nearest first
+    vector<FrameObject*> closest_list;
 
     AdvancedDirection(int x, int y, int type_id);
-    void find_closest(ObjectList & instances, int x, int y);
-    void find_closest(QualifierList & instances, int x, int y);
+    void find_closest(ObjectList & instances, int x, int y,
+                      bool boxed = false, int count = 1);
+    void find_closest(QualifierList & instances, int x, int y,
+                      bool boxed = false, int count = 1);
+    void set_closest();
     FixedValue get_closest(int n);
     static float get_object_angle(FrameObject * a, FrameObject * b);
 };
@@ -3,19 +3,6 @@
 #include "fileio.h"
 #include "datastream.h"
 
-// Workspace
-
-Workspace::Workspace(FileStream & stream)
-{
-    stream.read_c_string(name);
-    stream.read(data, stream.read_uint32());
-}
-
-Workspace::Workspace(const std::string & name)
-: name(name)
-{
-}
-
 // BinaryArray
 
 BinaryArray::BinaryArray(int x, int y, int type_id)
@@ -24,40 +11,33 @@ BinaryArray::BinaryArray(int x, int y, int type_id)
 
 }
 
+// the whole file is read in one go, and the workspaces point into it
 void BinaryArray::load_workspaces(const std::string & filename)
 {
-    FSFile fp(convert_path(filename).c_str(), "r");
-    FileStream stream(fp);
-    Workspace * workspace;
-    while (!stream.at_end()) {
-        workspace = new Workspace(stream);
-        workspaces[workspace->name] = workspace;
-    }
-    fp.close();
-    switch_workspace(current);
+    char * data;
+    size_t size;
+    if (!read_file(convert_path(filename).c_str(), &data, &size))
+        return;
+    workspaces.load(data, size);
 }
 
-BinaryArray::~BinaryArray()
+void BinaryArray::create_workspace(const std::string & name)
 {
-    WorkspaceMap::const_iterator it;
-    for (it = workspaces.begin(); it != workspaces.end(); ++it)
-        delete it->second;
+    workspaces.add(hash_workspace_name(name), name);
 }
 
-void BinaryArray::create_workspace(const std::string & name)
+void BinaryArray::switch_workspace(const std::string & name)
 {
-    if (workspaces.find(name) != workspaces.end())
-        return;
-    Workspace * workspace = new Workspace(name);
-    workspaces[name] = workspace;
+    switch_workspace(hash_workspace_name(name), name);
 }
 
-void BinaryArray::switch_workspace(const std::string & name)
+void BinaryArray::switch_workspace(unsigned int hash,
+                                   const std::string & name)
 {
-    WorkspaceMap::const_iterator it = workspaces.find(name);
-    if (it == workspaces.end())
+    Workspace * workspace = workspaces.find(hash, name);
+    if (workspace == NULL)
         return;
-    switch_workspace(it->second);
+    switch_workspace(workspace);
 }
 
 void BinaryArray::switch_workspace(Workspace * workspace)
@@ -67,33 +47,43 @@ void BinaryArray::switch_workspace(Workspace * workspace)
 
 bool BinaryArray::has_workspace(const std::string & name)
 {
-    return workspaces.count(name) > 0;
+    return has_workspace(hash_workspace_name(name), name);
+}
+
+bool BinaryArray::has_workspace(unsigned int hash, const std::string & name)
+{
+    return workspaces.find(hash, name) != NULL;
 }
 
 void BinaryArray::load_file(const std::string & filename)
 {
+    if (current == NULL)
+        return;
     size_t size;
     char * data;
-    read_file(convert_path(filename).c_str(), &data, &size);
-    current->data.write(data, size);
+    if (!read_file(convert_path(filename).c_str(), &data, &size))
+        return;
+    current->append(data, size);
     delete[] data;
 }
 
 std::string BinaryArray::read_string(int pos, size_t size)
 {
-    DataStream stream(current->data);
-    stream.seek(pos);
-    std::string v;
-    stream.read_string(v, size);
+    // like a stream read, bytes past the end read as zero
+    std::string v(size, '\0');
+    if (current == NULL || pos < 0)
+        return v;
+    size_t data_size = current->get_size();
+    if (size_t(pos) >= data_size)
+        return v;
+    size_t count = std::min(size, data_size - pos);
+    memcpy(&v[0], current->get_data() + pos, count);
     return v;
 }
 
 size_t BinaryArray::get_size()
 {
-    std::stringstream & oss = current->data;
-    std::stringstream::pos_type current = oss.tellg();
-    oss.seekg(0, std::ios::end);
-    std::stringstream::pos_type offset = oss.tellg();
-    oss.seekg(current);
-    return (size_t)offset;
+    if (current == NULL)
+        return 0;
+    return current->get_size();
 }
@@ -5,34 +5,24 @@
 #include <string>
 #include "datastream.h"
 #include "types.h"
-
-class Workspace
-{
-public:
-    std::string name;
-    std::stringstream data;
-
-    Workspace(FileStream & stream);
-    Workspace(const std::string & name);
-};
-
-typedef hash_map<std::string, Workspace*> WorkspaceMap;
+#include "objects/workspace.h"
 
 class BinaryArray : public FrameObject
 {
 public:
     FRAMEOBJECT_HEAD(BinaryArray)
 
-    WorkspaceMap workspaces;
+    WorkspaceSet workspaces;
     Workspace * current;
 
     BinaryArray(int x, int y, int type_id);
-    ~BinaryArray();
     void load_workspaces(const std::string & filename);
     void create_workspace(const std::string & name);
     void switch_workspace(const std::string & name);
+    void switch_workspace(unsigned int hash, const std::string & name);
     void switch_workspace(Workspace * workspace);
     bool has_workspace(const std::string & name);
+    bool has_workspace(unsigned int hash, const std::string & name);
     void load_file(const std::string & filename);
     std::string read_string(int pos, size_t size);
     size_t get_size();
@@ -1,12 +1,48 @@
 #include "objects/counter.h"
 #include "collision.h"
-#include <iomanip>
+#include <stdio.h>
 #include "common.h"
+#include "glyphset.h"
+
+#ifdef CHOWDREN_FRAME_SNAPSHOT
+#include "snapshot.h"
+#endif
+
+// digit images, then '-', '+', '.' and 'e'
+#define COUNTER_GLYPHS 14
+
+inline int get_glyph_index(char c)
+{
+    switch (c) {
+        case '0':
+        case '1':
+        case '2':
+        case '3':
+        case '4':
+        case '5':
+        case '6':
+        case '7':
+        case '8':
+        case '9':
+            return c - '0';
+        case '-':
+            return 10;
+        case '+':
+            return 11;
+        case '.':
+            return 12;
+        case 'e':
+            return 13;
+        default:
+            return -1;
+    }
+}
 
 // Counter
 
 Counter::Counter(int x, int y, int type_id)
-: FrameObject(x, y, type_id), flash_interval(0.0f), zero_pad(0)
+: FrameObject(x, y, type_id), flash_interval(0.0f), zero_pad(0),
+  glyphs_id(0), glyphs_dirty(true)
 {
 }
 
@@ -48,35 +84,10 @@ Image * Counter::get_image()
 
 Image * Counter::get_image(char c)
 {
-    Image * image;
-    switch (c) {
-        case '0':
-        case '1':
-        case '2':
-        case '3':
-        case '4':
-        case '5':
-        case '6':
-        case '7':
-        case '8':
-        case '9':
-            image = images[c - '0'];
-            break;
-        case '-':
-            image = images[10];
-            break;
-        case '+':
-            image = images[11];
-            break;
-        case '.':
-            image = images[12];
-            break;
-        case 'e':
-            image = images[13];
-            break;
-        default:
-            return NULL;
-    }
+    int index = get_glyph_index(c);
+    if (index == -1)
+        return NULL;
+    Image * image = images[index];
     image->load();
     return image;
 }
@@ -103,12 +114,19 @@ void Counter::set(double value)
         collision = new OffsetInstanceBox(this);
 
     if (type == IMAGE_COUNTER) {
-        std::ostringstream str;
-        if (zero_pad > 0)
-            str << std::setw(zero_pad) << std::setfill('0') << value;
-        else
-            str << value;
-        cached_string = str.str();
+        // same output as the default stream formatting, padded on the left
+        // like setw/setfill
+        char number[64];
+        int len = snprintf(number, sizeof(number), "%g", value);
+        char str[128];
+        int pad = std::max(0, std::min(zero_pad, 64) - len);
+        memset(str, '0', pad);
+        memcpy(str + pad, number, len);
+        len += pad;
+        if (cached_string.compare(0, std::string::npos, str, len) == 0)
+            return;
+        cached_string.assign(str, len);
+        glyphs_dirty = true;
         calculate_box();
     } else if (type == ANIMATION_COUNTER) {
         calculate_box();
@@ -144,6 +162,8 @@ void Counter::draw()
         return;
 
     if (type == IMAGE_COUNTER) {
+        if (draw_glyphs())
+            return;
         double current_x = x;
         for (std::string::reverse_iterator it = cached_string.rbegin();
              it != cached_string.rend(); ++it) {
@@ -181,3 +201,57 @@ void Counter::draw()
         image->draw(x + image->hotspot_x, y + image->hotspot_y, blend_color);
     }
 }
+
+bool Counter::draw_glyphs()
+{
+    GlyphSet * glyphs = get_glyph_set(images, COUNTER_GLYPHS);
+    if (glyphs->tex == 0)
+        return false;
+
+    if (glyphs_dirty || glyphs_id != glyphs->id) {
+        glyphs_dirty = false;
+        glyphs_id = glyphs->id;
+        glyph_boxes.clear();
+        glyph_coords.clear();
+        int current_x = 0;
+        for (std::string::reverse_iterator it = cached_string.rbegin();
+             it != cached_string.rend(); ++it) {
+            int index = get_glyph_index(it[0]);
+            if (index == -1)
+                continue;
+            glyphs->add_left(index, current_x, glyph_boxes, glyph_coords);
+        }
+    }
+
+    if (glyph_boxes.empty())
+        return true;
+    Render::draw_tex_run(x, y, &glyph_boxes[0], &glyph_coords[0],
+                         glyph_boxes.size() / 4, blend_color, glyphs->tex);
+    return true;
+}
+
+#ifdef CHOWDREN_FRAME_SNAPSHOT
+
+void Counter::save_state(FrameSnapshot & snapshot)
+{
+    FrameObject::save_state(snapshot);
+    snapshot.write(value);
+    snapshot.write(minimum);
+    snapshot.write(maximum);
+    snapshot.write(flash_time);
+    snapshot.write(flash_interval);
+}
+
+void Counter::load_state(FrameSnapshot & snapshot)
+{
+    FrameObject::load_state(snapshot);
+    double new_value;
+    snapshot.read(new_value);
+    snapshot.read(minimum);
+    snapshot.read(maximum);
+    snapshot.read(flash_time);
+    snapshot.read(flash_interval);
+    set(new_value);
+}
+
+#endif // CHOWDREN_FRAME_SNAPSHOT
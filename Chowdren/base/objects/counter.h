@@ -40,6 +40,12 @@ public:
     Color color1;
     Color color2;
     int zero_pad;
+    // quads of cached_string in the glyph set of the digit images, rebuilt
+    // when the string or the set changes
+    unsigned int glyphs_id;
+    vector<int> glyph_boxes;
+    vector<float> glyph_coords;
+    bool glyphs_dirty;
 
     Counter(int x, int y, int type_id);
     ~Counter();
@@ -52,8 +58,13 @@ public:
     void set(double value);
     void draw();
     void calculate_box();
+    bool draw_glyphs();
     void update();
     void flash(float value);
+#ifdef CHOWDREN_FRAME_SNAPSHOT
+    void save_state(FrameSnapshot & snapshot);
+    void load_state(FrameSnapshot & snapshot);
+#endif
 
     int get_int()
     {
@@ -717,11 +717,11 @@ std::string INI::get_item_part(const std::string & group,
     if (index < 0)
         return def;
     const std::string & value = get_string_default(group, item, empty_string);
-    vector<std::string> elem;
-    split_string(value, ',', elem);
+    vector<StringSpan> elem;
+    split_spans(value, ',', elem);
     if (index >= (int)elem.size())
         return def;
-    return elem[index];
+    return elem[index].get(value);
 }
 
 void INI::set_auto(bool save, bool load)
@@ -1,4 +1,5 @@
 #include "objects/layerext.h"
+#include "objects/layersort.h"
 #include "chowconfig.h"
 
 // LayerObject
@@ -84,14 +85,63 @@ bool LayerObject::sort_func(const FrameObject & a, const FrameObject & b)
         return value1 > value2;
 }
 
+// keyed sort. the alterable of every instance is read once into a packed
+// array of integer keys that order like the doubles, which is then sorted
+// stably. layers sorted every frame are usually still sorted or close to it,
+// so those are detected first and handled with an insertion sort.
+
+static vector<AltSortItem> alt_sort_items;
+static vector<AltSortItem> alt_sort_temp;
+static vector<unsigned int> alt_sort_depths;
+
+void LayerObject::sort_layer(Layer * layer, int index, double def)
+{
+    LayerInstances & instances = layer->instances;
+    vector<AltSortItem> & items = alt_sort_items;
+    vector<unsigned int> & depths = alt_sort_depths;
+    items.clear();
+    depths.clear();
+
+    int descents = 0;
+    LayerInstances::iterator it;
+    for (it = instances.begin(); it != instances.end(); ++it) {
+        FrameObject * obj = &*it;
+        double value = def;
+        if (obj->alterables != NULL)
+            value = obj->alterables->values.get(index);
+        AltSortItem item;
+        item.key = get_sort_key(value);
+        item.obj = obj;
+        if (!items.empty() && items.back().key > item.key)
+            descents++;
+        items.push_back(item);
+        depths.push_back(obj->depth);
+    }
+
+    if (descents == 0)
+        return;
+
+    int count = int(items.size());
+    if (descents <= count / 16 + 4)
+        insertion_sort(&items[0], count);
+    else
+        radix_sort(items, alt_sort_temp);
+
+    // the depths were increasing in the old order, so handing them out again
+    // by position keeps them increasing, and an instance that kept its
+    // position keeps its depth
+    instances.clear();
+    for (int i = 0; i < count; ++i) {
+        FrameObject * obj = items[i].obj;
+        if (obj->depth != depths[i])
+            obj->depth = depths[i];
+        instances.push_back(*obj);
+    }
+}
+
 void LayerObject::sort_alt_decreasing(int index, double def)
 {
-    sort_index = index;
-    sort_reverse = true;
-    this->def = def;
-    Layer * layer = &frame->layers[current_layer];
-    layer->instances.sort(sort_func);
-    layer->reset_depth();
+    sort_layer(&frame->layers[current_layer], index, def);
 }
 
 void LayerObject::set_rgb(int index, Color color)
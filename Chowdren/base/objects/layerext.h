@@ -28,6 +28,7 @@ public:
     static double get_alterable(const FrameObject & instance);
     static bool sort_func(const FrameObject & a, const FrameObject & b);
     void sort_alt_decreasing(int index, double def);
+    static void sort_layer(Layer * layer, int index, double def);
     void set_rgb(int index, Color color);
 };
 
@@ -0,0 +1,87 @@
+#ifndef CHOWDREN_LAYERSORT_H
+#define CHOWDREN_LAYERSORT_H
+
+#include <string.h>
+#include <algorithm>
+#include "types.h"
+
+class FrameObject;
+
+// stable sorts of instances by a packed integer key, for
+// LayerObject::sort_layer. get_sort_key gives keys that order like the
+// doubles they come from.
+
+struct AltSortItem
+{
+    uint64_t key;
+    FrameObject * obj;
+};
+
+#define ALT_SORT_RADIX_BITS 8
+#define ALT_SORT_RADIX_SIZE (1 << ALT_SORT_RADIX_BITS)
+#define ALT_SORT_PASSES (64 / ALT_SORT_RADIX_BITS)
+
+inline uint64_t get_sort_key(double value)
+{
+    if (value == 0.0)
+        value = 0.0; // -0.0 sorts with 0.0
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    if (bits & (uint64_t(1) << 63))
+        return ~bits;
+    return bits | (uint64_t(1) << 63);
+}
+
+inline void insertion_sort(AltSortItem * items, int count)
+{
+    for (int i = 1; i < count; ++i) {
+        AltSortItem item = items[i];
+        int j = i;
+        for (; j > 0 && items[j - 1].key > item.key; --j)
+            items[j] = items[j - 1];
+        items[j] = item;
+    }
+}
+
+// LSD radix sort on bytes. all histograms come from one pass, and a byte
+// that is the same for every key is skipped
+inline void radix_sort(vector<AltSortItem> & items, vector<AltSortItem> & temp)
+{
+    int count = int(items.size());
+    static unsigned int counts[ALT_SORT_PASSES][ALT_SORT_RADIX_SIZE];
+    memset(counts, 0, sizeof(counts));
+    for (int i = 0; i < count; ++i) {
+        uint64_t key = items[i].key;
+        for (int pass = 0; pass < ALT_SORT_PASSES; ++pass) {
+            int digit = int(key >> (pass * ALT_SORT_RADIX_BITS)) &
+                        (ALT_SORT_RADIX_SIZE - 1);
+            counts[pass][digit]++;
+        }
+    }
+
+    temp.resize(count);
+    AltSortItem * src = &items[0];
+    AltSortItem * dst = &temp[0];
+    for (int pass = 0; pass < ALT_SORT_PASSES; ++pass) {
+        unsigned int * pass_counts = counts[pass];
+        int shift = pass * ALT_SORT_RADIX_BITS;
+        int first = int(src[0].key >> shift) & (ALT_SORT_RADIX_SIZE - 1);
+        if (pass_counts[first] == (unsigned int)count)
+            continue;
+        unsigned int offset = 0;
+        for (int i = 0; i < ALT_SORT_RADIX_SIZE; ++i) {
+            unsigned int c = pass_counts[i];
+            pass_counts[i] = offset;
+            offset += c;
+        }
+        for (int i = 0; i < count; ++i) {
+            int digit = int(src[i].key >> shift) & (ALT_SORT_RADIX_SIZE - 1);
+            dst[pass_counts[digit]++] = src[i];
+        }
+        std::swap(src, dst);
+    }
+    if (src != &items[0])
+        items.swap(temp);
+}
+
+#endif // CHOWDREN_LAYERSORT_H
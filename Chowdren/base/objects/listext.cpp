@@ -3,8 +3,12 @@
 
 // ListObject
 
+// lists shorter than this are searched linearly
+#define LIST_INDEX_MIN 64
+
 ListObject::ListObject(int x, int y, int type_id)
-: FrameObject(x, y, type_id), list_flags(0)
+: FrameObject(x, y, type_id), list_flags(0), index_valid(false),
+  prefix_min_valid(false)
 {
 
 }
@@ -18,11 +22,13 @@ void ListObject::load_file(const std::string & name)
     std::string line;
     while (!ss.at_end()) {
         ss.read_line(line);
-        add_line(line);
+        lines.push_back(line);
     }
 
+    // sort the whole batch once instead of inserting line by line
     if (list_flags & SORT_LIST)
         sort();
+    index_valid = false;
 }
 
 void ListObject::delete_line(int line)
@@ -30,20 +36,32 @@ void ListObject::delete_line(int line)
     line += index_offset;
     if (line < 0 || line >= int(lines.size()))
         return;
+    if (index_valid)
+        unindex_line(line);
     lines.erase(lines.begin() + line);
+    if (index_valid)
+        shift_index(line + 1, -1);
 }
 
 void ListObject::clear()
 {
     lines.clear();
+    index_valid = false;
 }
 
 void ListObject::add_line(const std::string & value)
 {
-    lines.push_back(value);
-
-    if (list_flags & SORT_LIST)
-        sort();
+    int line;
+    if (list_flags & SORT_LIST) {
+        line = insert_sorted(value);
+        if (index_valid)
+            shift_index(line, 1);
+    } else {
+        line = int(lines.size());
+        lines.push_back(value);
+    }
+    if (index_valid)
+        index_line(line);
 }
 
 const std::string & ListObject::get_line(int i)
@@ -59,17 +77,98 @@ const std::string & ListObject::get_current_line()
     return get_line(current_line);
 }
 
+struct LineOrder
+{
+    const StringList & lines;
+
+    LineOrder(const StringList & lines)
+    : lines(lines)
+    {
+    }
+
+    // equal lines are kept in index order, so the first of a run of equal
+    // lines is its lowest index
+    bool operator()(int a, int b) const
+    {
+        int ret = lines[a].compare(lines[b]);
+        if (ret != 0)
+            return ret < 0;
+        return a < b;
+    }
+};
+
+// orders line indexes before a search text
+struct LineBefore
+{
+    const StringList & lines;
+
+    LineBefore(const StringList & lines)
+    : lines(lines)
+    {
+    }
+
+    bool operator()(int a, const std::string & text) const
+    {
+        return lines[a] < text;
+    }
+};
+
 int ListObject::find_string(const std::string & text, int flag)
 {
 #ifndef NDEBUG
     if (flag != -1)
         std::cout << "Unsupported find_string: " << flag << std::endl;
 #endif
-    for (int i = 0; i < int(lines.size()); ++i) {
-        if (starts_with(lines[i], text))
-            return i - index_offset;
+    int size = int(lines.size());
+    if (size < LIST_INDEX_MIN) {
+        for (int i = 0; i < size; ++i) {
+            if (starts_with(lines[i], text))
+                return i - index_offset;
+        }
+        return -1;
     }
-    return -1;
+
+    if (!index_valid)
+        build_index();
+    else if (!prefix_min_valid)
+        build_prefix_min();
+
+    // lines starting with text are a contiguous run in byte order
+    int start = 0;
+    int end = size;
+    while (start < end) {
+        int mid = (start + end) / 2;
+        if (lines[prefix_order[mid]] < text)
+            start = mid + 1;
+        else
+            end = mid;
+    }
+    end = size;
+    int run_start = start;
+    while (start < end) {
+        int mid = (start + end) / 2;
+        if (starts_with(lines[prefix_order[mid]], text))
+            start = mid + 1;
+        else
+            end = mid;
+    }
+    int run_end = start;
+    if (run_start == run_end)
+        return -1;
+
+    // lowest line index in the run
+    int ret = size;
+    int l = run_start + size;
+    int r = run_end + size;
+    while (l < r) {
+        if (l & 1)
+            ret = std::min(ret, prefix_min[l++]);
+        if (r & 1)
+            ret = std::min(ret, prefix_min[--r]);
+        l /= 2;
+        r /= 2;
+    }
+    return ret - index_offset;
 }
 
 int ListObject::find_string_exact(const std::string & text, int flag)
@@ -78,11 +177,84 @@ int ListObject::find_string_exact(const std::string & text, int flag)
     if (flag != -1)
         std::cout << "Unsupported find_string_exact: " << flag << std::endl;
 #endif
-    for (int i = 0; i < int(lines.size()); ++i) {
-        if (lines[i] == text)
-            return i - index_offset;
+    int size = int(lines.size());
+    if (size < LIST_INDEX_MIN) {
+        for (int i = 0; i < size; ++i) {
+            if (lines[i] == text)
+                return i - index_offset;
+        }
+        return -1;
     }
-    return -1;
+
+    if (!index_valid)
+        build_index();
+    // equal lines are ordered by index, so the first one is the lowest
+    vector<int>::const_iterator it;
+    it = std::lower_bound(prefix_order.begin(), prefix_order.end(), text,
+                          LineBefore(lines));
+    if (it == prefix_order.end() || lines[*it] != text)
+        return -1;
+    return *it - index_offset;
+}
+
+void ListObject::build_index()
+{
+    int size = int(lines.size());
+
+    // line indexes in byte order, with a min-tree on top so a run of
+    // matching prefixes gives the lowest line index in log time. equal
+    // lines are adjacent, so exact matches are found by the same order
+    prefix_order.resize(size);
+    for (int i = 0; i < size; ++i)
+        prefix_order[i] = i;
+    std::sort(prefix_order.begin(), prefix_order.end(), LineOrder(lines));
+    build_prefix_min();
+
+    index_valid = true;
+}
+
+void ListObject::build_prefix_min()
+{
+    int size = int(prefix_order.size());
+    prefix_min.resize(size * 2);
+    for (int i = 0; i < size; ++i)
+        prefix_min[size + i] = prefix_order[i];
+    for (int i = size - 1; i > 0; --i)
+        prefix_min[i] = std::min(prefix_min[i * 2], prefix_min[i * 2 + 1]);
+    prefix_min_valid = true;
+}
+
+// the following keep a built index in sync with single line edits, which
+// only costs a binary search and a pass over prefix_order, the same as
+// inserting into lines. the min-tree is rebuilt on the next find_string,
+// so edits between searches only pay for it once.
+
+void ListObject::index_line(int line)
+{
+    vector<int>::iterator it = std::lower_bound(prefix_order.begin(),
+                                                prefix_order.end(), line,
+                                                LineOrder(lines));
+    prefix_order.insert(it, line);
+    prefix_min_valid = false;
+}
+
+void ListObject::unindex_line(int line)
+{
+    vector<int>::iterator it = std::lower_bound(prefix_order.begin(),
+                                                prefix_order.end(), line,
+                                                LineOrder(lines));
+    prefix_order.erase(it);
+    prefix_min_valid = false;
+}
+
+void ListObject::shift_index(int start, int delta)
+{
+    vector<int>::iterator it;
+    for (it = prefix_order.begin(); it != prefix_order.end(); ++it) {
+        if (*it >= start)
+            *it += delta;
+    }
+    prefix_min_valid = false;
 }
 
 void ListObject::set_line(int line, const std::string & value)
@@ -90,10 +262,19 @@ void ListObject::set_line(int line, const std::string & value)
     line += index_offset;
     if (line < 0 || line >= int(lines.size()))
         return;
-    lines[line] = value;
-
-    if (list_flags & SORT_LIST)
-        sort();
+    if (index_valid)
+        unindex_line(line);
+    if (list_flags & SORT_LIST) {
+        lines.erase(lines.begin() + line);
+        if (index_valid)
+            shift_index(line + 1, -1);
+        line = insert_sorted(value);
+        if (index_valid)
+            shift_index(line, 1);
+    } else
+        lines[line] = value;
+    if (index_valid)
+        index_line(line);
 }
 
 int ListObject::get_count()
@@ -248,6 +429,15 @@ inline bool list_sort(const std::string & a, const std::string & b)
 void ListObject::sort()
 {
     std::sort(lines.begin(), lines.end(), list_sort);
+    index_valid = false;
+}
+
+int ListObject::insert_sorted(const std::string & value)
+{
+    StringList::iterator it = std::upper_bound(lines.begin(), lines.end(),
+                                               value, list_sort);
+    it = lines.insert(it, value);
+    return int(it - lines.begin());
 }
 
 void ListObject::set_current_line(int index)
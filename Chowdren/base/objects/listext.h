@@ -23,6 +23,14 @@ public:
     int current_line;
     int index_offset;
 
+    // lookup index for find_string and find_string_exact. it is built on
+    // the first search of a large list, kept in sync by single line edits
+    // and dropped when the whole list changes.
+    bool index_valid;
+    bool prefix_min_valid;
+    vector<int> prefix_order;
+    vector<int> prefix_min;
+
     ListObject(int x, int y, int type_id);
     void load_file(const std::string & name);
     void add_line(const std::string & value);
@@ -37,7 +45,13 @@ public:
     int find_string(const std::string & text, int flag);
     int find_string_exact(const std::string & text, int flag);
     void sort();
+    int insert_sorted(const std::string & value);
     void set_current_line(int index);
+    void build_index();
+    void build_prefix_min();
+    void index_line(int line);
+    void unindex_line(int line);
+    void shift_index(int start, int delta);
 };
 
 #endif // CHOWDREN_LISTEXT_H
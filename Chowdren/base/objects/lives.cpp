@@ -28,11 +28,32 @@ void Lives::update()
 
 void Lives::draw()
 {
-    int xx = x;
-    int i = 0;
-    while (i < manager.lives) {
-        image->draw(xx, y, blend_color);
+    if (manager.lives <= 0)
+        return;
+    if (image->tex == 0) {
+        image->upload_texture();
+        if (image->tex == 0)
+            return;
+    }
+
+    // all the lives share one texture, so draw them as a single run
+    static vector<int> boxes;
+    static vector<float> texcoords;
+    boxes.clear();
+    texcoords.clear();
+    int xx = x - image->hotspot_x;
+    int yy = y - image->hotspot_y;
+    for (int i = 0; i < manager.lives; ++i) {
+        boxes.push_back(xx);
+        boxes.push_back(yy);
+        boxes.push_back(xx + image->width);
+        boxes.push_back(yy + image->height);
+        texcoords.push_back(0.0f);
+        texcoords.push_back(0.0f);
+        texcoords.push_back(1.0f);
+        texcoords.push_back(1.0f);
         xx += image->width;
-        i++;
     }
+    Render::draw_tex_run(0, 0, &boxes[0], &texcoords[0], manager.lives,
+                         blend_color, image->tex);
 }
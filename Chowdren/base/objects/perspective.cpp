@@ -40,15 +40,15 @@ void PerspectiveObject::draw()
 
 void PerspectiveObject::set_waves(double value)
 {
-    set_shader_parameter("sine_waves", value);
+    set_shader_parameter(SHADER_PARAM_SINE_WAVES, value);
 }
 
 void PerspectiveObject::set_zoom(double value)
 {
-    set_shader_parameter("zoom", std::max(0.0, value));
+    set_shader_parameter(SHADER_PARAM_ZOOM, std::max(0.0, value));
 }
 
 void PerspectiveObject::set_offset(double value)
 {
-    set_shader_parameter("offset", value);
+    set_shader_parameter(SHADER_PARAM_OFFSET, value);
 }
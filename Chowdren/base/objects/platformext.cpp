@@ -1,17 +1,21 @@
 #include "objects/platformext.h"
 #include "mathcommon.h"
+#include "collision.h"
+#include "common.h"
 
 // PlatformObject
 
 // XXX hack
 static PlatformObject * last_instance = NULL;
 
+PlatformSweep * PlatformObject::loaded_sweep = NULL;
+
 PlatformObject::PlatformObject(int x, int y, int type_id)
 : FrameObject(x, y, type_id), instance(NULL), paused(false),
   add_x_vel(0), add_y_vel(0), x_move_count(0), y_move_count(0), x_vel(0),
   y_vel(0), left(false), right(false), obstacle_collision(false),
   platform_collision(false), on_ground(false), through_collision_top(false),
-  jump_through(false)
+  jump_through(false), sweep(NULL), sweep_frame(-1), use_sweep(false)
 {
 }
 
@@ -44,6 +48,8 @@ void PlatformObject::update()
     x_move_count += get_abs(x_vel_2);
     y_move_count += get_abs(y_vel_2);
 
+    use_sweep = begin_sweep(x_move_count / 100, y_move_count / 100);
+
     bool overlaps;
 
     while (x_move_count > 100) {
@@ -114,10 +120,104 @@ void PlatformObject::update()
         if (!tmp)
             instance->set_y(instance->y - slope_correction);
     }
+
+    use_sweep = false;
+}
+
+inline bool has_type(const int * types, int count, int id)
+{
+    for (int i = 0; i < count; ++i) {
+        if (types[i] == id)
+            return true;
+    }
+    return false;
+}
+
+struct PlatformSweepCallback
+{
+    PlatformObject * platform;
+
+    PlatformSweepCallback(PlatformObject * platform)
+    : platform(platform)
+    {
+    }
+
+    inline bool on_callback(void * data)
+    {
+        FrameObject * obj = (FrameObject*)data;
+        if (obj == platform->instance || obj->collision == NULL)
+            return true;
+        PlatformSweep * sweep = platform->sweep;
+        if (has_type(sweep->obstacles, sweep->obstacle_count, obj->id))
+            platform->sweep_obstacles.push_back(obj);
+        if (has_type(sweep->platforms, sweep->platform_count, obj->id))
+            platform->sweep_platforms.push_back(obj);
+        return true;
+    }
+};
+
+bool PlatformObject::begin_sweep(int x_steps, int y_steps)
+{
+#ifdef CHOWDREN_DEFER_COLLISIONS
+    return false;
+#else
+    if (sweep_frame != frame->index) {
+        loaded_sweep = NULL;
+        call_load_sweep();
+        sweep = loaded_sweep;
+        sweep_frame = frame->index;
+    }
+    if (sweep == NULL)
+        return false;
+
+    // the events test every subject instance, so the probes are only
+    // equivalent if the controlled instance is the only one
+    ObjectList & subjects = frame->instances.items[sweep->subject];
+    if (subjects.size() != 1 || subjects.items[1].obj != instance)
+        return false;
+    CollisionBase * col = instance->collision;
+    if (col == NULL)
+        return false;
+
+    // every position the step loops below can probe. x steps may also
+    // climb by step_up each, and slope correction probes downwards.
+    int dx = x_steps + 1;
+    int dy = y_steps + step_up * x_steps + slope_correction + 1;
+    int box[4] = {col->aabb[0] - dx, col->aabb[1] - dy,
+                  col->aabb[2] + dx, col->aabb[3] + dy};
+
+    sweep_obstacles.clear();
+    sweep_platforms.clear();
+
+    Layer * layer = instance->layer;
+    PlatformSweepCallback callback(this);
+    layer->broadphase.query(box, callback);
+    return true;
+#endif
+}
+
+bool PlatformObject::sweep_overlaps(vector<FrameObject*> & objects,
+                                    bool background)
+{
+    vector<FrameObject*>::iterator it;
+    for (it = objects.begin(); it != objects.end(); ++it) {
+        if (instance->overlaps(*it))
+            return true;
+    }
+    if (!background)
+        return false;
+
+    // same test as the "overlaps backdrop" condition
+    return instance->overlaps_background();
 }
 
 bool PlatformObject::overlaps_obstacle()
 {
+    if (use_sweep) {
+        obstacle_collision = sweep_overlaps(sweep_obstacles,
+                                            sweep->obstacle_background);
+        return obstacle_collision;
+    }
     obstacle_collision = false;
     call_overlaps_obstacle();
     return obstacle_collision;
@@ -125,6 +225,11 @@ bool PlatformObject::overlaps_obstacle()
 
 bool PlatformObject::overlaps_platform()
 {
+    if (use_sweep) {
+        platform_collision = sweep_overlaps(sweep_platforms,
+                                            sweep->platform_background);
+        return platform_collision;
+    }
     platform_collision = false;
     call_overlaps_platform();
     return platform_collision;
@@ -193,6 +298,10 @@ void PlatformObject::call_overlaps_platform()
 {
 }
 
+void PlatformObject::call_load_sweep()
+{
+}
+
 class DefaultPlatform : public PlatformObject
 {
 public:
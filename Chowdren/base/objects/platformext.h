@@ -6,6 +6,21 @@
 typedef void (*ObstacleOverlapCallback)();
 typedef void (*PlatformOverlapCallback)();
 
+// overlap tests resolved by the exporter. when the obstacle and platform
+// events are plain "subject overlaps X" tests, update() gathers the
+// candidates along the path once and probes them directly instead of
+// running the event callbacks for every pixel moved
+struct PlatformSweep
+{
+    int subject;
+    const int * obstacles;
+    int obstacle_count;
+    bool obstacle_background;
+    const int * platforms;
+    int platform_count;
+    bool platform_background;
+};
+
 class PlatformObject : public FrameObject
 {
 public:
@@ -34,10 +49,20 @@ public:
     ObstacleOverlapCallback obstacle_callback;
     PlatformOverlapCallback platform_callback;
 
+    static PlatformSweep * loaded_sweep;
+    PlatformSweep * sweep;
+    int sweep_frame;
+    bool use_sweep;
+    vector<FrameObject*> sweep_obstacles;
+    vector<FrameObject*> sweep_platforms;
+
     PlatformObject(int x, int y, int type_id);
     void set_object(FrameObject * instance);
     virtual void call_overlaps_obstacle();
     virtual void call_overlaps_platform();
+    virtual void call_load_sweep();
+    bool begin_sweep(int x_steps, int y_steps);
+    bool sweep_overlaps(vector<FrameObject*> & objects, bool background);
     bool overlaps_obstacle();
     bool overlaps_platform();
     bool is_falling();
@@ -107,6 +107,17 @@ void QuickBackdrop::draw()
 
         end_draw();
 #else
+        if (width <= 0 || height <= 0)
+            return;
+        image->upload_texture();
+        float tiles_x = width / float(image->width);
+        float tiles_y = height / float(image->height);
+        unsigned int tiles = (unsigned int)(ceil(tiles_x) * ceil(tiles_y));
+        if (effect == Render::NONE &&
+            Render::draw_tex_repeat(x, y, x + width, y + height, blend_color,
+                                    image->tex, 0.0f, 0.0f, tiles_x, tiles_y,
+                                    tiles))
+            return;
 		Render::enable_scissor(x, y, width, height);
         for (int xx = x; xx < x + width; xx += image->width)
         for (int yy = y; yy < y + height; yy += image->height) {
@@ -38,7 +38,7 @@ void StringParser::split()
     if (has_split)
         return;
     elements.clear();
-    split_string(value, delimiters, elements);
+    split_spans(value, delimiters, elements);
     has_split = true;
 }
 
@@ -54,42 +54,42 @@ int StringParser::get_count()
     return int(elements.size());
 }
 
-std::string StringParser::set_element(const std::string & value, int index)
+std::string StringParser::set_element(const std::string & v, int index)
 {
     if (delimiters.size() <= 0)
-        return value;
+        return v;
     index--;
     split();
+    int count = int(elements.size());
     std::string ret;
-    vector<std::string>::const_iterator it;
-
-    for (int i = 0; i < int(elements.size()); i++) {
+    ret.reserve(value.size() + v.size());
+    for (int i = 0; i < count; i++) {
         if (i == index)
-            ret += value;
+            ret += v;
         else
-            ret += elements[i];
+            ret.append(value, elements[i].start, elements[i].size);
         // XXX not entirely correct behaviour, but good enough
-        if (i < int(elements.size()) - 1)
+        if (i < count - 1)
             ret += delimiters[0];
     }
     return ret;
 }
 
-const std::string & StringParser::get_element(int i)
+std::string StringParser::get_element(int i)
 {
     i--;
     split();
     if (i < 0 || i >= int(elements.size()))
         return empty_string;
-    return elements[i];
+    return elements[i].get(value);
 }
 
-const std::string & StringParser::get_last_element()
+std::string StringParser::get_last_element()
 {
     split();
     if (elements.empty())
         return empty_string;
-    return elements[elements.size()-1];
+    return elements.back().get(value);
 }
 
 std::string StringParser::replace(const std::string & from,
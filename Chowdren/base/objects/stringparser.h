@@ -4,13 +4,14 @@
 #include <string>
 #include "types.h"
 #include "frameobject.h"
+#include "stringcommon.h"
 
 class StringParser : public FrameObject
 {
 public:
     FRAMEOBJECT_HEAD(StringParser)
 
-    vector<std::string> elements;
+    vector<StringSpan> elements;
     std::string delimiters;
     std::string value;
     bool has_split;
@@ -21,9 +22,9 @@ public:
     void set(const std::string & value);
     void add_delimiter(const std::string & delim);
     void reset_delimiters();
-    const std::string & get_element(int index);
+    std::string get_element(int index);
     std::string set_element(const std::string & value, int index);
-    const std::string & get_last_element();
+    std::string get_last_element();
     std::string replace(const std::string & from, const std::string & to);
     std::string remove(const std::string & sub);
     int get_count();
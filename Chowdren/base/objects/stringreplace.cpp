@@ -2,7 +2,7 @@
 #include "stringcommon.h"
 
 StringReplace::StringReplace(int x, int y, int id)
-: FrameObject(x, y, id)
+: FrameObject(x, y, id), matcher_dirty(false)
 {
 }
 
@@ -10,6 +10,7 @@ void StringReplace::add_replacement(const std::string & from,
                                     const std::string & to)
 {
     replacements.push_back(StringReplacement(from, to));
+    matcher_dirty = true;
 }
 
 std::string StringReplace::replace(const std::string & src,
@@ -23,11 +24,15 @@ std::string StringReplace::replace(const std::string & src,
 
 std::string StringReplace::replace(const std::string & src)
 {
-    std::string ret(src);
-    vector<StringReplacement>::const_iterator it;
-    for (it = replacements.begin(); it != replacements.end(); it++) {
-        const StringReplacement & r = *it;
-        ireplace_substring(ret, r.from, r.to);
+    if (matcher_dirty) {
+        matcher.clear();
+        vector<StringReplacement>::const_iterator it;
+        for (it = replacements.begin(); it != replacements.end(); it++)
+            matcher.add(it->from, it->to);
+        matcher.compile();
+        matcher_dirty = false;
     }
+    std::string ret(src);
+    matcher.replace(ret);
     return ret;
 }
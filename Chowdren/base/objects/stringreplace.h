@@ -4,6 +4,7 @@
 #include <string>
 #include "types.h"
 #include "frameobject.h"
+#include "stringcommon.h"
 
 class StringReplacement
 {
@@ -22,6 +23,8 @@ public:
     FRAMEOBJECT_HEAD(StringReplace)
 
     vector<StringReplacement> replacements;
+    MultiReplace matcher;
+    bool matcher_dirty;
 
     StringReplace(int x, int y, int id);
 
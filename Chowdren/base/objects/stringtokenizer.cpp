@@ -8,16 +8,17 @@ StringTokenizer::StringTokenizer(int x, int y, int type_id)
 {
 }
 
-void StringTokenizer::split(const std::string & text,
+void StringTokenizer::split(const std::string & value,
                             const std::string & delims)
 {
+    text = value;
     elements.clear();
-    split_string(text, delims, elements);
+    split_spans(text, delims, elements);
 }
 
-const std::string & StringTokenizer::get(int index)
+std::string StringTokenizer::get(int index)
 {
     if (index < 0 || index >= int(elements.size()))
         return empty_string;
-    return elements[index];
+    return elements[index].get(text);
 }
@@ -4,17 +4,19 @@
 #include "frameobject.h"
 #include <string>
 #include "types.h"
+#include "stringcommon.h"
 
 class StringTokenizer : public FrameObject
 {
 public:
     FRAMEOBJECT_HEAD(StringTokenizer)
 
-    vector<std::string> elements;
+    std::string text;
+    vector<StringSpan> elements;
 
     StringTokenizer(int x, int y, int type_id);
     void split(const std::string & text, const std::string & delims);
-    const std::string & get(int index);
+    std::string get(int index);
 
     int get_count()
     {
@@ -1,11 +1,16 @@
 #include "manager.h"
 #include "subapp.h"
+#include "image.h"
 
 static bool has_ignore_controls = false;
 static bool ignore_controls = false;
 
 SubApplication::SubApplication(int x, int y, int id)
-: FrameObject(x, y, id)
+: FrameObject(x, y, id), update_interval(1), draw_interval(1),
+  update_timer(0), draw_timer(0), skipped_dt(0.0f)
+#ifdef CHOWDREN_SUBAPP_CACHE
+  , redraw(true)
+#endif
 {
     current = this;
 }
@@ -45,9 +50,23 @@ void SubApplication::update()
     if (done)
         return;
     starting = false;
+
+    // a pending frame change is handled right away
+    if (update_timer > 1 && subapp_frame.next_frame == -1) {
+        update_timer--;
+        skipped_dt += manager.dt;
+        return;
+    }
+    update_timer = update_interval;
+
     Frame * old_frame = manager.frame;
     manager.frame = &subapp_frame;
 
+    // the timers of the child still follow the time of the parent
+    float old_dt = manager.dt;
+    manager.dt += skipped_dt;
+    skipped_dt = 0.0f;
+
     if (subapp_frame.next_frame != -1) {
         int next_frame = subapp_frame.next_frame;
         if (subapp_frame.index != -1)
@@ -61,6 +80,10 @@ void SubApplication::update()
         subapp_frame.on_end();
 
     manager.frame = old_frame;
+    manager.dt = old_dt;
+#ifdef CHOWDREN_SUBAPP_CACHE
+    redraw = true;
+#endif
 
     if (ret)
         return;
@@ -81,4 +104,39 @@ void SubApplication::set_frame(int index)
     }
 }
 
+#ifdef CHOWDREN_SUBAPP_CACHE
+
+void SubApplication::draw_frame(int remote)
+{
+    if (update_interval <= 1 && draw_interval <= 1) {
+        subapp_frame.draw(remote);
+        return;
+    }
+
+    // the child is drawn into its own target, and only drawn again once it
+    // has been updated
+    if (draw_timer > 0)
+        draw_timer--;
+    if (fbo.tex == 0 || (redraw && draw_timer == 0)) {
+        if (fbo.tex == 0)
+            fbo.init(WINDOW_WIDTH, WINDOW_HEIGHT);
+        draw_timer = draw_interval - 1;
+        redraw = false;
+        fbo.bind();
+        subapp_frame.draw(remote);
+        fbo.unbind();
+    }
+
+    Render::set_view(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
+    Render::set_offset(0, 0);
+    Render::disable_blend();
+    Render::draw_tex(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT, Color(),
+                     fbo.get_tex(),
+                     fbo_texcoords[0], fbo_texcoords[1],
+                     fbo_texcoords[2], fbo_texcoords[3]);
+    Render::enable_blend();
+}
+
+#endif
+
 SubApplication * SubApplication::current = NULL;
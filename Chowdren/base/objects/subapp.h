@@ -4,6 +4,10 @@
 #include "frameobject.h"
 #include "events.h"
 
+#ifdef CHOWDREN_SUBAPP_CACHE
+#include "fbo.h"
+#endif
+
 class SubApplication : public FrameObject
 {
 public:
@@ -15,6 +19,15 @@ public:
     bool done;
     bool starting;
     bool old_ignore_controls;
+    // the child frame is updated every update_interval parent updates, and
+    // redrawn at most every draw_interval parent draws
+    int update_interval, draw_interval;
+    int update_timer, draw_timer;
+    float skipped_dt;
+#ifdef CHOWDREN_SUBAPP_CACHE
+    Framebuffer fbo;
+    bool redraw;
+#endif
 
     SubApplication(int x, int y, int id);
     ~SubApplication();
@@ -22,6 +35,9 @@ public:
     void update();
     void set_next_frame(int index);
     void set_frame(int index);
+#ifdef CHOWDREN_SUBAPP_CACHE
+    void draw_frame(int remote);
+#endif
 };
 
 #endif // CHOWDREN_SUBAPP_H
@@ -19,7 +19,7 @@ SurfaceObject::SurfaceObject(int x, int y, int type_id)
   load_failed(false), dest_width(0), dest_height(0), dest_x(0), dest_y(0),
   stretch_mode(0), blit_effect(0), selected_image(NULL), displayed_image(NULL),
   use_fbo_blit(false), use_image_blit(false), vert_index(0), src_width(-1),
-  src_height(-1), use_blur(false)
+  src_height(-1), use_blur(false), use_canvas(false)
 {
     if (!has_fbo) {
         has_fbo = true;
@@ -30,11 +30,57 @@ SurfaceObject::SurfaceObject(int x, int y, int type_id)
 
 SurfaceObject::~SurfaceObject()
 {
+    vector<SurfaceImage>::iterator it;
+    for (it = images.begin(); it != images.end(); ++it)
+        delete it->canvas;
     delete collision;
 }
 
+SurfaceCanvas * SurfaceObject::get_canvas()
+{
+    if (!use_canvas || selected_image == NULL)
+        return NULL;
+    SurfaceImage & m = *selected_image;
+    if (m.canvas != NULL)
+        return m.canvas;
+    m.canvas = new SurfaceCanvas;
+    if (m.handle != NULL)
+        m.canvas->load(m.handle);
+    else
+        m.canvas->reset(m.width, m.height);
+    return m.canvas;
+}
+
+SurfaceCanvas::BlitMode SurfaceObject::get_blit_mode()
+{
+    if (blit_effect == 11)
+        return SurfaceCanvas::BLIT_SUBTRACT;
+    return SurfaceCanvas::BLIT_BLEND;
+}
+
 void SurfaceObject::draw()
 {
+    if (use_canvas) {
+        if (display_selected)
+            displayed_image = selected_image;
+        if (displayed_image == NULL || displayed_image->canvas == NULL) {
+            if (displayed_image != NULL && displayed_image->handle != NULL)
+                draw_image(displayed_image->handle, x, y, blend_color);
+            return;
+        }
+        SurfaceImage & m = *displayed_image;
+        SurfaceCanvas & canvas = *m.canvas;
+        if (!canvas.is_valid())
+            return;
+        canvas.upload();
+        begin_draw(canvas.width, canvas.height);
+        Render::draw_tex(x + m.scroll_x, y + m.scroll_y,
+                         x + m.scroll_x + m.width, y + m.scroll_y + m.height,
+                         blend_color, canvas.tex);
+        end_draw();
+        return;
+    }
+
     if (!quads.empty()) {
         begin_draw();
 
@@ -166,6 +212,28 @@ void SurfaceObject::draw()
         } else {
             int start_x = x - (hh->width - m.scroll_x);
             int start_y = y - (hh->height - m.scroll_y);
+            int draw_w = m.get_display_width();
+            int draw_h = m.get_display_height();
+            float u1 = (x - start_x + hh->hotspot_x) / float(w);
+            float v1 = (y - start_y + hh->hotspot_y) / float(h);
+            float u2 = u1 + draw_w / float(w);
+            float v2 = v1 + draw_h / float(h);
+            if (m.has_reverse_x) {
+                // mirrored tiles sample 1 - fract(u)
+                u1 = -u1;
+                u2 = -u2;
+            }
+            unsigned int tiles = (unsigned int)((ceil(draw_w / float(w)) + 1)
+                                              * (ceil(draw_h / float(h)) + 1));
+            hh->upload_texture();
+            if (effect == Render::NONE &&
+                Render::draw_tex_repeat(x, y, x + draw_w, y + draw_h,
+                                        blend_color, hh->tex, u1, v1, u2, v2,
+                                        tiles))
+            {
+                Render::disable_scissor();
+                return;
+            }
             for (int xx = start_x; xx < x + m.canvas_width; xx += w)
             for (int yy = start_y; yy < y + m.canvas_height; yy += h) {
                 draw_image(hh, xx, yy, blend_color,
@@ -252,6 +320,8 @@ void SurfaceObject::load(const std::string & filename)
     selected_image->set_image(image);
     if (image == NULL)
         load_failed = true;
+    if (selected_image->canvas != NULL)
+        selected_image->canvas->load(image);
 
     set_edit_image(selected_index);
 }
@@ -308,6 +378,20 @@ void SurfaceObject::scroll(int x, int y, int wrap)
 
 void SurfaceObject::blit(Active * obj)
 {
+    SurfaceCanvas * canvas = get_canvas();
+    if (canvas != NULL) {
+        Image * img = obj->image;
+        int w = dest_width == 0 ? img->width : dest_width;
+        int h = dest_height == 0 ? img->height : dest_height;
+        // a source size crops the scale, like the texture path below
+        if (src_width != -1)
+            w = w * img->width / std::max(1, src_width);
+        if (src_height != -1)
+            h = h * img->height / std::max(1, src_height);
+        canvas->blit(img, dest_x, dest_y, w, h, get_blit_mode());
+        return;
+    }
+
     use_fbo_blit = true;
     if (!collides(0, 0, selected_image->width, selected_image->height,
                   dest_x, dest_y, dest_x+dest_width, dest_y+dest_height))
@@ -344,6 +428,18 @@ void SurfaceObject::blit(Active * obj)
 
 void SurfaceObject::blit(SurfaceObject * obj, int image)
 {
+    SurfaceCanvas * canvas = get_canvas();
+    if (canvas != NULL) {
+        if (image < 0 || image >= int(obj->images.size()))
+            return;
+        SurfaceImage & src = obj->images[image];
+        if (src.canvas != NULL)
+            canvas->blit(*src.canvas, dest_x, dest_y, get_blit_mode());
+        else if (src.handle != NULL)
+            canvas->blit(src.handle, dest_x, dest_y, src.handle->width,
+                         src.handle->height, get_blit_mode());
+        return;
+    }
     quads = obj->quads;
 }
 
@@ -392,6 +488,9 @@ void SurfaceObject::create_alpha(int index)
 
 void SurfaceObject::clear(const Color & color)
 {
+    SurfaceCanvas * canvas = get_canvas();
+    if (canvas != NULL)
+        canvas->fill(color);
     quads.clear();
     clear_color = color;
 }
@@ -413,6 +512,21 @@ void SurfaceObject::blit_alpha(int image)
 
 void SurfaceObject::blit_image(int image)
 {
+    SurfaceCanvas * canvas = get_canvas();
+    if (canvas != NULL) {
+        if (image < 0 || image >= int(images.size()))
+            return;
+        SurfaceImage & src = images[image];
+        if (src.canvas != NULL && src.canvas != canvas) {
+            canvas->blit(*src.canvas, dest_x, dest_y, get_blit_mode());
+        } else if (src.handle != NULL) {
+            int w = dest_width == 0 ? src.handle->width : dest_width;
+            int h = dest_height == 0 ? src.handle->height : dest_height;
+            canvas->blit(src.handle, dest_x, dest_y, w, h, get_blit_mode());
+        }
+        return;
+    }
+
     use_image_blit = true;
     Image * img = images[image].handle;
     int index = blit_images.size();
@@ -437,14 +551,27 @@ void SurfaceObject::apply_matrix(double div, double offset, double iterations,
                                  double x2y1, double x2y2, double x2y3,
                                  double x3y1, double x3y2, double x3y3)
 {
+    SurfaceCanvas * canvas = get_canvas();
+    if (canvas != NULL) {
+        float matrix[9] = {
+            float(x1y1), float(x2y1), float(x3y1),
+            float(x1y2), float(x2y2), float(x3y2),
+            float(x1y3), float(x2y3), float(x3y3)
+        };
+        canvas->convolve(matrix, div, offset, std::max(1, int(iterations)));
+        return;
+    }
     use_blur = true;
-    set_shader_parameter("radius", 2.25f);
+    set_shader_parameter(SHADER_PARAM_RADIUS, 2.25f);
     //std::cout << "Apply matrix not implemented" << std::endl;
 }
 
 void SurfaceObject::save(const std::string & filename,
                          const std::string & ext)
 {
+    SurfaceCanvas * canvas = get_canvas();
+    if (canvas != NULL && canvas->save(filename, ext))
+        return;
     std::cout << "Surface save not implemented: " << filename << std::endl;
 }
 
@@ -452,6 +579,11 @@ void SurfaceObject::reverse_x()
 {
     if (selected_image == NULL)
         return;
+    SurfaceCanvas * canvas = get_canvas();
+    if (canvas != NULL) {
+        canvas->flip_x();
+        return;
+    }
     selected_image->has_reverse_x = !selected_image->has_reverse_x;
 }
 
@@ -473,6 +605,9 @@ void SurfaceObject::set_transparent_color(const Color & color, bool replace)
     if (selected_image == NULL)
         return;
     selected_image->transparent = color;
+    SurfaceCanvas * canvas = get_canvas();
+    if (canvas != NULL && replace)
+        canvas->set_transparent(color);
 }
 
 int SurfaceObject::get_edit_height()
@@ -504,6 +639,19 @@ void SurfaceObject::clear_alpha(int index)
 void SurfaceObject::draw_rect(int x, int y, int w, int h, Color color,
                               int outline_size, Color outline)
 {
+    SurfaceCanvas * canvas = get_canvas();
+    if (canvas != NULL) {
+        canvas->fill_rect(x, y, w, h, color, true);
+        if (outline_size <= 0)
+            return;
+        int s = outline_size;
+        canvas->fill_rect(x, y, w, s, outline, true);
+        canvas->fill_rect(x, y + h - s, w, s, outline, true);
+        canvas->fill_rect(x, y + s, s, h - s * 2, outline, true);
+        canvas->fill_rect(x + w - s, y + s, s, h - s * 2, outline, true);
+        return;
+    }
+
     SurfaceQuad quad;
     quad.points[0].x = x;
     quad.points[0].y = y;
@@ -520,6 +668,11 @@ void SurfaceObject::draw_rect(int x, int y, int w, int h, Color color,
 void SurfaceObject::draw_line(int x1, int y1, int x2, int y2, Color color,
                               int width)
 {
+    SurfaceCanvas * canvas = get_canvas();
+    if (canvas != NULL) {
+        canvas->draw_line(x1, y1, x2, y2, color, width);
+        return;
+    }
     SurfaceLine line;
     line.points[0].x = x1;
     line.points[0].y = y1;
@@ -540,6 +693,16 @@ void SurfaceObject::draw_polygon(int x, int y, Color color,
         quad.points[i].x += x;
         quad.points[i].y += y;
     }
+    SurfaceCanvas * canvas = get_canvas();
+    if (canvas != NULL) {
+        int points[8];
+        for (int i = 0; i < 4; i++) {
+            points[i * 2] = quad.points[i].x;
+            points[i * 2 + 1] = quad.points[i].y;
+        }
+        canvas->fill_polygon(points, 4, color);
+        return;
+    }
     quads.push_back(quad);
 }
 
@@ -6,6 +6,7 @@
 #include <string>
 #include "color.h"
 #include "fbo.h"
+#include "objects/surfacecanvas.h"
 
 class Active;
 
@@ -21,7 +22,11 @@ struct SurfaceImage
     bool wrap; // Scroll
     bool has_reverse_x; // Reverse X
 
+    // CPU pixels when the object uses canvas mode, created on first edit
+    SurfaceCanvas * canvas;
+
     SurfaceImage()
+    : canvas(NULL)
     {
     }
 
@@ -83,6 +88,7 @@ public:
     bool use_blur;
     bool display_selected;
     bool use_abs_coords;
+    bool use_canvas;
 
     // Runtime stuff
     bool use_fbo_blit, use_image_blit;
@@ -156,6 +162,8 @@ public:
     void draw_rect(int x, int y, int w, int h, Color color,
                    int outline_size, Color outline);
     void insert_point(int index, int x, int y);
+    SurfaceCanvas * get_canvas();
+    SurfaceCanvas::BlitMode get_blit_mode();
 };
 
 #endif // CHOWDREN_SURFACE_H
@@ -0,0 +1,460 @@
+#include "objects/surfacecanvas.h"
+#include "objects/surfacespans.h"
+#include "image.h"
+#include "platform.h"
+#include "fileio.h"
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+// makes sure the image keeps its decoded pixels around, reloading them if
+// they were dropped after the texture upload
+static const unsigned int * get_image_pixels(Image * image)
+{
+    if (image->image == NULL) {
+        image->unload();
+        image->flags |= Image::KEEP;
+        image->load();
+    }
+    return (const unsigned int*)image->image;
+}
+
+// SurfaceCanvas
+
+SurfaceCanvas::SurfaceCanvas()
+: width(0), height(0), pixels(NULL), tex(0)
+{
+    dirty_x1 = dirty_y1 = dirty_x2 = dirty_y2 = 0;
+}
+
+SurfaceCanvas::~SurfaceCanvas()
+{
+    free(pixels);
+    if (tex != 0)
+        Render::delete_tex(tex);
+}
+
+void SurfaceCanvas::reset(int w, int h)
+{
+    if (tex != 0 && (w != width || h != height)) {
+        Render::delete_tex(tex);
+        tex = 0;
+    }
+    free(pixels);
+    width = w;
+    height = h;
+    pixels = NULL;
+    dirty_x1 = w;
+    dirty_y1 = h;
+    dirty_x2 = dirty_y2 = 0;
+    if (w <= 0 || h <= 0)
+        return;
+    pixels = (unsigned int*)calloc(w * h, sizeof(unsigned int));
+    mark_all();
+}
+
+void SurfaceCanvas::load(Image * image)
+{
+    if (image == NULL) {
+        reset(0, 0);
+        return;
+    }
+    reset(image->width, image->height);
+    const unsigned int * src = get_image_pixels(image);
+    if (src == NULL || pixels == NULL)
+        return;
+    memcpy(pixels, src, width * height * sizeof(unsigned int));
+}
+
+void SurfaceCanvas::fill(Color color)
+{
+    if (pixels == NULL)
+        return;
+    fill_span(pixels, get_pixel(color), width * height);
+    mark_all();
+}
+
+void SurfaceCanvas::fill_rect(int x, int y, int w, int h, Color color,
+                              bool blend)
+{
+    int x1 = std::max(x, 0);
+    int y1 = std::max(y, 0);
+    int x2 = std::min(x + w, width);
+    int y2 = std::min(y + h, height);
+    if (x1 >= x2 || y1 >= y2)
+        return;
+    if (blend && color.a == 0)
+        return;
+    unsigned int value = get_pixel(color);
+    int size = x2 - x1;
+    if (blend && color.a != 255) {
+        scratch.resize(size);
+        fill_span(&scratch[0], value, size);
+        for (int yy = y1; yy < y2; ++yy)
+            blend_span(pixels + yy * width + x1, &scratch[0], size);
+    } else {
+        for (int yy = y1; yy < y2; ++yy)
+            fill_span(pixels + yy * width + x1, value, size);
+    }
+    mark(x1, y1, x2, y2);
+}
+
+void SurfaceCanvas::draw_line(int x1, int y1, int x2, int y2, Color color,
+                              int size)
+{
+    size = std::max(size, 1);
+    int offset = size / 2;
+    int dx = abs(x2 - x1);
+    int dy = -abs(y2 - y1);
+    int sx = x1 < x2 ? 1 : -1;
+    int sy = y1 < y2 ? 1 : -1;
+    int err = dx + dy;
+    while (true) {
+        fill_rect(x1 - offset, y1 - offset, size, size, color, false);
+        if (x1 == x2 && y1 == y2)
+            break;
+        int e2 = err * 2;
+        if (e2 >= dy) {
+            err += dy;
+            x1 += sx;
+        }
+        if (e2 <= dx) {
+            err += dx;
+            y1 += sy;
+        }
+    }
+}
+
+// even-odd scanline fill, sampling pixel centers. points holds count x/y
+// pairs
+void SurfaceCanvas::fill_polygon(const int * points, int count, Color color)
+{
+    if (count < 3 || pixels == NULL)
+        return;
+    int min_y = points[1];
+    int max_y = points[1];
+    for (int i = 1; i < count; ++i) {
+        min_y = std::min(min_y, points[i * 2 + 1]);
+        max_y = std::max(max_y, points[i * 2 + 1]);
+    }
+    min_y = std::max(min_y, 0);
+    max_y = std::min(max_y, height);
+
+    vector<int> xs;
+    for (int y = min_y; y < max_y; ++y) {
+        float cy = y + 0.5f;
+        xs.clear();
+        for (int i = 0; i < count; ++i) {
+            const int * a = &points[i * 2];
+            const int * b = &points[((i + 1) % count) * 2];
+            if ((a[1] <= cy) == (b[1] <= cy))
+                continue;
+            float t = (cy - a[1]) / float(b[1] - a[1]);
+            xs.push_back(int(a[0] + t * (b[0] - a[0]) + 0.5f));
+        }
+        std::sort(xs.begin(), xs.end());
+        for (int i = 0; i + 1 < int(xs.size()); i += 2)
+            fill_rect(xs[i], y, xs[i + 1] - xs[i], 1, color, false);
+    }
+}
+
+void SurfaceCanvas::blit_pixels(const unsigned int * src, int src_pitch,
+                                int src_w, int src_h, int x, int y,
+                                int w, int h, BlitMode mode)
+{
+    if (w <= 0 || h <= 0 || src_w <= 0 || src_h <= 0)
+        return;
+    int x1 = std::max(x, 0);
+    int y1 = std::max(y, 0);
+    int x2 = std::min(x + w, width);
+    int y2 = std::min(y + h, height);
+    if (x1 >= x2 || y1 >= y2)
+        return;
+    int size = x2 - x1;
+    bool scaled = w != src_w || h != src_h;
+    if (scaled)
+        scratch.resize(size);
+
+    for (int yy = y1; yy < y2; ++yy) {
+        const unsigned int * row;
+        if (scaled) {
+            // nearest neighbour, sampled once per row into scratch
+            const unsigned int * src_row;
+            src_row = src + ((yy - y) * src_h / h) * src_pitch;
+            for (int xx = x1; xx < x2; ++xx)
+                scratch[xx - x1] = src_row[(xx - x) * src_w / w];
+            row = &scratch[0];
+        } else
+            row = src + (yy - y) * src_pitch + (x1 - x);
+
+        unsigned int * dst = pixels + yy * width + x1;
+        switch (mode) {
+            case BLIT_COPY:
+                memcpy(dst, row, size * sizeof(unsigned int));
+                break;
+            case BLIT_BLEND:
+                blend_span(dst, row, size);
+                break;
+            case BLIT_SUBTRACT:
+                subtract_span(dst, row, size);
+                break;
+        }
+    }
+    mark(x1, y1, x2, y2);
+}
+
+void SurfaceCanvas::blit(Image * image, int x, int y, int w, int h,
+                         BlitMode mode)
+{
+    if (pixels == NULL || image == NULL)
+        return;
+    const unsigned int * src = get_image_pixels(image);
+    if (src == NULL)
+        return;
+    blit_pixels(src, image->width, image->width, image->height, x, y, w, h,
+                mode);
+}
+
+void SurfaceCanvas::blit(const SurfaceCanvas & src, int x, int y,
+                         BlitMode mode)
+{
+    if (pixels == NULL || src.pixels == NULL || &src == this)
+        return;
+    blit_pixels(src.pixels, src.width, src.width, src.height,
+                x, y, src.width, src.height, mode);
+}
+
+void SurfaceCanvas::convolve(const float matrix[9], float div, float offset,
+                             int iterations)
+{
+    if (pixels == NULL)
+        return;
+    float scale = div == 0.0f ? 1.0f : 1.0f / div;
+    int size = width * height;
+    scratch.resize(size);
+    for (int i = 0; i < iterations; ++i) {
+        memcpy(&scratch[0], pixels, size * sizeof(unsigned int));
+        const unsigned int * src = &scratch[0];
+        for (int y = 0; y < height; ++y) {
+            const unsigned int * rows[3] = {
+                src + std::max(y - 1, 0) * width,
+                src + y * width,
+                src + std::min(y + 1, height - 1) * width
+            };
+            convolve_span(pixels + y * width, rows, width, matrix, scale,
+                          offset);
+        }
+    }
+    mark_all();
+}
+
+void SurfaceCanvas::flip_x()
+{
+    if (pixels == NULL)
+        return;
+    for (int y = 0; y < height; ++y)
+        reverse_span(pixels + y * width, width);
+    mark_all();
+}
+
+void SurfaceCanvas::flip_y()
+{
+    if (pixels == NULL)
+        return;
+    for (int y = 0; y < height / 2; ++y)
+        std::swap_ranges(pixels + y * width, pixels + (y + 1) * width,
+                         pixels + (height - 1 - y) * width);
+    mark_all();
+}
+
+void SurfaceCanvas::set_alpha(int alpha)
+{
+    if (pixels == NULL)
+        return;
+    set_alpha_span(pixels, width * height, clamp_color_component(alpha));
+    mark_all();
+}
+
+void SurfaceCanvas::set_transparent(Color color)
+{
+    if (pixels == NULL)
+        return;
+    key_span(pixels, width * height, color);
+    mark_all();
+}
+
+void SurfaceCanvas::upload()
+{
+    if (pixels == NULL)
+        return;
+    if (tex == 0) {
+        tex = Render::create_tex(pixels, Render::RGBA, width, height);
+    } else if (dirty_x1 < dirty_x2 && dirty_y1 < dirty_y2) {
+        Render::update_tex(tex, pixels + dirty_y1 * width + dirty_x1, width,
+                           dirty_x1, dirty_y1,
+                           dirty_x2 - dirty_x1, dirty_y2 - dirty_y1);
+    }
+    dirty_x1 = width;
+    dirty_y1 = height;
+    dirty_x2 = dirty_y2 = 0;
+}
+
+// saving. there is no deflate encoder in the runtime, so PNG files use
+// stored blocks
+
+static void write_be32(std::string & out, unsigned int v)
+{
+    out += char(v >> 24);
+    out += char(v >> 16);
+    out += char(v >> 8);
+    out += char(v);
+}
+
+static void write_le32(std::string & out, unsigned int v)
+{
+    out += char(v);
+    out += char(v >> 8);
+    out += char(v >> 16);
+    out += char(v >> 24);
+}
+
+static void write_le16(std::string & out, unsigned int v)
+{
+    out += char(v);
+    out += char(v >> 8);
+}
+
+static unsigned int get_crc32(const char * data, size_t size,
+                              unsigned int crc = 0)
+{
+    static unsigned int table[256];
+    static bool has_table = false;
+    if (!has_table) {
+        for (unsigned int i = 0; i < 256; ++i) {
+            unsigned int c = i;
+            for (int k = 0; k < 8; ++k)
+                c = (c & 1) ? 0xEDB88320U ^ (c >> 1) : c >> 1;
+            table[i] = c;
+        }
+        has_table = true;
+    }
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i)
+        crc = table[(crc ^ (unsigned char)data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void write_png_chunk(std::string & out, const char * type,
+                            const std::string & data)
+{
+    write_be32(out, data.size());
+    size_t start = out.size();
+    out.append(type, 4);
+    out += data;
+    write_be32(out, get_crc32(&out[start], out.size() - start));
+}
+
+static void encode_png(std::string & out, const unsigned int * pixels,
+                       int width, int height)
+{
+    out.append("\x89PNG\r\n\x1a\n", 8);
+
+    std::string header;
+    write_be32(header, width);
+    write_be32(header, height);
+    header.append("\x08\x06\x00\x00\x00", 5);
+    write_png_chunk(out, "IHDR", header);
+
+    // filter byte 0 before every row, then zlib with stored blocks
+    std::string raw;
+    int row_size = width * 4;
+    raw.reserve((row_size + 1) * height);
+    for (int y = 0; y < height; ++y) {
+        raw += '\0';
+        raw.append((const char*)(pixels + y * width), row_size);
+    }
+
+    std::string data;
+    data.reserve(raw.size() + raw.size() / 65535 * 5 + 16);
+    data += '\x78';
+    data += '\x01';
+    size_t pos = 0;
+    do {
+        size_t size = std::min<size_t>(raw.size() - pos, 65535);
+        data += char(pos + size == raw.size() ? 1 : 0);
+        write_le16(data, size);
+        write_le16(data, ~size & 0xFFFF);
+        data.append(raw, pos, size);
+        pos += size;
+    } while (pos < raw.size());
+
+    unsigned int a = 1, b = 0;
+    for (size_t i = 0; i < raw.size(); ++i) {
+        a = (a + (unsigned char)raw[i]) % 65521;
+        b = (b + a) % 65521;
+    }
+    write_be32(data, (b << 16) | a);
+    write_png_chunk(out, "IDAT", data);
+    write_png_chunk(out, "IEND", std::string());
+}
+
+static void encode_bmp(std::string & out, const unsigned int * pixels,
+                       int width, int height)
+{
+    unsigned int size = width * height * 4;
+    out += "BM";
+    write_le32(out, 14 + 40 + size);
+    write_le32(out, 0);
+    write_le32(out, 14 + 40);
+    write_le32(out, 40);
+    write_le32(out, width);
+    write_le32(out, height);
+    write_le16(out, 1);
+    write_le16(out, 32);
+    write_le32(out, 0);
+    write_le32(out, size);
+    write_le32(out, 2835);
+    write_le32(out, 2835);
+    write_le32(out, 0);
+    write_le32(out, 0);
+    // bottom-up rows in BGRA
+    for (int y = height - 1; y >= 0; --y) {
+        const unsigned char * c = (const unsigned char*)(pixels + y * width);
+        for (int x = 0; x < width; ++x) {
+            out += char(c[2]);
+            out += char(c[1]);
+            out += char(c[0]);
+            out += char(c[3]);
+            c += 4;
+        }
+    }
+}
+
+bool SurfaceCanvas::save(const std::string & filename,
+                         const std::string & ext)
+{
+    if (pixels == NULL)
+        return false;
+    std::string path = convert_path(filename);
+    std::string type = ext;
+    if (type.empty()) {
+        size_t dot = path.find_last_of('.');
+        if (dot != std::string::npos)
+            type = path.substr(dot + 1);
+    }
+    for (size_t i = 0; i < type.size(); ++i)
+        type[i] = tolower(type[i]);
+
+    std::string data;
+    if (type == "bmp")
+        encode_bmp(data, pixels, width, height);
+    else
+        encode_png(data, pixels, width, height);
+
+    FSFile fp(path.c_str(), "w");
+    if (!fp.is_open())
+        return false;
+    fp.write(&data[0], data.size());
+    fp.close();
+    return true;
+}
@@ -0,0 +1,75 @@
+#ifndef CHOWDREN_SURFACECANVAS_H
+#define CHOWDREN_SURFACECANVAS_H
+
+#include <string>
+#include "types.h"
+#include "color.h"
+#include "render.h"
+
+class Image;
+
+// CPU-resident RGBA pixels for the Surface object, in the same byte order as
+// Image::image. raster operations work on the pixels directly, and the area
+// they touch is kept as a dirty rectangle so only that part of the texture
+// is replaced on upload.
+
+class SurfaceCanvas
+{
+public:
+    enum BlitMode
+    {
+        BLIT_COPY,
+        BLIT_BLEND,
+        BLIT_SUBTRACT
+    };
+
+    int width, height;
+    unsigned int * pixels;
+    Texture tex;
+    int dirty_x1, dirty_y1, dirty_x2, dirty_y2;
+    vector<unsigned int> scratch;
+
+    SurfaceCanvas();
+    ~SurfaceCanvas();
+    void reset(int w, int h);
+    void load(Image * image);
+    void fill(Color color);
+    void fill_rect(int x, int y, int w, int h, Color color, bool blend);
+    void draw_line(int x1, int y1, int x2, int y2, Color color, int size);
+    void fill_polygon(const int * points, int count, Color color);
+    void blit(Image * image, int x, int y, int w, int h, BlitMode mode);
+    void blit(const SurfaceCanvas & src, int x, int y, BlitMode mode);
+    void convolve(const float matrix[9], float div, float offset,
+                  int iterations);
+    void flip_x();
+    void flip_y();
+    void set_alpha(int alpha);
+    void set_transparent(Color color);
+    void upload();
+    bool save(const std::string & filename, const std::string & ext);
+
+    bool is_valid() const
+    {
+        return pixels != NULL;
+    }
+
+    void mark(int x1, int y1, int x2, int y2)
+    {
+        dirty_x1 = std::min(dirty_x1, std::max(x1, 0));
+        dirty_y1 = std::min(dirty_y1, std::max(y1, 0));
+        dirty_x2 = std::max(dirty_x2, std::min(x2, width));
+        dirty_y2 = std::max(dirty_y2, std::min(y2, height));
+    }
+
+    void mark_all()
+    {
+        mark(0, 0, width, height);
+    }
+
+private:
+    void blit_pixels(const unsigned int * src, int src_pitch,
+                     int src_w, int src_h, int x, int y, int w, int h,
+                     BlitMode mode);
+};
+
+#endif // CHOWDREN_SURFACECANVAS_H
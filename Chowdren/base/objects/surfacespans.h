@@ -0,0 +1,220 @@
+#ifndef CHOWDREN_SURFACESPANS_H
+#define CHOWDREN_SURFACESPANS_H
+
+#include <algorithm>
+#include "color.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CANVAS_SSE2
+#include <emmintrin.h>
+#endif
+
+// span operations. the SSE2 paths handle four pixels at a time, and the
+// scalar paths finish the tail and work on bytes so they do not depend on
+// the host byte order.
+
+inline unsigned int get_pixel(Color color)
+{
+    unsigned int value;
+    unsigned char * c = (unsigned char*)&value;
+    c[0] = color.r;
+    c[1] = color.g;
+    c[2] = color.b;
+    c[3] = color.a;
+    return value;
+}
+
+inline int div_255(int v)
+{
+    v += 128;
+    return (v + (v >> 8)) >> 8;
+}
+
+#ifdef CANVAS_SSE2
+inline __m128i div_255_epi16(__m128i v)
+{
+    v = _mm_add_epi16(v, _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(v, _mm_srli_epi16(v, 8)), 8);
+}
+
+// src over dst for two pixels unpacked to 16 bits per channel. the alpha
+// lane uses 255 as source factor, so it ends up as a + dst_a * (1 - a)
+inline __m128i blend_epi16(__m128i s, __m128i d)
+{
+    __m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s, 0xFF), 0xFF);
+    __m128i inv = _mm_sub_epi16(_mm_set1_epi16(255), a);
+    __m128i sa = _mm_or_si128(a, _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0));
+    __m128i v = _mm_add_epi16(_mm_mullo_epi16(s, sa), _mm_mullo_epi16(d, inv));
+    return div_255_epi16(v);
+}
+
+// source color scaled by its own alpha, with the alpha lane cleared
+inline __m128i premultiply_epi16(__m128i s)
+{
+    __m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s, 0xFF), 0xFF);
+    a = _mm_and_si128(a, _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1));
+    return div_255_epi16(_mm_mullo_epi16(s, a));
+}
+#endif
+
+inline void fill_span(unsigned int * dst, unsigned int value, int n)
+{
+    int i = 0;
+#ifdef CANVAS_SSE2
+    __m128i v = _mm_set1_epi32(value);
+    for (; i + 3 < n; i += 4)
+        _mm_storeu_si128((__m128i*)(dst + i), v);
+#endif
+    for (; i < n; ++i)
+        dst[i] = value;
+}
+
+inline void blend_span(unsigned int * dst, const unsigned int * src, int n)
+{
+    int i = 0;
+#ifdef CANVAS_SSE2
+    __m128i zero = _mm_setzero_si128();
+    for (; i + 3 < n; i += 4) {
+        __m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+        __m128i lo = blend_epi16(_mm_unpacklo_epi8(s, zero),
+                                 _mm_unpacklo_epi8(d, zero));
+        __m128i hi = blend_epi16(_mm_unpackhi_epi8(s, zero),
+                                 _mm_unpackhi_epi8(d, zero));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(lo, hi));
+    }
+#endif
+    for (; i < n; ++i) {
+        const unsigned char * s = (const unsigned char*)(src + i);
+        unsigned char * d = (unsigned char*)(dst + i);
+        int a = s[3];
+        int inv = 255 - a;
+        d[0] = div_255(s[0] * a + d[0] * inv);
+        d[1] = div_255(s[1] * a + d[1] * inv);
+        d[2] = div_255(s[2] * a + d[2] * inv);
+        d[3] = div_255(a * 255 + d[3] * inv);
+    }
+}
+
+inline void subtract_span(unsigned int * dst, const unsigned int * src,
+                          int n)
+{
+    int i = 0;
+#ifdef CANVAS_SSE2
+    __m128i zero = _mm_setzero_si128();
+    for (; i + 3 < n; i += 4) {
+        __m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+        __m128i lo = premultiply_epi16(_mm_unpacklo_epi8(s, zero));
+        __m128i hi = premultiply_epi16(_mm_unpackhi_epi8(s, zero));
+        s = _mm_packus_epi16(lo, hi);
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_subs_epu8(d, s));
+    }
+#endif
+    for (; i < n; ++i) {
+        const unsigned char * s = (const unsigned char*)(src + i);
+        unsigned char * d = (unsigned char*)(dst + i);
+        int a = s[3];
+        for (int c = 0; c < 3; ++c)
+            d[c] = (unsigned char)std::max(0, d[c] - div_255(s[c] * a));
+    }
+}
+
+inline void reverse_span(unsigned int * row, int n)
+{
+    int i = 0;
+    int j = n;
+#ifdef CANVAS_SSE2
+    for (; j - i >= 8; i += 4, j -= 4) {
+        __m128i a = _mm_loadu_si128((const __m128i*)(row + i));
+        __m128i b = _mm_loadu_si128((const __m128i*)(row + j - 4));
+        a = _mm_shuffle_epi32(a, _MM_SHUFFLE(0, 1, 2, 3));
+        b = _mm_shuffle_epi32(b, _MM_SHUFFLE(0, 1, 2, 3));
+        _mm_storeu_si128((__m128i*)(row + i), b);
+        _mm_storeu_si128((__m128i*)(row + j - 4), a);
+    }
+#endif
+    std::reverse(row + i, row + j);
+}
+
+inline void set_alpha_span(unsigned int * row, int n, int alpha)
+{
+    int i = 0;
+#ifdef CANVAS_SSE2
+    __m128i mask = _mm_set1_epi32(0x00FFFFFF);
+    __m128i value = _mm_set1_epi32(int((unsigned int)alpha << 24));
+    for (; i + 3 < n; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(row + i));
+        v = _mm_or_si128(_mm_and_si128(v, mask), value);
+        _mm_storeu_si128((__m128i*)(row + i), v);
+    }
+#endif
+    for (; i < n; ++i)
+        ((unsigned char*)(row + i))[3] = (unsigned char)alpha;
+}
+
+inline void key_span(unsigned int * row, int n, Color color)
+{
+    int i = 0;
+#ifdef CANVAS_SSE2
+    __m128i mask = _mm_set1_epi32(0x00FFFFFF);
+    __m128i key = _mm_set1_epi32(get_pixel(color) & 0x00FFFFFF);
+    __m128i alpha = _mm_set1_epi32(int(0xFF000000));
+    for (; i + 3 < n; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(row + i));
+        __m128i eq = _mm_cmpeq_epi32(_mm_and_si128(v, mask), key);
+        v = _mm_andnot_si128(_mm_and_si128(eq, alpha), v);
+        _mm_storeu_si128((__m128i*)(row + i), v);
+    }
+#endif
+    for (; i < n; ++i) {
+        unsigned char * c = (unsigned char*)(row + i);
+        if (c[0] == color.r && c[1] == color.g && c[2] == color.b)
+            c[3] = 0;
+    }
+}
+
+// 3x3 convolution of one row. the color channels are filtered and the alpha
+// of the center pixel is kept
+inline void convolve_span(unsigned int * dst, const unsigned int * rows[3],
+                          int n, const float matrix[9], float scale,
+                          float offset)
+{
+    for (int x = 0; x < n; ++x) {
+        int xs[3] = {std::max(x - 1, 0), x, std::min(x + 1, n - 1)};
+#ifdef CANVAS_SSE2
+        __m128i zero = _mm_setzero_si128();
+        __m128 acc = _mm_setzero_ps();
+        for (int i = 0; i < 9; ++i) {
+            __m128i p = _mm_cvtsi32_si128(rows[i / 3][xs[i % 3]]);
+            p = _mm_unpacklo_epi16(_mm_unpacklo_epi8(p, zero), zero);
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_cvtepi32_ps(p),
+                                             _mm_set1_ps(matrix[i])));
+        }
+        acc = _mm_add_ps(_mm_mul_ps(acc, _mm_set1_ps(scale)),
+                         _mm_set1_ps(offset + 0.5f));
+        acc = _mm_max_ps(acc, _mm_setzero_ps());
+        __m128i v = _mm_cvttps_epi32(acc);
+        v = _mm_packus_epi16(_mm_packs_epi32(v, zero), zero);
+        unsigned int center = rows[1][x];
+        dst[x] = (_mm_cvtsi128_si32(v) & 0x00FFFFFF) |
+                 (center & 0xFF000000);
+#else
+        unsigned char * d = (unsigned char*)(dst + x);
+        for (int c = 0; c < 3; ++c) {
+            float acc = 0.0f;
+            for (int i = 0; i < 9; ++i) {
+                const unsigned char * p;
+                p = (const unsigned char*)(rows[i / 3] + xs[i % 3]);
+                acc += p[c] * matrix[i];
+            }
+            acc = std::max(acc * scale + (offset + 0.5f), 0.0f);
+            d[c] = clamp_color_component(int(acc));
+        }
+        d[3] = ((const unsigned char*)(rows[1] + x))[3];
+#endif
+    }
+}
+
+#endif // CHOWDREN_SURFACESPANS_H
@@ -2,6 +2,12 @@
 #include "chowconfig.h"
 #include "collision.h"
 #include "render.h"
+#include "profiler.h"
+
+#ifdef CHOWDREN_VIEWPORT_FBO
+#include "fbo.h"
+#include "image.h"
+#endif
 
 // Viewport
 
@@ -9,6 +15,9 @@ Viewport * Viewport::instance = NULL;
 
 Viewport::Viewport(int x, int y, int type_id)
 : FrameObject(x, y, type_id)
+#ifdef CHOWDREN_VIEWPORT_FBO
+, fbo(NULL)
+#endif
 {
     collision = new InstanceBox(this);
     instance = this;
@@ -18,6 +27,9 @@ Viewport::~Viewport()
 {
     delete collision;
     instance = NULL;
+#ifdef CHOWDREN_VIEWPORT_FBO
+    delete fbo;
+#endif
 }
 
 void Viewport::set_source(int center_x, int center_y, int width, int height)
@@ -40,14 +52,71 @@ void Viewport::set_height(int h)
     collision->update_aabb();
 }
 
-void Viewport::draw()
+bool Viewport::is_zoomed()
 {
     if (src_width == width && src_height == height)
+        return false;
+    if (src_width <= 0 || src_height <= 0)
+        return false;
+    return true;
+}
+
+#ifdef CHOWDREN_VIEWPORT_FBO
+
+void Viewport::draw_fbo(int src_x, int src_y)
+{
+    if (fbo == NULL || fbo_width != src_width || fbo_height != src_height) {
+        delete fbo;
+        fbo = new Framebuffer(src_width, src_height);
+        fbo_width = src_width;
+        fbo_height = src_height;
+    }
+
+    // the texture of the current target holds everything drawn so far. the
+    // source rectangle is in its pixels, as for copy_rect
+    int view[4];
+    Render::get_view(view);
+    int old_offset[2] = {Render::offset[0], Render::offset[1]};
+    float du = (fbo_texcoords[2] - fbo_texcoords[0]) / current_fbo->w;
+    float dv = (fbo_texcoords[3] - fbo_texcoords[1]) / current_fbo->h;
+    float u1 = fbo_texcoords[0] + src_x * du;
+    float v1 = fbo_texcoords[1] + src_y * dv;
+    float u2 = u1 + src_width * du;
+    float v2 = v1 + src_height * dv;
+    Texture src = current_fbo->get_tex();
+
+    Render::disable_blend();
+    fbo->bind();
+    Render::set_view(0, 0, src_width, src_height);
+    Render::set_offset(0, 0);
+    Render::draw_tex(0, 0, src_width, src_height, Color(255, 255, 255, 255),
+                     src, u1, v1, u2, v2);
+    fbo->unbind();
+    Render::set_view(view[0], view[1], view[2], view[3]);
+    Render::set_offset(old_offset[0], old_offset[1]);
+
+    Render::draw_tex(x, y, x + width, y + height, Color(255, 255, 255, 255),
+                     fbo->get_tex(),
+                     fbo_texcoords[0], fbo_texcoords[1],
+                     fbo_texcoords[2], fbo_texcoords[3]);
+    Render::enable_blend();
+}
+
+#endif
+
+void Viewport::draw()
+{
+    if (!is_zoomed())
         return;
-    if (src_width == 0 || src_height == 0)
-        return;
+    PROFILE_BEGIN(Viewport_draw);
     int src_x1 = center_x - src_width / 2;
     int src_y1 = center_y - src_height / 2;
+#ifdef CHOWDREN_VIEWPORT_FBO
+    // the desktop platform always draws the frame into a framebuffer
+    draw_fbo(src_x1, src_y1);
+    PROFILE_END();
+    return;
+#endif
     int src_x2 = src_x1 + src_width;
     int src_y2 = src_y1 + src_height;
     Texture t = Render::copy_rect(src_x1, src_y1, src_x2, src_y2);
@@ -58,4 +127,5 @@ void Viewport::draw()
                      back_texcoords[0], back_texcoords[1],
                      back_texcoords[2], back_texcoords[3]);
     Render::enable_blend();
+    PROFILE_END();
 }
@@ -4,6 +4,10 @@
 #include "frameobject.h"
 #include "render.h"
 
+#ifdef CHOWDREN_VIEWPORT_FBO
+class Framebuffer;
+#endif
+
 class Viewport : public FrameObject
 {
 public:
@@ -14,12 +18,22 @@ public:
     Texture texture;
     static Viewport * instance;
 
+#ifdef CHOWDREN_VIEWPORT_FBO
+    // when drawing to a framebuffer, the source rectangle is drawn from its
+    // texture into fbo, which is then stretched to the viewport
+    Framebuffer * fbo;
+    int fbo_width, fbo_height;
+
+    void draw_fbo(int src_x, int src_y);
+#endif
+
     Viewport(int x, int y, int type_id);
     ~Viewport();
     void set_source(int center_x, int center_y, int width, int height);
     void set_width(int w);
     void set_height(int h);
     void draw();
+    bool is_zoomed();
 };
 
 #endif // CHOWDREN_VIEWPORT_H
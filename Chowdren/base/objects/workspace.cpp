@@ -0,0 +1,138 @@
+#include "objects/workspace.h"
+#include <string.h>
+#include <algorithm>
+
+// FNV-1a, also computed by the exporter for constant workspace names
+
+unsigned int hash_workspace_name(const char * str, size_t len)
+{
+    unsigned int hash = 2166136261U;
+    for (size_t i = 0; i < len; ++i) {
+        hash ^= (unsigned char)str[i];
+        hash *= 16777619U;
+    }
+    return hash;
+}
+
+// Workspace
+
+Workspace::Workspace(const std::string & name, unsigned int hash)
+: name(name), hash(hash), next_hash(NULL), view(NULL), view_size(0),
+  owned(true)
+{
+}
+
+void Workspace::set_view(const char * data, size_t size)
+{
+    this->data.clear();
+    view = data;
+    view_size = size;
+    owned = false;
+}
+
+void Workspace::own()
+{
+    if (owned)
+        return;
+    data.assign(view, view_size);
+    view = NULL;
+    view_size = 0;
+    owned = true;
+}
+
+void Workspace::append(const char * new_data, size_t size)
+{
+    if (!owned) {
+        data.reserve(view_size + size);
+        own();
+    }
+    data.append(new_data, size);
+}
+
+// WorkspaceSet
+
+WorkspaceSet::WorkspaceSet()
+: buffer(NULL)
+{
+}
+
+WorkspaceSet::~WorkspaceSet()
+{
+    WorkspaceMap::const_iterator it;
+    for (it = map.begin(); it != map.end(); ++it) {
+        Workspace * workspace = it->second;
+        while (workspace != NULL) {
+            Workspace * next = workspace->next_hash;
+            delete workspace;
+            workspace = next;
+        }
+    }
+    delete[] buffer;
+}
+
+Workspace * WorkspaceSet::find(unsigned int hash, const std::string & name)
+{
+    WorkspaceMap::const_iterator it = map.find(hash);
+    if (it == map.end())
+        return NULL;
+    Workspace * workspace = it->second;
+    while (workspace != NULL && workspace->name != name)
+        workspace = workspace->next_hash;
+    return workspace;
+}
+
+Workspace * WorkspaceSet::add(unsigned int hash, const std::string & name)
+{
+    Workspace * workspace = find(hash, name);
+    if (workspace != NULL)
+        return workspace;
+    workspace = new Workspace(name, hash);
+    Workspace *& slot = map[hash];
+    workspace->next_hash = slot;
+    slot = workspace;
+    return workspace;
+}
+
+// takes over data, which holds a whole workspace file, and points the
+// workspaces in it into data
+void WorkspaceSet::load(char * data, size_t size)
+{
+    size_t pos = 0;
+    while (pos < size) {
+        const char * name_end = (const char*)memchr(data + pos, 0,
+                                                    size - pos);
+        if (name_end == NULL)
+            break;
+        std::string name(data + pos, name_end - (data + pos));
+        pos = (name_end - data) + 1;
+        size_t data_size = 0;
+        if (size - pos >= 4) {
+            const unsigned char * p = (const unsigned char*)(data + pos);
+            data_size = p[0] | (p[1] << 8) | (p[2] << 16) | (p[3] << 24);
+            pos += 4;
+        } else
+            pos = size;
+        data_size = std::min(data_size, size - pos);
+        Workspace * workspace = add(hash_workspace_name(name), name);
+        workspace->set_view(data + pos, data_size);
+        pos += data_size;
+    }
+
+    if (buffer != NULL) {
+        // workspaces the new file did not replace still view the old one
+        const char * end = data + size;
+        WorkspaceMap::const_iterator it;
+        for (it = map.begin(); it != map.end(); ++it) {
+            Workspace * workspace = it->second;
+            for (; workspace != NULL; workspace = workspace->next_hash) {
+                if (workspace->owned)
+                    continue;
+                if (workspace->view >= data && workspace->view <= end)
+                    continue;
+                workspace->own();
+            }
+        }
+        delete[] buffer;
+    }
+    buffer = data;
+}
@@ -0,0 +1,66 @@
+#ifndef CHOWDREN_WORKSPACE_H
+#define CHOWDREN_WORKSPACE_H
+
+#include <string>
+#include "types.h"
+
+unsigned int hash_workspace_name(const char * str, size_t len);
+
+inline unsigned int hash_workspace_name(const std::string & name)
+{
+    return hash_workspace_name(name.data(), name.size());
+}
+
+// workspace data starts out as a view into the buffer of the file it was
+// loaded from, and is only copied into data when it is written to
+
+class Workspace
+{
+public:
+    std::string name;
+    unsigned int hash;
+    Workspace * next_hash;
+    const char * view;
+    size_t view_size;
+    std::string data;
+    bool owned;
+
+    Workspace(const std::string & name, unsigned int hash);
+    void set_view(const char * data, size_t size);
+    void own();
+    void append(const char * data, size_t size);
+
+    const char * get_data()
+    {
+        if (owned)
+            return data.data();
+        return view;
+    }
+
+    size_t get_size()
+    {
+        if (owned)
+            return data.size();
+        return view_size;
+    }
+};
+
+typedef hash_map<unsigned int, Workspace*> WorkspaceMap;
+
+// the workspaces of a BinaryArray. only the buffer of the last loaded file
+// is kept, and workspaces that still view an older one are copied first
+
+class WorkspaceSet
+{
+public:
+    WorkspaceMap map;
+    char * buffer;
+
+    WorkspaceSet();
+    ~WorkspaceSet();
+    Workspace * find(unsigned int hash, const std::string & name);
+    Workspace * add(unsigned int hash, const std::string & name);
+    void load(char * data, size_t size);
+};
+
+#endif // CHOWDREN_WORKSPACE_H
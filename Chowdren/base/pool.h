@@ -3,6 +3,7 @@
 
 #include "types.h"
 #include <stdlib.h>
+#include <algorithm>
 
 /*
 NOTE: This intentionally leaks the blocks used, as we intend to use them for
@@ -51,4 +52,69 @@ public:
     }
 };
 
+/*
+Bump allocator for memory that lives as long as a frame. Instances created
+while a frame is being set up are allocated from here, so they are not
+returned to their pools one by one, and reset() hands all of the memory back
+at once. The chunks are kept for the next frame.
+*/
+
+#define FRAME_ARENA_CHUNK (64 * 1024)
+#define FRAME_ARENA_ALIGN 16
+
+class FrameArena
+{
+public:
+    struct Chunk
+    {
+        unsigned char * data;
+        size_t size;
+    };
+
+    static FrameArena * current;
+
+    vector<Chunk> chunks;
+    size_t chunk_index;
+    size_t offset;
+
+    FrameArena()
+    : chunk_index(0), offset(0)
+    {
+    }
+
+    ~FrameArena()
+    {
+        for (size_t i = 0; i < chunks.size(); ++i)
+            delete[] chunks[i].data;
+    }
+
+    void * allocate(size_t size)
+    {
+        size = (size + FRAME_ARENA_ALIGN - 1) & ~size_t(FRAME_ARENA_ALIGN - 1);
+        while (chunk_index < chunks.size()) {
+            Chunk & chunk = chunks[chunk_index];
+            if (offset + size <= chunk.size) {
+                void * ret = chunk.data + offset;
+                offset += size;
+                return ret;
+            }
+            chunk_index++;
+            offset = 0;
+        }
+        Chunk chunk;
+        chunk.size = std::max(size_t(FRAME_ARENA_CHUNK), size);
+        chunk.data = new unsigned char[chunk.size];
+        chunks.push_back(chunk);
+        chunk_index = chunks.size() - 1;
+        offset = size;
+        return chunk.data;
+    }
+
+    void reset()
+    {
+        chunk_index = 0;
+        offset = 0;
+    }
+};
+
 #endif // CHOWDREN_POOL_H
@@ -2,3 +2,4 @@
 #include "alterables.h"
 
 ObjectPool<Alterables> alterable_pool;
+FrameArena * FrameArena::current = NULL;
@@ -11,3 +11,122 @@
 #include "profiler/ShinyZone.c"
 
 #endif
+
+#ifdef CHOWDREN_CONDITION_PROFILE
+
+#include "profiler.h"
+#include "platform.h"
+#include "fileio.h"
+#include <stdio.h>
+
+static ConditionStats * condition_stats = NULL;
+
+ConditionStats::ConditionStats(const char * name)
+: name(name), evals(0), passes(0), time(0.0), next(condition_stats)
+{
+    condition_stats = this;
+}
+
+double condition_profile_begin()
+{
+    return platform_get_time();
+}
+
+void condition_profile_output(const char * filename)
+{
+    FSFile fp(filename, "w");
+    if (!fp.is_open())
+        return;
+    char line[256];
+    for (ConditionStats * stats = condition_stats; stats != NULL;
+         stats = stats->next) {
+        int size = snprintf(line, sizeof(line), "%s %u %u %.9f\n",
+                            stats->name, stats->evals, stats->passes,
+                            stats->time);
+        fp.write(line, size);
+    }
+    fp.close();
+}
+
+#endif
+
+#ifdef CHOWDREN_ALLOC_PROFILE
+
+#include "profiler.h"
+#include "fileio.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <new>
+
+unsigned int alloc_profile_count = 0;
+static unsigned int alloc_frames = 0;
+static unsigned int alloc_last = 0;
+static unsigned int alloc_max = 0;
+static unsigned long long alloc_total = 0;
+
+static void * alloc_profile_new(size_t size)
+{
+    alloc_profile_count++;
+    if (size == 0)
+        size = 1;
+    for (;;) {
+        void * p = malloc(size);
+        if (p != NULL)
+            return p;
+        // like the default operator new, let the new handler free memory
+        // and try again, and fail with bad_alloc if there is none
+        std::new_handler handler = std::set_new_handler(NULL);
+        std::set_new_handler(handler);
+        if (handler == NULL)
+            throw std::bad_alloc();
+        handler();
+    }
+}
+
+void * operator new(size_t size)
+{
+    return alloc_profile_new(size);
+}
+
+void * operator new[](size_t size)
+{
+    return alloc_profile_new(size);
+}
+
+void operator delete(void * p) throw()
+{
+    free(p);
+}
+
+void operator delete[](void * p) throw()
+{
+    free(p);
+}
+
+void alloc_profile_frame()
+{
+    alloc_last = alloc_profile_count;
+    alloc_profile_count = 0;
+    alloc_frames++;
+    alloc_total += alloc_last;
+    if (alloc_last > alloc_max)
+        alloc_max = alloc_last;
+}
+
+void alloc_profile_output(const char * filename)
+{
+    FSFile fp(filename, "w");
+    if (!fp.is_open())
+        return;
+    char line[256];
+    double average = 0.0;
+    if (alloc_frames > 0)
+        average = double(alloc_total) / alloc_frames;
+    int size = snprintf(line, sizeof(line),
+                        "frames %u\nlast %u\nmax %u\naverage %.2f\n",
+                        alloc_frames, alloc_last, alloc_max, average);
+    fp.write(line, size);
+    fp.close();
+}
+
+#endif
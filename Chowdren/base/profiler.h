@@ -12,4 +12,75 @@
 #define PROFILE_END()
 #endif
 
+#ifdef CHOWDREN_CONDITION_PROFILE
+
+// per-condition statistics for the exporter's condition reordering.
+// the name is "frame group or_index condition", as emitted by the exporter
+
+struct ConditionStats
+{
+    const char * name;
+    unsigned int evals;
+    unsigned int passes;
+    double time;
+    ConditionStats * next;
+
+    ConditionStats(const char * name);
+};
+
+double condition_profile_begin();
+
+// a temporary for each evaluation holds the start time, so conditions that
+// run other events while they are evaluated are timed on their own. the
+// time is added when it is destroyed, at the end of the if condition
+
+struct ConditionTimer
+{
+    ConditionStats & stats;
+    double start;
+
+    ConditionTimer(ConditionStats & stats)
+    : stats(stats), start(condition_profile_begin())
+    {
+        stats.evals++;
+    }
+
+    ~ConditionTimer()
+    {
+        stats.time += condition_profile_begin() - start;
+    }
+
+    operator bool() const
+    {
+        return true;
+    }
+};
+
+inline bool condition_profile_end(ConditionStats & stats, bool value)
+{
+    if (value)
+        stats.passes++;
+    return value;
+}
+
+void condition_profile_output(const char * filename);
+
+// the built-in && makes sure the timer starts before value is evaluated
+#define CONDITION_PROFILE(stats, value) \
+    (ConditionTimer(stats) && condition_profile_end(stats, (value)))
+
+#endif
+
+#ifdef CHOWDREN_ALLOC_PROFILE
+
+// heap allocations per frame, counted by the global operator new.
+// alloc_profile_frame is called once per frame
+
+extern unsigned int alloc_profile_count;
+
+void alloc_profile_frame();
+void alloc_profile_output(const char * filename);
+
+#endif
+
 #endif
@@ -1,3 +1,4 @@
 #include "renderplatform.cpp"
 
 int Render::offset[2];
+RenderStats Render::stats;
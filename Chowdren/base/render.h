@@ -7,6 +7,28 @@ typedef unsigned int Texture;
 
 class FrameObject;
 
+// per-frame counters, reset at the start of every draw
+struct RenderStats
+{
+    unsigned int uniform_uploads;
+    unsigned int uniform_skips;
+    unsigned int back_copies;
+    unsigned int back_shared;
+    unsigned int layer_cache_hits;
+    unsigned int layer_cache_misses;
+    unsigned int layer_cache_saved;
+    unsigned int draw_calls;
+    unsigned int quads;
+
+    void reset()
+    {
+        uniform_uploads = uniform_skips = 0;
+        back_copies = back_shared = 0;
+        layer_cache_hits = layer_cache_misses = layer_cache_saved = 0;
+        draw_calls = quads = 0;
+    }
+};
+
 class Render
 {
 public:
@@ -61,10 +83,12 @@ public:
     };
 
     static int offset[2];
+    static RenderStats stats;
 
     static void init();
 
     static void set_view(int x, int y, int w, int h);
+    static void get_view(int view[4]);
     static void set_offset(int x1, int y1);
     static void draw_quad(float * p, Color color);
     static void draw_quad(int x1, int y1, int x2, int y2, Color color);
@@ -80,6 +104,20 @@ public:
     static void draw_tex(int x1, int y1, int x2, int y2, Color color,
                          Texture tex,
                          float tx1, float ty1, float tx2, float ty2);
+    // draws one quad with the texture address mode set to repeat, so
+    // texcoords outside [0, 1] tile the image. tiles is the number of
+    // image tiles covered, for the stats. returns false if the backend can
+    // not wrap the texture, in which case the caller has to tile manually
+    static bool draw_tex_repeat(int x1, int y1, int x2, int y2, Color color,
+                                Texture tex,
+                                float tx1, float ty1, float tx2, float ty2,
+                                unsigned int tiles);
+    // draws count quads with one texture, batched into as few draw calls
+    // as the vertex buffer allows. boxes holds x1, y1, x2, y2 relative to
+    // x, y and texcoords holds tx1, ty1, tx2, ty2, four values per quad
+    static void draw_tex_run(int x, int y, const int * boxes,
+                             const float * texcoords, int count,
+                             Color color, Texture tex);
     static void clear(Color color);
 
     static void enable_scissor(int x, int y, int w, int h);
@@ -100,6 +138,13 @@ public:
 
     static Texture copy_rect(int x1, int y1, int x2, int y2);
 
+    // background capture for SHADER_HAS_BACK shaders. a capture copies the
+    // union of several non-overlapping objects once, and get_back_tex then
+    // hands out sub-rectangles of it instead of copying per object
+    static void begin_back_capture(int x1, int y1, int x2, int y2);
+    static void end_back_capture();
+    static Texture get_back_tex(int box[4]);
+
     enum Format
     {
         RGBA,
@@ -108,6 +153,10 @@ public:
 
     // textures
     static Texture create_tex(void * pixels, Format f, int width, int height);
+    // replaces a w * h rectangle of an RGBA texture. pixels points at the
+    // first pixel of the rectangle and rows are pitch pixels apart
+    static void update_tex(Texture tex, void * pixels, int pitch,
+                           int x, int y, int w, int h);
     static void delete_tex(Texture tex);
     static void set_filter(Texture tex, bool linear);
 
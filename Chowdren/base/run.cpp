@@ -313,11 +313,15 @@ void GameManager::draw()
     platform_begin_draw();
     PROFILE_END();
 
+    Render::stats.reset();
+
 #ifdef CHOWDREN_USE_SUBAPP
     Frame * render_frame;
+    SubApplication * subapp = NULL;
     if (SubApplication::current != NULL &&
         SubApplication::current->flags & VISIBLE) {
-        render_frame = &SubApplication::current->subapp_frame;
+        subapp = SubApplication::current;
+        render_frame = &subapp->subapp_frame;
     } else
         render_frame = frame;
 #else
@@ -358,7 +362,12 @@ void GameManager::draw()
     }
     draw_interval = (draw_interval + 1) % 3;
 #else
-    render_frame->draw(CHOWDREN_HYBRID_TARGET);
+#ifdef CHOWDREN_SUBAPP_CACHE
+    if (subapp != NULL)
+        subapp->draw_frame(CHOWDREN_HYBRID_TARGET);
+    else
+#endif
+        render_frame->draw(CHOWDREN_HYBRID_TARGET);
     draw_fade();
 #endif
     PROFILE_END();
@@ -422,6 +431,16 @@ void GameManager::set_frame(int index)
         reset_globals();
     }
 
+    // groups skipped in the last frame are evaluated again
+    reset_event_stamps();
+
+#ifdef CHOWDREN_FRAME_SNAPSHOT
+    if (index == frame->index && frame->restart_from_snapshot()) {
+        std::cout << "Restarted frame: " << index << std::endl;
+        return;
+    }
+#endif
+
     std::cout << "Setting frame: " << index << std::endl;
 
 #ifdef CHOWDREN_USER_PROFILER
@@ -429,8 +448,17 @@ void GameManager::set_frame(int index)
     user_log.write(&logline[0], logline.size());
 #endif
 
+#ifdef SHOW_STATS
+    double switch_time = platform_get_time();
+#endif
+
     frame->set_index(index);
 
+#ifdef SHOW_STATS
+    std::cout << "Frame switch took " << platform_get_time() - switch_time
+        << std::endl;
+#endif
+
     std::cout << "Frame set" << std::endl;
 }
 
@@ -735,9 +763,17 @@ bool GameManager::update()
         ss << (platform_get_time() - event_update_time) << " ";
 #endif
 #ifdef SHOW_STATS
-        if (show_stats)
+        if (show_stats) {
             std::cout << "Event update took " <<
                 platform_get_time() - event_update_time << std::endl;
+            if (event_check_count > 0) {
+                std::cout << "Skipped events: " << event_skip_count << "/"
+                    << event_check_count << " ("
+                    << (event_skip_count * 100.0 / event_check_count)
+                    << "%)" << std::endl;
+            }
+            event_check_count = event_skip_count = 0;
+        }
 #endif
 
         if (ret == 0)
@@ -786,6 +822,25 @@ bool GameManager::update()
     }
 #endif
 
+#ifdef CHOWDREN_ALLOC_PROFILE
+    alloc_profile_frame();
+    static int alloc_profile_time = 0;
+    alloc_profile_time -= 1;
+    if (alloc_profile_time <= 0) {
+        alloc_profile_time += 500;
+        alloc_profile_output("allocations.txt");
+    }
+#endif
+
+#ifdef CHOWDREN_CONDITION_PROFILE
+    static int condition_profile_time = 0;
+    condition_profile_time -= 1;
+    if (condition_profile_time <= 0) {
+        condition_profile_time += 500;
+        condition_profile_output("conditions.txt");
+    }
+#endif
+
     return true;
 }
 
@@ -61,6 +61,52 @@ void shader_set_texture()
     texture_shader.begin(NULL, 0, 0);
 }
 
+#define CHECK_BACK(N, S) case Render::N:\
+                             return (S.flags & SHADER_HAS_BACK) != 0
+
+bool shader_has_back(int effect)
+{
+    switch (effect) {
+        CHECK_BACK(SUBTRACT, subtract_shader);
+        CHECK_BACK(CHANNELBLURADD, channelblur_shader);
+        CHECK_BACK(BLURADD, blur_shader);
+        CHECK_BACK(FONTOUTLINE, fontoutline_shader);
+        CHECK_BACK(BRIGHTSATBG, brightsatbg_shader);
+        CHECK_BACK(PERSPECTIVE, perspective_shader);
+        CHECK_BACK(MONOCHROME, monochrome_shader);
+        CHECK_BACK(ZOOMOFFSET, zoomoffset_shader);
+        CHECK_BACK(OFFSET, offset_shader);
+        CHECK_BACK(PIXELOUTLINE, pixeloutline_shader);
+        CHECK_BACK(COLDIRBLUR, coldirblur_shader);
+        CHECK_BACK(CHANNELBLUR, channelblur_shader);
+        CHECK_BACK(ROTATESUB, rotatesub_shader);
+        CHECK_BACK(SUBPX, subpx_shader);
+        CHECK_BACK(SIMPLEMASK, simplemask_shader);
+        CHECK_BACK(MULTIPLY, multiply_shader);
+        CHECK_BACK(NINEPATCH, ninepatch_shader);
+        CHECK_BACK(HARDLIGHT, hardlight_shader);
+        CHECK_BACK(UNDERWATER, underwater_shader);
+        CHECK_BACK(LENS, lens_shader);
+        CHECK_BACK(INVERT, invert_shader);
+        CHECK_BACK(HUE, hue_shader);
+        CHECK_BACK(TINT, tint_shader);
+        CHECK_BACK(OVERLAYALPHA, overlayalpha_shader);
+        CHECK_BACK(GRAIN, grain_shader);
+        CHECK_BACK(GRADIENT, gradient_shader);
+        CHECK_BACK(OFFSETSTATIONARY, offsetstationary_shader);
+        CHECK_BACK(BGBLUR, bgblur_shader);
+        CHECK_BACK(PATTERNOVERLAY, patternoverlay_shader);
+        CHECK_BACK(BGBLOOM, bgbloom_shader);
+        CHECK_BACK(MIXER, mixer_shader);
+        CHECK_BACK(BLUR, blur_shader);
+        CHECK_BACK(DISPLAY, display_shader);
+        CHECK_BACK(LINEARBURN, linearburn_shader);
+        CHECK_BACK(LINEARDODGE, lineardodge_shader);
+        default:
+            return false;
+    }
+}
+
 void shader_set_effect(int effect, FrameObject * obj,
                        int width, int height)
 {
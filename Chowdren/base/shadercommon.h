@@ -30,5 +30,6 @@ void convert_vec4(int value, float & a, float & b, float & c, float & d);
 
 void shader_set_effect(int effect, FrameObject * obj, int width, int height);
 void shader_set_texture();
+bool shader_has_back(int effect);
 
 #endif // CHOWDREN_SHADERCOMMON_H
@@ -35,9 +35,9 @@ public:
 class MixerShader : public BaseShader
 {
 public:
-    static int r;
-    static int g;
-    static int b;
+    static ShaderUniform r;
+    static ShaderUniform g;
+    static ShaderUniform b;
     
     MixerShader()
     : BaseShader(SHADER_COLORMIXER)
@@ -58,14 +58,14 @@ public:
         BaseShader::set_vec4(instance, SHADER_PARAM_B, b);
     }
 };
-int MixerShader::r;
-int MixerShader::g;
-int MixerShader::b;
+ShaderUniform MixerShader::r;
+ShaderUniform MixerShader::g;
+ShaderUniform MixerShader::b;
 
 class HueShader : public BaseShader
 {
 public:
-    static int fHue;
+    static ShaderUniform fHue;
     
     HueShader()
     : BaseShader(SHADER_HUE)
@@ -82,13 +82,13 @@ public:
         BaseShader::set_float(instance, SHADER_PARAM_FHUE, fHue);
     }
 };
-int HueShader::fHue;
+ShaderUniform HueShader::fHue;
 
 class OffsetShader : public BaseShader
 {
 public:
-    static int width;
-    static int height;
+    static ShaderUniform width;
+    static ShaderUniform height;
     
     OffsetShader()
     : BaseShader(SHADER_OFFSET, SHADER_HAS_BACK | SHADER_HAS_TEX_SIZE)
@@ -107,8 +107,8 @@ public:
         BaseShader::set_float(instance, SHADER_PARAM_HEIGHT, height);
     }
 };
-int OffsetShader::width;
-int OffsetShader::height;
+ShaderUniform OffsetShader::width;
+ShaderUniform OffsetShader::height;
 
 class InvertShader : public BaseShader
 {
@@ -130,8 +130,8 @@ public:
 class DodgeBlurShader : public BaseShader
 {
 public:
-    static int vertical;
-    static int radius;
+    static ShaderUniform vertical;
+    static ShaderUniform radius;
     
     DodgeBlurShader()
     : BaseShader(SHADER_DODGEBLUR, SHADER_HAS_BACK | SHADER_HAS_TEX_SIZE)
@@ -150,19 +150,19 @@ public:
         BaseShader::set_float(instance, SHADER_PARAM_RADIUS, radius);
     }
 };
-int DodgeBlurShader::vertical;
-int DodgeBlurShader::radius;
+ShaderUniform DodgeBlurShader::vertical;
+ShaderUniform DodgeBlurShader::radius;
 
 class GrainShader : public BaseShader
 {
 public:
-    static int fStrength;
-    static int fSeed;
-    static int iInvert;
-    static int iR;
-    static int iG;
-    static int iB;
-    static int iA;
+    static ShaderUniform fStrength;
+    static ShaderUniform fSeed;
+    static ShaderUniform iInvert;
+    static ShaderUniform iR;
+    static ShaderUniform iG;
+    static ShaderUniform iB;
+    static ShaderUniform iA;
     
     GrainShader()
     : BaseShader(SHADER_GRAIN)
@@ -191,13 +191,13 @@ public:
         BaseShader::set_int(instance, SHADER_PARAM_IA, iA);
     }
 };
-int GrainShader::fStrength;
-int GrainShader::fSeed;
-int GrainShader::iInvert;
-int GrainShader::iR;
-int GrainShader::iG;
-int GrainShader::iB;
-int GrainShader::iA;
+ShaderUniform GrainShader::fStrength;
+ShaderUniform GrainShader::fSeed;
+ShaderUniform GrainShader::iInvert;
+ShaderUniform GrainShader::iR;
+ShaderUniform GrainShader::iG;
+ShaderUniform GrainShader::iB;
+ShaderUniform GrainShader::iA;
 
 class MultiplyShader : public BaseShader
 {
@@ -236,9 +236,9 @@ public:
 class TintShader : public BaseShader
 {
 public:
-    static int fTintColor;
-    static int fTintPower;
-    static int fOriginalPower;
+    static ShaderUniform fTintColor;
+    static ShaderUniform fTintPower;
+    static ShaderUniform fOriginalPower;
     
     TintShader()
     : BaseShader(SHADER_TINT)
@@ -259,18 +259,18 @@ public:
         BaseShader::set_float(instance, SHADER_PARAM_FORIGINALPOWER, fOriginalPower);
     }
 };
-int TintShader::fTintColor;
-int TintShader::fTintPower;
-int TintShader::fOriginalPower;
+ShaderUniform TintShader::fTintColor;
+ShaderUniform TintShader::fTintPower;
+ShaderUniform TintShader::fOriginalPower;
 
 class ChannelBlurShader : public BaseShader
 {
 public:
-    static int fCoeff;
-    static int iR;
-    static int iG;
-    static int iB;
-    static int iA;
+    static ShaderUniform fCoeff;
+    static ShaderUniform iR;
+    static ShaderUniform iG;
+    static ShaderUniform iB;
+    static ShaderUniform iA;
     
     ChannelBlurShader()
     : BaseShader(SHADER_CHANNELBLUR)
@@ -295,18 +295,18 @@ public:
         BaseShader::set_int(instance, SHADER_PARAM_IA, iA);
     }
 };
-int ChannelBlurShader::fCoeff;
-int ChannelBlurShader::iR;
-int ChannelBlurShader::iG;
-int ChannelBlurShader::iB;
-int ChannelBlurShader::iA;
+ShaderUniform ChannelBlurShader::fCoeff;
+ShaderUniform ChannelBlurShader::iR;
+ShaderUniform ChannelBlurShader::iG;
+ShaderUniform ChannelBlurShader::iB;
+ShaderUniform ChannelBlurShader::iA;
 
 class BgBloomShader : public BaseShader
 {
 public:
-    static int coeff;
-    static int radius;
-    static int exponent;
+    static ShaderUniform coeff;
+    static ShaderUniform radius;
+    static ShaderUniform exponent;
     
     BgBloomShader()
     : BaseShader(SHADER_BGBLOOM, SHADER_HAS_BACK | SHADER_HAS_TEX_SIZE)
@@ -327,20 +327,20 @@ public:
         BaseShader::set_float(instance, SHADER_PARAM_EXPONENT, exponent);
     }
 };
-int BgBloomShader::coeff;
-int BgBloomShader::radius;
-int BgBloomShader::exponent;
+ShaderUniform BgBloomShader::coeff;
+ShaderUniform BgBloomShader::radius;
+ShaderUniform BgBloomShader::exponent;
 
 class UnderwaterShader : public BaseShader
 {
 public:
-    static int fBlur;
-    static int fAmplitudeX;
-    static int fPeriodsX;
-    static int fFreqX;
-    static int fAmplitudeY;
-    static int fPeriodsY;
-    static int fFreqY;
+    static ShaderUniform fBlur;
+    static ShaderUniform fAmplitudeX;
+    static ShaderUniform fPeriodsX;
+    static ShaderUniform fFreqX;
+    static ShaderUniform fAmplitudeY;
+    static ShaderUniform fPeriodsY;
+    static ShaderUniform fFreqY;
     
     UnderwaterShader()
     : BaseShader(SHADER_UNDERWATER)
@@ -369,22 +369,22 @@ public:
         BaseShader::set_float(instance, SHADER_PARAM_FFREQY, fFreqY);
     }
 };
-int UnderwaterShader::fBlur;
-int UnderwaterShader::fAmplitudeX;
-int UnderwaterShader::fPeriodsX;
-int UnderwaterShader::fFreqX;
-int UnderwaterShader::fAmplitudeY;
-int UnderwaterShader::fPeriodsY;
-int UnderwaterShader::fFreqY;
+ShaderUniform UnderwaterShader::fBlur;
+ShaderUniform UnderwaterShader::fAmplitudeX;
+ShaderUniform UnderwaterShader::fPeriodsX;
+ShaderUniform UnderwaterShader::fFreqX;
+ShaderUniform UnderwaterShader::fAmplitudeY;
+ShaderUniform UnderwaterShader::fPeriodsY;
+ShaderUniform UnderwaterShader::fFreqY;
 
 class RotateSubShader : public BaseShader
 {
 public:
-    static int fA;
-    static int fX;
-    static int fY;
-    static int fSx;
-    static int fSy;
+    static ShaderUniform fA;
+    static ShaderUniform fX;
+    static ShaderUniform fY;
+    static ShaderUniform fSx;
+    static ShaderUniform fSy;
     
     RotateSubShader()
     : BaseShader(SHADER_ROTATESUB)
@@ -409,17 +409,17 @@ public:
         BaseShader::set_float(instance, SHADER_PARAM_FSY, fSy);
     }
 };
-int RotateSubShader::fA;
-int RotateSubShader::fX;
-int RotateSubShader::fY;
-int RotateSubShader::fSx;
-int RotateSubShader::fSy;
+ShaderUniform RotateSubShader::fA;
+ShaderUniform RotateSubShader::fX;
+ShaderUniform RotateSubShader::fY;
+ShaderUniform RotateSubShader::fSx;
+ShaderUniform RotateSubShader::fSy;
 
 class SimpleMaskShader : public BaseShader
 {
 public:
-    static int fC;
-    static int fFade;
+    static ShaderUniform fC;
+    static ShaderUniform fFade;
     
     SimpleMaskShader()
     : BaseShader(SHADER_SIMPLEMASK)
@@ -438,16 +438,16 @@ public:
         BaseShader::set_float(instance, SHADER_PARAM_FFADE, fFade);
     }
 };
-int SimpleMaskShader::fC;
-int SimpleMaskShader::fFade;
+ShaderUniform SimpleMaskShader::fC;
+ShaderUniform SimpleMaskShader::fFade;
 
 class OffsetStationaryShader : public BaseShader
 {
 public:
-    static int width;
-    static int height;
-    static int xoff;
-    static int yoff;
+    static ShaderUniform width;
+    static ShaderUniform height;
+    static ShaderUniform xoff;
+    static ShaderUniform yoff;
     
     OffsetStationaryShader()
     : BaseShader(SHADER_OFFSETSTATIONARY)
@@ -470,19 +470,19 @@ public:
         BaseShader::set_float(instance, SHADER_PARAM_YOFF, yoff);
     }
 };
-int OffsetStationaryShader::width;
-int OffsetStationaryShader::height;
-int OffsetStationaryShader::xoff;
-int OffsetStationaryShader::yoff;
+ShaderUniform OffsetStationaryShader::width;
+ShaderUniform OffsetStationaryShader::height;
+ShaderUniform OffsetStationaryShader::xoff;
+ShaderUniform OffsetStationaryShader::yoff;
 
 class PatternOverlayShader : public BaseShader
 {
 public:
-    static int x;
-    static int y;
-    static int width;
-    static int height;
-    static int alpha;
+    static ShaderUniform x;
+    static ShaderUniform y;
+    static ShaderUniform width;
+    static ShaderUniform height;
+    static ShaderUniform alpha;
     
     PatternOverlayShader()
     : BaseShader(SHADER_PATTERNOVERLAY, SHADER_HAS_TEX_SIZE, "pattern")
@@ -508,18 +508,18 @@ public:
         BaseShader::set_image(instance, SHADER_PARAM_PATTERN);
     }
 };
-int PatternOverlayShader::x;
-int PatternOverlayShader::y;
-int PatternOverlayShader::width;
-int PatternOverlayShader::height;
-int PatternOverlayShader::alpha;
+ShaderUniform PatternOverlayShader::x;
+ShaderUniform PatternOverlayShader::y;
+ShaderUniform PatternOverlayShader::width;
+ShaderUniform PatternOverlayShader::height;
+ShaderUniform PatternOverlayShader::alpha;
 
 class SubPxShader : public BaseShader
 {
 public:
-    static int x;
-    static int y;
-    static int limit;
+    static ShaderUniform x;
+    static ShaderUniform y;
+    static ShaderUniform limit;
     
     SubPxShader()
     : BaseShader(SHADER_SUBPX, SHADER_HAS_TEX_SIZE)
@@ -540,19 +540,19 @@ public:
         BaseShader::set_int(instance, SHADER_PARAM_LIMIT, limit);
     }
 };
-int SubPxShader::x;
-int SubPxShader::y;
-int SubPxShader::limit;
+ShaderUniform SubPxShader::x;
+ShaderUniform SubPxShader::y;
+ShaderUniform SubPxShader::limit;
 
 class ZoomOffsetShader : public BaseShader
 {
 public:
-    static int fX;
-    static int fY;
-    static int fWidth;
-    static int fHeight;
-    static int fZoomX;
-    static int fZoomY;
+    static ShaderUniform fX;
+    static ShaderUniform fY;
+    static ShaderUniform fWidth;
+    static ShaderUniform fHeight;
+    static ShaderUniform fZoomX;
+    static ShaderUniform fZoomY;
     
     ZoomOffsetShader()
     : BaseShader(SHADER_ZOOMOFFSET)
@@ -579,27 +579,27 @@ public:
         BaseShader::set_float(instance, SHADER_PARAM_FZOOMY, fZoomY);
     }
 };
-int ZoomOffsetShader::fX;
-int ZoomOffsetShader::fY;
-int ZoomOffsetShader::fWidth;
-int ZoomOffsetShader::fHeight;
-int ZoomOffsetShader::fZoomX;
-int ZoomOffsetShader::fZoomY;
+ShaderUniform ZoomOffsetShader::fX;
+ShaderUniform ZoomOffsetShader::fY;
+ShaderUniform ZoomOffsetShader::fWidth;
+ShaderUniform ZoomOffsetShader::fHeight;
+ShaderUniform ZoomOffsetShader::fZoomX;
+ShaderUniform ZoomOffsetShader::fZoomY;
 
 class GradientShader : public BaseShader
 {
 public:
-    static int fArgb;
-    static int fAa;
-    static int fBrgb;
-    static int fBa;
-    static int fCoeff;
-    static int fOffset;
-    static int fFade;
-    static int iT;
-    static int iF;
-    static int iR;
-    static int iMask;
+    static ShaderUniform fArgb;
+    static ShaderUniform fAa;
+    static ShaderUniform fBrgb;
+    static ShaderUniform fBa;
+    static ShaderUniform fCoeff;
+    static ShaderUniform fOffset;
+    static ShaderUniform fFade;
+    static ShaderUniform iT;
+    static ShaderUniform iF;
+    static ShaderUniform iR;
+    static ShaderUniform iMask;
     
     GradientShader()
     : BaseShader(SHADER_GRADIENT)
@@ -636,22 +636,22 @@ public:
         BaseShader::set_int(instance, SHADER_PARAM_IMASK, iMask);
     }
 };
-int GradientShader::fArgb;
-int GradientShader::fAa;
-int GradientShader::fBrgb;
-int GradientShader::fBa;
-int GradientShader::fCoeff;
-int GradientShader::fOffset;
-int GradientShader::fFade;
-int GradientShader::iT;
-int GradientShader::iF;
-int GradientShader::iR;
-int GradientShader::iMask;
+ShaderUniform GradientShader::fArgb;
+ShaderUniform GradientShader::fAa;
+ShaderUniform GradientShader::fBrgb;
+ShaderUniform GradientShader::fBa;
+ShaderUniform GradientShader::fCoeff;
+ShaderUniform GradientShader::fOffset;
+ShaderUniform GradientShader::fFade;
+ShaderUniform GradientShader::iT;
+ShaderUniform GradientShader::iF;
+ShaderUniform GradientShader::iR;
+ShaderUniform GradientShader::iMask;
 
 class OverlayAlphaShader : public BaseShader
 {
 public:
-    static int bgA;
+    static ShaderUniform bgA;
     
     OverlayAlphaShader()
     : BaseShader(SHADER_OVERLAYALPHA, SHADER_HAS_BACK)
@@ -668,13 +668,13 @@ public:
         BaseShader::set_float(instance, SHADER_PARAM_BGA, bgA);
     }
 };
-int OverlayAlphaShader::bgA;
+ShaderUniform OverlayAlphaShader::bgA;
 
 class LensShader : public BaseShader
 {
 public:
-    static int fCoeff;
-    static int fBase;
+    static ShaderUniform fCoeff;
+    static ShaderUniform fBase;
     
     LensShader()
     : BaseShader(SHADER_LENS, SHADER_HAS_BACK)
@@ -693,23 +693,23 @@ public:
         BaseShader::set_float(instance, SHADER_PARAM_FBASE, fBase);
     }
 };
-int LensShader::fCoeff;
-int LensShader::fBase;
+ShaderUniform LensShader::fCoeff;
+ShaderUniform LensShader::fBase;
 
 class ColDirBlurShader : public BaseShader
 {
 public:
-    static int rr;
-    static int rg;
-    static int rb;
-    static int gr;
-    static int gg;
-    static int gb;
-    static int br;
-    static int bg;
-    static int bb;
-    static int fAngle;
-    static int fCoeff;
+    static ShaderUniform rr;
+    static ShaderUniform rg;
+    static ShaderUniform rb;
+    static ShaderUniform gr;
+    static ShaderUniform gg;
+    static ShaderUniform gb;
+    static ShaderUniform br;
+    static ShaderUniform bg;
+    static ShaderUniform bb;
+    static ShaderUniform fAngle;
+    static ShaderUniform fCoeff;
     
     ColDirBlurShader()
     : BaseShader(SHADER_COLDIRBLUR, SHADER_HAS_BACK)
@@ -746,26 +746,26 @@ public:
         BaseShader::set_float(instance, SHADER_PARAM_FCOEFF, fCoeff);
     }
 };
-int ColDirBlurShader::rr;
-int ColDirBlurShader::rg;
-int ColDirBlurShader::rb;
-int ColDirBlurShader::gr;
-int ColDirBlurShader::gg;
-int ColDirBlurShader::gb;
-int ColDirBlurShader::br;
-int ColDirBlurShader::bg;
-int ColDirBlurShader::bb;
-int ColDirBlurShader::fAngle;
-int ColDirBlurShader::fCoeff;
+ShaderUniform ColDirBlurShader::rr;
+ShaderUniform ColDirBlurShader::rg;
+ShaderUniform ColDirBlurShader::rb;
+ShaderUniform ColDirBlurShader::gr;
+ShaderUniform ColDirBlurShader::gg;
+ShaderUniform ColDirBlurShader::gb;
+ShaderUniform ColDirBlurShader::br;
+ShaderUniform ColDirBlurShader::bg;
+ShaderUniform ColDirBlurShader::bb;
+ShaderUniform ColDirBlurShader::fAngle;
+ShaderUniform ColDirBlurShader::fCoeff;
 
 class PerspectiveShader : public BaseShader
 {
 public:
-    static int effect;
-    static int direction;
-    static int zoom;
-    static int offset;
-    static int sine_waves;
+    static ShaderUniform effect;
+    static ShaderUniform direction;
+    static ShaderUniform zoom;
+    static ShaderUniform offset;
+    static ShaderUniform sine_waves;
     
     PerspectiveShader()
     : BaseShader(SHADER_PERSPECTIVE, SHADER_HAS_TEX_SIZE)
@@ -790,22 +790,22 @@ public:
         BaseShader::set_int(instance, SHADER_PARAM_SINE_WAVES, sine_waves);
     }
 };
-int PerspectiveShader::effect;
-int PerspectiveShader::direction;
-int PerspectiveShader::zoom;
-int PerspectiveShader::offset;
-int PerspectiveShader::sine_waves;
+ShaderUniform PerspectiveShader::effect;
+ShaderUniform PerspectiveShader::direction;
+ShaderUniform PerspectiveShader::zoom;
+ShaderUniform PerspectiveShader::offset;
+ShaderUniform PerspectiveShader::sine_waves;
 
 class NinePatchShader : public BaseShader
 {
 public:
-    static int xScale;
-    static int yScale;
-    static int fArgb;
-    static int fAa;
-    static int fBrgb;
-    static int fBa;
-    static int fOffset;
+    static ShaderUniform xScale;
+    static ShaderUniform yScale;
+    static ShaderUniform fArgb;
+    static ShaderUniform fAa;
+    static ShaderUniform fBrgb;
+    static ShaderUniform fBa;
+    static ShaderUniform fOffset;
     
     NinePatchShader()
     : BaseShader(SHADER_9G, SHADER_HAS_TEX_SIZE)
@@ -834,18 +834,18 @@ public:
         BaseShader::set_float(instance, SHADER_PARAM_FOFFSET, fOffset);
     }
 };
-int NinePatchShader::xScale;
-int NinePatchShader::yScale;
-int NinePatchShader::fArgb;
-int NinePatchShader::fAa;
-int NinePatchShader::fBrgb;
-int NinePatchShader::fBa;
-int NinePatchShader::fOffset;
+ShaderUniform NinePatchShader::xScale;
+ShaderUniform NinePatchShader::yScale;
+ShaderUniform NinePatchShader::fArgb;
+ShaderUniform NinePatchShader::fAa;
+ShaderUniform NinePatchShader::fBrgb;
+ShaderUniform NinePatchShader::fBa;
+ShaderUniform NinePatchShader::fOffset;
 
 class PixelOutlineShader : public BaseShader
 {
 public:
-    static int color;
+    static ShaderUniform color;
     
     PixelOutlineShader()
     : BaseShader(SHADER_PIXELOUTLINE, SHADER_HAS_TEX_SIZE)
@@ -862,13 +862,13 @@ public:
         BaseShader::set_vec4(instance, SHADER_PARAM_COLOR, color);
     }
 };
-int PixelOutlineShader::color;
+ShaderUniform PixelOutlineShader::color;
 
 class BrightSatBgShader : public BaseShader
 {
 public:
-    static int Brightness;
-    static int Saturation;
+    static ShaderUniform Brightness;
+    static ShaderUniform Saturation;
     
     BrightSatBgShader()
     : BaseShader(SHADER_BRIGHTSATBG, SHADER_HAS_BACK)
@@ -887,15 +887,15 @@ public:
         BaseShader::set_float(instance, SHADER_PARAM_SATURATION, Saturation);
     }
 };
-int BrightSatBgShader::Brightness;
-int BrightSatBgShader::Saturation;
+ShaderUniform BrightSatBgShader::Brightness;
+ShaderUniform BrightSatBgShader::Saturation;
 
 class BgBlurShader : public BaseShader
 {
 public:
-    static int fX;
-    static int fY;
-    static int fA;
+    static ShaderUniform fX;
+    static ShaderUniform fY;
+    static ShaderUniform fA;
     
     BgBlurShader()
     : BaseShader(SHADER_BGBLUR, SHADER_HAS_BACK | SHADER_HAS_TEX_SIZE)
@@ -916,17 +916,17 @@ public:
         BaseShader::set_float(instance, SHADER_PARAM_FA, fA);
     }
 };
-int BgBlurShader::fX;
-int BgBlurShader::fY;
-int BgBlurShader::fA;
+ShaderUniform BgBlurShader::fX;
+ShaderUniform BgBlurShader::fY;
+ShaderUniform BgBlurShader::fA;
 
 class PixelScaleShader : public BaseShader
 {
 public:
-    static int x_scale;
-    static int y_scale;
-    static int x_size;
-    static int y_size;
+    static ShaderUniform x_scale;
+    static ShaderUniform y_scale;
+    static ShaderUniform x_size;
+    static ShaderUniform y_size;
     
     PixelScaleShader()
     : BaseShader(SHADER_PIXELSCALE)
@@ -949,15 +949,15 @@ public:
         BaseShader::set_float(instance, SHADER_PARAM_Y_SIZE, y_size);
     }
 };
-int PixelScaleShader::x_scale;
-int PixelScaleShader::y_scale;
-int PixelScaleShader::x_size;
-int PixelScaleShader::y_size;
+ShaderUniform PixelScaleShader::x_scale;
+ShaderUniform PixelScaleShader::y_scale;
+ShaderUniform PixelScaleShader::x_size;
+ShaderUniform PixelScaleShader::y_size;
 
 class BlurShader : public BaseShader
 {
 public:
-    static int radius;
+    static ShaderUniform radius;
     
     BlurShader()
     : BaseShader(SHADER_BLUR, SHADER_HAS_TEX_SIZE)
@@ -974,7 +974,7 @@ public:
         BaseShader::set_float(instance, SHADER_PARAM_RADIUS, radius);
     }
 };
-int BlurShader::radius;
+ShaderUniform BlurShader::radius;
 
 class TextureShader : public BaseShader
 {
@@ -1047,9 +1047,9 @@ public:
 class DisplayShader : public BaseShader
 {
 public:
-    static int fPeriods;
-    static int fOffset;
-    static int fAmplitude;
+    static ShaderUniform fPeriods;
+    static ShaderUniform fOffset;
+    static ShaderUniform fAmplitude;
     
     DisplayShader()
     : BaseShader(SHADER_DISPLAY)
@@ -1070,14 +1070,14 @@ public:
         BaseShader::set_float(instance, SHADER_PARAM_FAMPLITUDE, fAmplitude);
     }
 };
-int DisplayShader::fPeriods;
-int DisplayShader::fOffset;
-int DisplayShader::fAmplitude;
+ShaderUniform DisplayShader::fPeriods;
+ShaderUniform DisplayShader::fOffset;
+ShaderUniform DisplayShader::fAmplitude;
 
 class FontOutlineShader : public BaseShader
 {
 public:
-    static int color;
+    static ShaderUniform color;
     
     FontOutlineShader()
     : BaseShader(SHADER_FONTOUTLINE, SHADER_HAS_TEX_SIZE)
@@ -1094,7 +1094,7 @@ public:
         BaseShader::set_vec4(instance, SHADER_PARAM_COLOR, color);
     }
 };
-int FontOutlineShader::color;
+ShaderUniform FontOutlineShader::color;
 
 SubtractShader subtract_shader;
 MonochromeShader monochrome_shader;
@@ -0,0 +1,280 @@
+#include "chowconfig.h"
+
+#ifdef CHOWDREN_FRAME_SNAPSHOT
+
+#include "frame.h"
+#include "snapshot.h"
+#include "collision.h"
+#include "movement.h"
+#include "crossrand.h"
+
+// FrameSnapshot
+
+FrameSnapshot::FrameSnapshot()
+: pos(0), id(0), frame_index(-1), valid(false)
+{
+}
+
+void FrameSnapshot::clear()
+{
+    data.clear();
+    instances.clear();
+    valid = false;
+}
+
+bool FrameSnapshot::is_valid(Frame * frame) const
+{
+    return valid && frame->index == frame_index && frame->snapshot_id == id;
+}
+
+bool FrameSnapshot::take(Frame * frame)
+{
+    clear();
+
+    vector<Layer>::iterator layer;
+    for (layer = frame->layers.begin(); layer != frame->layers.end();
+         ++layer) {
+        if (layer->back != NULL)
+            return false;
+    }
+
+    write(cross_seed);
+    write(frame->width);
+    write(frame->height);
+    write(frame->virtual_width);
+    write(frame->virtual_height);
+    write(frame->background_color);
+    write(frame->off_x);
+    write(frame->off_y);
+    write(frame->new_off_x);
+    write(frame->new_off_y);
+    write(frame->loop_count);
+    write(frame->frame_time);
+
+    for (layer = frame->layers.begin(); layer != frame->layers.end();
+         ++layer) {
+        write(layer->x);
+        write(layer->y);
+        write(layer->scroll_x);
+        write(layer->scroll_y);
+        write(layer->visible);
+        write(layer->blend_color);
+        write((unsigned int)layer->instances.size());
+        LayerInstances::iterator it;
+        for (it = layer->instances.begin(); it != layer->instances.end();
+             ++it)
+            write(&*it);
+    }
+
+    ObjectList::iterator it;
+    for (unsigned int i = 0; i < MAX_OBJECT_ID; ++i) {
+        ObjectList & list = frame->instances.items[i];
+        write((unsigned int)list.size());
+        for (it = list.begin(); it != list.end(); ++it) {
+            FrameObject * obj = it->obj;
+            if (!(obj->flags & BACKGROUND))
+                obj->flags |= SNAPSHOT;
+            write(obj);
+            instances.push_back(obj);
+        }
+    }
+
+    FlatObjectList::const_iterator obj;
+    for (obj = instances.begin(); obj != instances.end(); ++obj)
+        (*obj)->save_state(*this);
+
+    frame->data->save_state(*this);
+
+    std::sort(instances.begin(), instances.end());
+    id = frame->snapshot_id;
+    frame_index = frame->index;
+    valid = true;
+    return true;
+}
+
+bool FrameSnapshot::restore(Frame * frame)
+{
+    if (!is_valid(frame))
+        return false;
+
+    // background instances are not parked, so new ones cannot be taken out
+    ObjectList::iterator it;
+    for (unsigned int i = 0; i < MAX_OBJECT_ID; ++i) {
+        ObjectList & list = frame->instances.items[i];
+        for (it = list.begin(); it != list.end(); ++it) {
+            FrameObject * obj = it->obj;
+            if (obj->flags & BACKGROUND && !has_instance(obj))
+                return false;
+        }
+    }
+
+    // destroy the instances created after the snapshot, and take the rest
+    // out of their layers
+    frame->destroyed_instances.clear();
+    for (unsigned int i = 0; i < MAX_OBJECT_ID; ++i) {
+        ObjectList & list = frame->instances.items[i];
+        for (it = list.begin(); it != list.end(); ++it) {
+            FrameObject * obj = it->obj;
+            if (obj->flags & BACKGROUND)
+                continue;
+            if (!has_instance(obj)) {
+                obj->layer->remove_object(obj);
+                obj->dealloc();
+                continue;
+            }
+            if (obj->collision != NULL)
+                obj->collision->remove_proxy();
+        }
+        list.clear();
+    }
+
+    FlatObjectList::iterator parked = frame->parked_instances.begin();
+    while (parked != frame->parked_instances.end()) {
+        if (has_instance(*parked))
+            parked = frame->parked_instances.erase(parked);
+        else
+            ++parked;
+    }
+
+    pos = 0;
+    read(cross_seed);
+    read(frame->width);
+    read(frame->height);
+    read(frame->virtual_width);
+    read(frame->virtual_height);
+    read(frame->background_color);
+    read(frame->off_x);
+    read(frame->off_y);
+    read(frame->new_off_x);
+    read(frame->new_off_y);
+    read(frame->loop_count);
+    read(frame->frame_time);
+
+    // instances may have moved between layers, so unlink all of them first
+    vector<Layer>::iterator layer;
+    for (layer = frame->layers.begin(); layer != frame->layers.end();
+         ++layer) {
+        layer->instances.clear();
+        delete layer->back;
+        layer->back = NULL;
+    }
+
+    for (layer = frame->layers.begin(); layer != frame->layers.end();
+         ++layer) {
+        read(layer->x);
+        read(layer->y);
+        read(layer->scroll_x);
+        read(layer->scroll_y);
+        read(layer->visible);
+        read(layer->blend_color);
+        layer->update_position();
+        unsigned int count;
+        read(count);
+        for (unsigned int i = 0; i < count; ++i) {
+            FrameObject * obj;
+            read(obj);
+            obj->layer = &*layer;
+            layer->add_object(obj);
+        }
+    }
+
+    for (unsigned int i = 0; i < MAX_OBJECT_ID; ++i) {
+        ObjectList & list = frame->instances.items[i];
+        unsigned int count;
+        read(count);
+        for (unsigned int j = 0; j < count; ++j) {
+            FrameObject * obj;
+            read(obj);
+            list.add(obj);
+        }
+    }
+
+    for (unsigned int i = 0; i < MAX_OBJECT_ID; ++i) {
+        ObjectList & list = frame->instances.items[i];
+        for (it = list.begin(); it != list.end(); ++it) {
+            FrameObject * obj = it->obj;
+            obj->load_state(*this);
+            if (obj->flags & BACKGROUND || obj->collision == NULL)
+                continue;
+            obj->collision->update_aabb();
+            obj->collision->create_proxy();
+        }
+    }
+
+    frame->data->load_state(*this);
+    return true;
+}
+
+// FrameObject
+
+void FrameObject::save_state(FrameSnapshot & snapshot)
+{
+    snapshot.write(x);
+    snapshot.write(y);
+    snapshot.write(flags);
+    snapshot.write(direction);
+    snapshot.write(width);
+    snapshot.write(height);
+    snapshot.write(blend_color);
+    snapshot.write(effect);
+
+    if (alterables != NULL) {
+        snapshot.write(alterables->values);
+        snapshot.write(alterables->flags);
+        for (int i = 0; i < ALT_STRINGS; ++i)
+            snapshot.write(alterables->strings.values[i]);
+    }
+
+    int movement_index = -1;
+    for (int i = 0; i < movement_count; ++i) {
+        if (movements[i] != movement)
+            continue;
+        movement_index = i;
+        break;
+    }
+    snapshot.write(movement_index);
+    if (movement_index != -1)
+        movement->save_state(snapshot);
+}
+
+void FrameObject::load_state(FrameSnapshot & snapshot)
+{
+    snapshot.read(x);
+    snapshot.read(y);
+    snapshot.read(flags);
+    snapshot.read(direction);
+    snapshot.read(width);
+    snapshot.read(height);
+    snapshot.read(blend_color);
+    snapshot.read(effect);
+
+    if (alterables != NULL) {
+        snapshot.read(alterables->values);
+        snapshot.read(alterables->flags);
+        for (int i = 0; i < ALT_STRINGS; ++i)
+            snapshot.read(alterables->strings.values[i]);
+    }
+
+    int movement_index;
+    snapshot.read(movement_index);
+    if (movement_index == -1)
+        return;
+    Movement * new_movement = movements[movement_index];
+    if (movement != new_movement) {
+        // a movement that is not in the list was made by an action, and is
+        // owned by the instance
+        bool owned = true;
+        for (int i = 0; i < movement_count; ++i) {
+            if (movements[i] != movement)
+                continue;
+            owned = false;
+            break;
+        }
+        if (owned)
+            delete movement;
+        movement = new_movement;
+    }
+    movement->load_state(snapshot);
+}
+
+#endif // CHOWDREN_FRAME_SNAPSHOT
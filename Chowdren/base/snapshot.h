@@ -0,0 +1,82 @@
+#ifndef CHOWDREN_SNAPSHOT_H
+#define CHOWDREN_SNAPSHOT_H
+
+#include "frameobject.h"
+#include <string>
+#include <string.h>
+
+class Frame;
+
+// compact binary copy of the state of a running frame: the instances with
+// their alterables and movement, the layer positions, the frame timers,
+// the generated frame members and the random seed.
+// instances are referred to by pointer, so instances that are destroyed
+// while a snapshot refers to them are parked by the frame instead of freed,
+// and instances created after the snapshot are destroyed on restore.
+// pasted backgrounds are not copied, and are dropped on restore.
+
+class FrameSnapshot
+{
+public:
+    vector<char> data;
+    size_t pos;
+    FlatObjectList instances;
+    unsigned int id;
+    int frame_index;
+    bool valid;
+
+    FrameSnapshot();
+    bool take(Frame * frame);
+    bool restore(Frame * frame);
+    void clear();
+    bool is_valid(Frame * frame) const;
+
+    bool has_instance(FrameObject * obj) const
+    {
+        return std::binary_search(instances.begin(), instances.end(), obj);
+    }
+
+    template <class T>
+    void write(const T & value)
+    {
+        size_t size = data.size();
+        data.resize(size + sizeof(T));
+        memcpy(&data[size], &value, sizeof(T));
+    }
+
+    void write(const std::string & value)
+    {
+        write((unsigned int)value.size());
+        data.insert(data.end(), value.begin(), value.end());
+    }
+
+    void write(const InternString & value)
+    {
+        write(value.get());
+    }
+
+    template <class T>
+    void read(T & value)
+    {
+        memcpy(&value, &data[pos], sizeof(T));
+        pos += sizeof(T);
+    }
+
+    void read(std::string & value)
+    {
+        unsigned int size;
+        read(size);
+        value.assign(&data[pos], size);
+        pos += size;
+    }
+
+    void read(InternString & value)
+    {
+        unsigned int size;
+        read(size);
+        value.set(std::string(&data[pos], size));
+        pos += size;
+    }
+};
+
+#endif // CHOWDREN_SNAPSHOT_H
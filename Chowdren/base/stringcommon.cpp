@@ -1,6 +1,8 @@
 #include <limits>
 #include <string>
 #include <stdio.h>
+#include <string.h>
+#include "stringcommon.h"
 
 #define AT_END() (p >= end)
 #define INCREMENT_PTR() if (++p >= end) goto parse_end
@@ -93,18 +95,17 @@ const char DIGITS[] =
     "6061626364656667686970717273747576777879"
     "8081828384858687888990919293949596979899";
 
-std::string fast_itoa(int value)
+int write_itoa(int value, char * out)
 {
     enum {BUFFER_SIZE = 16};
     char buffer[BUFFER_SIZE];
-    char *str;
 
     unsigned int abs_value = static_cast<unsigned int>(value);
     bool negative = value < 0;
     if (negative)
       abs_value = 0 - abs_value;
 
-    char *buffer_end = buffer + BUFFER_SIZE - 1;
+    char *buffer_end = buffer + BUFFER_SIZE;
     while (abs_value >= 100) {
         // Integer division is slow so do it for a group of two digits instead
         // of for every digit. The idea comes from the talk by Alexandrescu
@@ -122,26 +123,25 @@ std::string fast_itoa(int value)
         *--buffer_end = DIGITS[index];
     }
 
-    str = buffer_end;
-
     if (negative)
       *--buffer_end = '-';
 
-    return std::string(buffer_end, buffer - buffer_end + BUFFER_SIZE - 1);
+    int size = int(buffer + BUFFER_SIZE - buffer_end);
+    memcpy(out, buffer_end, size);
+    return size;
 }
 
-std::string fast_lltoa(long long value)
+int write_lltoa(long long value, char * out)
 {
     enum {BUFFER_SIZE = 24};
     char buffer[BUFFER_SIZE];
-    char *str;
 
     unsigned long long abs_value = static_cast<unsigned long long>(value);
     bool negative = value < 0;
     if (negative)
       abs_value = 0 - abs_value;
 
-    char *buffer_end = buffer + BUFFER_SIZE - 1;
+    char *buffer_end = buffer + BUFFER_SIZE;
     while (abs_value >= 100) {
         // Integer division is slow so do it for a group of two digits instead
         // of for every digit. The idea comes from the talk by Alexandrescu
@@ -159,15 +159,15 @@ std::string fast_lltoa(long long value)
         *--buffer_end = DIGITS[index];
     }
 
-    str = buffer_end;
-
     if (negative)
       *--buffer_end = '-';
 
-    return std::string(buffer_end, buffer - buffer_end + BUFFER_SIZE - 1);
+    int size = int(buffer + BUFFER_SIZE - buffer_end);
+    memcpy(out, buffer_end, size);
+    return size;
 }
 
-std::string fast_dtoa(double value)
+int write_dtoa(double value, char * out)
 {
     char buffer[16];
 
@@ -188,10 +188,8 @@ std::string fast_dtoa(double value)
       normal printf behavior is to print EVERY whole number digit
       which can be 100s of characters overflowing your buffers == bad
     */
-    if (value > thres_max) {
-        sprintf(&buffer[0], "%e", neg ? -value : value);
-        return std::string(buffer);
-    }
+    if (value > thres_max)
+        return snprintf(out, NUMBER_STRING_SIZE, "%e", neg ? -value : value);
 
     char* wstr = &buffer[15];
     int whole = (int) value;
@@ -244,7 +242,27 @@ std::string fast_dtoa(double value)
     if (neg) {
         *wstr-- = '-';
     }
-    return std::string(wstr + 1, &buffer[15] - wstr);
+    int size = int(&buffer[15] - wstr);
+    memcpy(out, wstr + 1, size);
+    return size;
+}
+
+std::string fast_itoa(int value)
+{
+    char buffer[NUMBER_STRING_SIZE];
+    return std::string(buffer, write_itoa(value, buffer));
+}
+
+std::string fast_lltoa(long long value)
+{
+    char buffer[NUMBER_STRING_SIZE];
+    return std::string(buffer, write_lltoa(value, buffer));
+}
+
+std::string fast_dtoa(double value)
+{
+    char buffer[NUMBER_STRING_SIZE];
+    return std::string(buffer, write_dtoa(value, buffer));
 }
 
 int fast_atoi(const std::string & src)
@@ -280,3 +298,222 @@ int fast_atoi(const std::string & src)
 parse_end:
     return value * sign;
 }
+
+// MultiReplace
+
+inline unsigned char fold_char(unsigned char c)
+{
+    if (c >= 'A' && c <= 'Z')
+        return c + ('a' - 'A');
+    return c;
+}
+
+static std::string fold_string(const std::string & str)
+{
+    std::string ret(str);
+    for (unsigned int i = 0; i < ret.size(); ++i)
+        ret[i] = fold_char(ret[i]);
+    return ret;
+}
+
+// true if occurrences of a and b in a string can share characters, i.e.
+// one contains the other or a suffix of one is a prefix of the other
+static bool can_overlap(const std::string & a, const std::string & b)
+{
+    if (a.find(b) != std::string::npos || b.find(a) != std::string::npos)
+        return true;
+    unsigned int size = std::min(a.size(), b.size());
+    for (unsigned int n = 1; n < size; ++n) {
+        if (a.compare(a.size() - n, n, b, 0, n) == 0)
+            return true;
+        if (b.compare(b.size() - n, n, a, 0, n) == 0)
+            return true;
+    }
+    return false;
+}
+
+MultiReplace::MultiReplace()
+: alphabet(1)
+{
+    memset(classes, 0, sizeof(classes));
+}
+
+void MultiReplace::clear()
+{
+    rules.clear();
+    stages.clear();
+    next.clear();
+    node_rules.clear();
+}
+
+void MultiReplace::add(const std::string & from, const std::string & to)
+{
+    if (from.empty())
+        return;
+    rules.resize(rules.size() + 1);
+    Rule & rule = rules.back();
+    rule.from = fold_string(from);
+    rule.to = to;
+}
+
+bool MultiReplace::interacts(int a, int b)
+{
+    const std::string & from_a = rules[a].from;
+    const std::string & from_b = rules[b].from;
+    if (can_overlap(from_a, from_b))
+        return true;
+    // a later pattern must not be able to match anything an earlier rule
+    // writes. removing text can join any two characters.
+    if (rules[a].to.empty())
+        return from_b.size() > 1;
+    return can_overlap(fold_string(rules[a].to), from_b);
+}
+
+int MultiReplace::add_node()
+{
+    int node = int(node_rules.size());
+    node_rules.push_back(-1);
+    next.resize(next.size() + alphabet, -1);
+    return node;
+}
+
+void MultiReplace::build_stage(int start, int end)
+{
+    Stage stage;
+    stage.root = add_node();
+    stage.start = start;
+    stage.end = end;
+    stages.push_back(stage);
+    int root = stage.root;
+
+    for (int i = start; i < end; ++i) {
+        const std::string & from = rules[i].from;
+        int node = root;
+        for (unsigned int ii = 0; ii < from.size(); ++ii) {
+            int c = classes[(unsigned char)from[ii]];
+            int child = next[node * alphabet + c];
+            if (child == -1) {
+                child = add_node();
+                next[node * alphabet + c] = child;
+            }
+            node = child;
+        }
+        node_rules[node] = i;
+    }
+
+    // breadth-first failure links, folded into complete transitions
+    vector<int> fail(node_rules.size(), root);
+    vector<int> queue;
+    for (int c = 0; c < alphabet; ++c) {
+        int & child = next[root * alphabet + c];
+        if (child == -1) {
+            child = root;
+            continue;
+        }
+        fail[child] = root;
+        queue.push_back(child);
+    }
+    for (unsigned int i = 0; i < queue.size(); ++i) {
+        int node = queue[i];
+        int fail_node = fail[node];
+        for (int c = 0; c < alphabet; ++c) {
+            int child = next[node * alphabet + c];
+            int fail_next = next[fail_node * alphabet + c];
+            if (child == -1) {
+                next[node * alphabet + c] = fail_next;
+                continue;
+            }
+            fail[child] = fail_next;
+            queue.push_back(child);
+        }
+    }
+}
+
+void MultiReplace::compile()
+{
+    stages.clear();
+    next.clear();
+    node_rules.clear();
+
+    memset(classes, 0, sizeof(classes));
+    alphabet = 1;
+    vector<Rule>::const_iterator it;
+    for (it = rules.begin(); it != rules.end(); ++it) {
+        const std::string & from = it->from;
+        for (unsigned int i = 0; i < from.size(); ++i) {
+            unsigned char & c = classes[(unsigned char)from[i]];
+            if (c == 0)
+                c = alphabet++;
+        }
+    }
+    for (int c = 'A'; c <= 'Z'; ++c)
+        classes[c] = classes[fold_char(c)];
+
+    int count = int(rules.size());
+    int start = 0;
+    while (start < count) {
+        int end = start + 1;
+        for (; end < count; ++end) {
+            bool independent = true;
+            for (int i = start; i < end; ++i) {
+                if (!interacts(i, end))
+                    continue;
+                independent = false;
+                break;
+            }
+            if (!independent)
+                break;
+        }
+        build_stage(start, end);
+        start = end;
+    }
+}
+
+void MultiReplace::replace_stage(int index, std::string & str)
+{
+    const Stage & stage = stages[index];
+    int root = stage.root;
+    int node = root;
+    int size = int(str.size());
+    int new_size = size;
+    matches.clear();
+
+    // patterns in a stage never overlap, so the first match to end is
+    // also the leftmost one, and matching restarts after it
+    for (int i = 0; i < size; ++i) {
+        int c = classes[(unsigned char)str[i]];
+        node = next[node * alphabet + c];
+        int rule = node_rules[node];
+        if (rule == -1)
+            continue;
+        Match match;
+        match.end = i + 1;
+        match.rule = rule;
+        matches.push_back(match);
+        new_size += int(rules[rule].to.size()) - int(rules[rule].from.size());
+        node = root;
+    }
+
+    if (matches.empty())
+        return;
+
+    std::string ret;
+    ret.reserve(new_size);
+    int pos = 0;
+    vector<Match>::const_iterator it;
+    for (it = matches.begin(); it != matches.end(); ++it) {
+        const Rule & rule = rules[it->rule];
+        int start = it->end - int(rule.from.size());
+        ret.append(str, pos, start - pos);
+        ret.append(rule.to);
+        pos = it->end;
+    }
+    ret.append(str, pos, std::string::npos);
+    str.swap(ret);
+}
+
+void MultiReplace::replace(std::string & str)
+{
+    for (int i = 0; i < int(stages.size()); ++i)
+        replace_stage(i, str);
+}
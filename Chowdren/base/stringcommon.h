@@ -4,13 +4,21 @@
 #include <string>
 #include <sstream>
 #include <ctype.h>
+#include <string.h>
 #include "types.h"
 #include <algorithm>
 #include "dynnum.h"
 #include <boost/algorithm/string/replace.hpp>
 
+// size of the buffers given to the write_* functions, which write the same
+// characters as the fast_* versions and return the number written
+#define NUMBER_STRING_SIZE 32
+
 int fast_atoi(const std::string & value);
 double fast_atof(const char * p, const char * end);
+int write_itoa(int value, char * out);
+int write_lltoa(long long value, char * out);
+int write_dtoa(double value, char * out);
 std::string fast_itoa(int value);
 std::string fast_lltoa(long long value);
 std::string fast_dtoa(double value);
@@ -74,6 +82,90 @@ inline std::string number_to_string(uint64_t value)
     return fast_lltoa(value);
 }
 
+// a fused chain of string concatenations, written by the exporter as
+// StringFuse().add(a).add(b).get() instead of a + b. operands and numbers
+// are appended to a stack buffer, and the result is made in one step, so a
+// chain builds one string instead of a temporary per operand and per +.
+// add has the same overloads as number_to_string.
+
+#define FUSE_BUFFER_SIZE 256
+
+class StringFuse
+{
+public:
+    char data[FUSE_BUFFER_SIZE];
+    int size;
+    bool spilled;
+    std::string large;
+
+    StringFuse()
+    : size(0), spilled(false)
+    {
+    }
+
+    void append(const char * value, int value_size)
+    {
+        if (!spilled) {
+            if (size + value_size <= FUSE_BUFFER_SIZE) {
+                memcpy(data + size, value, value_size);
+                size += value_size;
+                return;
+            }
+            spilled = true;
+            large.assign(data, size);
+        }
+        large.append(value, value_size);
+    }
+
+    StringFuse & add(const std::string & value)
+    {
+        append(value.data(), int(value.size()));
+        return *this;
+    }
+
+    StringFuse & add(double value)
+    {
+        char buffer[NUMBER_STRING_SIZE];
+        append(buffer, write_dtoa(value, buffer));
+        return *this;
+    }
+
+    StringFuse & add(int value)
+    {
+        char buffer[NUMBER_STRING_SIZE];
+        append(buffer, write_itoa(value, buffer));
+        return *this;
+    }
+
+    StringFuse & add(unsigned int value)
+    {
+        char buffer[NUMBER_STRING_SIZE];
+        append(buffer, write_itoa(value, buffer));
+        return *this;
+    }
+
+    StringFuse & add(long long value)
+    {
+        char buffer[NUMBER_STRING_SIZE];
+        append(buffer, write_lltoa(value, buffer));
+        return *this;
+    }
+
+    StringFuse & add(uint64_t value)
+    {
+        char buffer[NUMBER_STRING_SIZE];
+        append(buffer, write_lltoa(value, buffer));
+        return *this;
+    }
+
+    std::string get() const
+    {
+        if (spilled)
+            return large;
+        return std::string(data, size);
+    }
+};
+
 inline void to_lower(std::string & str)
 {
     std::transform(str.begin(), str.end(), str.begin(),
@@ -99,27 +191,139 @@ inline void ireplace_substring(std::string & str,
     boost::algorithm::ireplace_all(str, from, to);
 }
 
+// case-insensitive replacement of many patterns, with the same result as
+// calling ireplace_substring for each rule in order. consecutive rules that
+// can not see each other's matches or output are grouped into one stage,
+// and each stage is a single Aho-Corasick pass over the string.
+class MultiReplace
+{
+public:
+    struct Rule
+    {
+        std::string from, to;
+    };
+
+    struct Match
+    {
+        int end;
+        int rule;
+    };
+
+    struct Stage
+    {
+        int root;
+        int start, end;
+    };
+
+    vector<Rule> rules;
+    vector<Stage> stages;
+    // automaton over the folded pattern characters. every stage has its
+    // own root, and transitions are complete so matching never backtracks
+    unsigned char classes[256];
+    int alphabet;
+    vector<int> next;
+    vector<int> node_rules;
+    vector<Match> matches;
+
+    MultiReplace();
+    void clear();
+    void add(const std::string & from, const std::string & to);
+    void compile();
+    void replace(std::string & str);
+
+private:
+    bool interacts(int a, int b);
+    int add_node();
+    void build_stage(int start, int end);
+    void replace_stage(int stage, std::string & str);
+};
+
+// a split element as an offset into the source string, so splitting does
+// not create a string per element
+
+struct StringSpan
+{
+    int start, size;
+
+    StringSpan()
+    {
+    }
+
+    StringSpan(int start, int size)
+    : start(start), size(size)
+    {
+    }
+
+    std::string get(const std::string & str) const
+    {
+        return std::string(str, start, size);
+    }
+};
+
+// like getline, empty elements are kept except after a trailing delimiter
+
+inline void split_spans(const std::string & str, char delim,
+                        vector<StringSpan> & spans)
+{
+    const char * data = str.data();
+    int size = int(str.size());
+    int start = 0;
+    while (start < size) {
+        const char * found = (const char*)memchr(data + start, delim,
+                                                 size - start);
+        int end = found == NULL ? size : int(found - data);
+        spans.push_back(StringSpan(start, end - start));
+        start = end + 1;
+    }
+}
+
+// any character in delims separates elements, and empty elements are
+// skipped
+
+inline void split_spans(const std::string & str, const std::string & delims,
+                        vector<StringSpan> & spans)
+{
+    bool is_delim[256] = {};
+    for (unsigned int i = 0; i < delims.size(); ++i)
+        is_delim[(unsigned char)delims[i]] = true;
+    const unsigned char * data = (const unsigned char*)str.data();
+    int size = int(str.size());
+    int i = 0;
+    while (true) {
+        while (i < size && is_delim[data[i]])
+            ++i;
+        if (i >= size)
+            break;
+        int start = i;
+        while (i < size && !is_delim[data[i]])
+            ++i;
+        spans.push_back(StringSpan(start, i - start));
+    }
+}
+
 inline void split_string(const std::string & s, char delim,
                          vector<std::string> & elems)
 {
-    std::stringstream ss(s);
-    std::string item;
-    while (std::getline(ss, item, delim)) {
-        elems.push_back(item);
+    std::string::size_type start = 0;
+    std::string::size_type size = s.size();
+    while (start < size) {
+        std::string::size_type end = s.find(delim, start);
+        if (end == std::string::npos)
+            end = size;
+        elems.push_back(std::string(s, start, end - start));
+        start = end + 1;
     }
 }
 
 inline void split_string(const std::string & str, const std::string & delims,
                          vector<std::string> & elems)
 {
-    std::string::size_type last_pos = str.find_first_not_of(delims, 0);
-    std::string::size_type pos = str.find_first_of(delims, last_pos);
-
-    while (std::string::npos != pos || std::string::npos != last_pos) {
-        elems.push_back(str.substr(last_pos, pos - last_pos));
-        last_pos = str.find_first_not_of(delims, pos);
-        pos = str.find_first_of(delims, last_pos);
-    }
+    vector<StringSpan> spans;
+    split_spans(str, delims, spans);
+    elems.reserve(elems.size() + spans.size());
+    vector<StringSpan>::const_iterator it;
+    for (it = spans.begin(); it != spans.end(); ++it)
+        elems.push_back(it->get(str));
 }
 
 inline bool ends_with(const std::string & str, const std::string & suffix)
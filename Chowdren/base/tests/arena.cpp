@@ -0,0 +1,159 @@
+#include "test.h"
+#include "common.h"
+#include <stdio.h>
+
+// startup instances come from the frame arena. their destructors still run
+// and release their alterable strings, whether they are destroyed during the
+// frame or by Frame::reset, and the next setup reuses the arena memory
+
+#define ARENA_ID 1
+#define INSTANCE_COUNT 200
+
+class ArenaObject : public FrameObject
+{
+public:
+    FRAMEOBJECT_HEAD(ArenaObject)
+
+    ArenaObject(int x, int y)
+    : FrameObject(x, y, ARENA_ID)
+    {
+        create_alterables();
+    }
+};
+
+FRAMEOBJECT_IMPL(ArenaObject)
+
+class ArenaFrame : public Frame
+{
+public:
+    void set_index(int value)
+    {
+        index = value;
+        width = height = virtual_width = virtual_height = 1024;
+        background_color = Color(0, 0, 0);
+        loops = NULL;
+        loop_hash = NULL;
+        global_values = NULL;
+        global_strings = NULL;
+        timer_base = 0;
+    }
+};
+
+static std::string get_name(int i)
+{
+    char name[32];
+    sprintf(name, "instance %d", i);
+    return name;
+}
+
+static FrameObject * add_instance(Frame * frame, int i)
+{
+    FrameObject * obj = create_instance<ArenaObject>(ArenaObject::pool,
+                                                     i % 32, i / 32);
+    // one string per instance, and one they all share
+    obj->alterables->strings.set(0, get_name(i));
+    obj->alterables->strings.set(1, "shared");
+    obj->alterables->values.set(0, i);
+    frame->add_object(obj, 0);
+    return obj;
+}
+
+class ArenaData : public FrameData
+{
+public:
+    void init()
+    {
+        frame->layers.resize(1);
+        frame->layers[0].init(0, 1.0, 1.0, true, false, false);
+        for (int i = 0; i < INSTANCE_COUNT; ++i)
+            add_instance(frame, i);
+    }
+};
+
+static bool in_arena(FrameArena & arena, void * ptr)
+{
+    unsigned char * p = (unsigned char*)ptr;
+    for (unsigned int i = 0; i < arena.chunks.size(); ++i) {
+        FrameArena::Chunk & chunk = arena.chunks[i];
+        if (p >= chunk.data && p < chunk.data + chunk.size)
+            return true;
+    }
+    return false;
+}
+
+// every startup instance is in the arena with its alterables, and holds
+// its own values
+static bool check_instances(ArenaFrame & frame)
+{
+    ObjectList & list = frame.instances.items[ARENA_ID];
+    if (list.size() != INSTANCE_COUNT)
+        return false;
+    for (int i = 0; i < INSTANCE_COUNT; ++i) {
+        FrameObject * obj = list[i];
+        if (!(obj->flags & ARENA))
+            return false;
+        if (!in_arena(frame.arena, obj) ||
+            !in_arena(frame.arena, obj->alterables))
+            return false;
+        if (obj->alterables->strings.get(0) != get_name(i) ||
+            obj->alterables->strings.get(1) != "shared" ||
+            obj->alterables->values.get(0) != i)
+            return false;
+    }
+    return true;
+}
+
+int main()
+{
+    ArenaFrame frame;
+    ArenaData data;
+    manager.frame = &frame;
+    frame.data = &data;
+    data.frame = &frame;
+    frame.set_index(0);
+
+    CHECK(get_intern_count() == 0);
+    frame.update();
+    CHECK(FrameArena::current == NULL);
+    CHECK(check_instances(frame));
+    CHECK(get_intern_count() == INSTANCE_COUNT + 1);
+    unsigned int chunk_count = frame.arena.chunks.size();
+    FrameObject * first = frame.instances.items[ARENA_ID][0];
+
+    // destroying startup instances during the frame releases their strings
+    ObjectList & list = frame.instances.items[ARENA_ID];
+    list[0]->destroy();
+    list[5]->destroy();
+    frame.clean_instances();
+    CHECK(list.size() == INSTANCE_COUNT - 2);
+    CHECK(get_intern_count() == INSTANCE_COUNT - 1);
+
+    // instances created by events come from the pool
+    FrameObject * created = add_instance(&frame, INSTANCE_COUNT);
+    CHECK(!(created->flags & ARENA));
+    CHECK(!in_arena(frame.arena, created));
+    CHECK(!in_arena(frame.arena, created->alterables));
+    CHECK(get_intern_count() == INSTANCE_COUNT);
+
+    // reset releases every string, arena or not, and keeps the chunks
+    frame.reset();
+    CHECK(get_intern_count() == 0);
+    CHECK(frame.arena.chunk_index == 0);
+    CHECK(frame.arena.offset == 0);
+    CHECK(frame.arena.chunks.size() == chunk_count);
+
+    // setting up again uses the same memory, for as many times as the
+    // frame is set up
+    for (int i = 0; i < 3; ++i) {
+        frame.set_index(0);
+        frame.update();
+        CHECK(check_instances(frame));
+        CHECK(frame.instances.items[ARENA_ID][0] == first);
+        CHECK(frame.arena.chunks.size() == chunk_count);
+        CHECK(get_intern_count() == INSTANCE_COUNT + 1);
+        frame.reset();
+        CHECK(get_intern_count() == 0);
+    }
+
+    return test_result();
+}
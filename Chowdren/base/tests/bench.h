@@ -0,0 +1,45 @@
+#ifndef CHOWDREN_BENCH_H
+#define CHOWDREN_BENCH_H
+
+#include "test.h"
+#include <chrono>
+
+// timing for the bench_ programs. each one runs the code a change replaced
+// and the code that replaced it on the same input, checks that they agree,
+// and prints the time per run of both. ctest runs them once each so they
+// keep building and agreeing. to time them, configure with
+// -DCMAKE_BUILD_TYPE=Release and pass a run count:
+//
+//     bench_closest 50
+
+static int bench_runs = 1;
+
+// keeps results alive so the timed code is not optimized out
+static volatile unsigned int bench_sink = 0;
+
+inline void bench_init(int argc, char ** argv)
+{
+    if (argc > 1)
+        bench_runs = atoi(argv[1]);
+    if (bench_runs < 1)
+        bench_runs = 1;
+}
+
+// milliseconds per run of func
+inline double bench_time(void (*func)())
+{
+    typedef std::chrono::steady_clock clock;
+    clock::time_point start = clock::now();
+    for (int i = 0; i < bench_runs; i++)
+        func();
+    std::chrono::duration<double, std::milli> time = clock::now() - start;
+    return time.count() / bench_runs;
+}
+
+inline void bench_report(const char * name, double old_time, double new_time)
+{
+    printf("%-32s old %10.4f ms  new %10.4f ms  (%.2fx)\n", name, old_time,
+           new_time, new_time > 0.0 ? old_time / new_time : 0.0);
+}
+
+#endif // CHOWDREN_BENCH_H
@@ -0,0 +1,124 @@
+#include "bench.h"
+#include "common.h"
+
+// setting up and resetting a frame of startup instances with alterables,
+// with the instances in the frame arena, against taking each one from the
+// pool of its type and giving it back one by one as before. nothing is drawn
+
+#define FIRST_ID 1
+#define SECOND_ID 2
+#define INSTANCE_COUNT 10000
+
+template <int ID>
+class StartupObject : public FrameObject
+{
+public:
+    FRAMEOBJECT_HEAD(StartupObject)
+
+    StartupObject(int x, int y)
+    : FrameObject(x, y, ID)
+    {
+        if (ID == FIRST_ID)
+            create_alterables();
+    }
+};
+
+template <int ID>
+ObjectPool<StartupObject<ID> > StartupObject<ID>::pool;
+
+class StartupFrame : public Frame
+{
+public:
+    StartupFrame()
+    {
+        manager.frame = this;
+        set_index(0);
+    }
+
+    void set_index(int value)
+    {
+        index = value;
+        width = height = virtual_width = virtual_height = 4096;
+        loops = NULL;
+        loop_hash = NULL;
+        global_values = NULL;
+        global_strings = NULL;
+    }
+
+    ~StartupFrame()
+    {
+        reset();
+    }
+};
+
+static StartupFrame * frame;
+static unsigned int old_count;
+static unsigned int new_count;
+
+// what a generated init does for a frame of mostly plain instances
+static void init_frame()
+{
+    frame->layers.resize(2);
+    frame->layers[0].init(0, 1.0, 1.0, true, false, false);
+    frame->layers[1].init(1, 1.0, 1.0, true, false, false);
+    for (int i = 0; i < INSTANCE_COUNT; ++i) {
+        int x = (i % 64) * 64;
+        int y = (i / 64) * 64;
+        FrameObject * obj;
+        if (i % 4 == 0) {
+            obj = create_instance<StartupObject<FIRST_ID> >(
+                StartupObject<FIRST_ID>::pool, x, y);
+            obj->alterables->values.set(0, i);
+            obj->alterables->strings.set(0, "start");
+        } else
+            obj = create_instance<StartupObject<SECOND_ID> >(
+                StartupObject<SECOND_ID>::pool, x, y);
+        frame->add_object(obj, i % 2);
+    }
+}
+
+static unsigned int get_count()
+{
+    return frame->instances.items[FIRST_ID].size() +
+           frame->instances.items[SECOND_ID].size();
+}
+
+static void old_setup()
+{
+    FrameArena::current = NULL;
+    init_frame();
+    old_count += get_count();
+    frame->reset();
+}
+
+static void new_setup()
+{
+    FrameArena::current = &frame->arena;
+    init_frame();
+    FrameArena::current = NULL;
+    new_count += get_count();
+    frame->reset();
+}
+
+int main(int argc, char ** argv)
+{
+    bench_init(argc, argv);
+
+    StartupFrame startup_frame;
+    frame = &startup_frame;
+
+    // the first setup, while the pools and the arena are still empty
+    int runs = bench_runs;
+    bench_runs = 1;
+    double old_time = bench_time(old_setup);
+    double new_time = bench_time(new_setup);
+    bench_report("first set up and reset 10000", old_time, new_time);
+
+    bench_runs = runs;
+    old_time = bench_time(old_setup);
+    new_time = bench_time(new_setup);
+    bench_report("set up and reset 10000", old_time, new_time);
+    CHECK(old_count == new_count);
+    CHECK(get_intern_count() == 0);
+    return test_result();
+}
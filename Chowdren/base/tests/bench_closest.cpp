@@ -0,0 +1,73 @@
+#include "bench.h"
+#include "closestframe.h"
+#include "mathcommon.h"
+
+// thousands of seekers looking for the closest of thousands of targets
+// spread over a large frame, with the linear search find_closest used
+// before the broadphase search
+
+#define TARGET_COUNT 4000
+#define SEEKER_COUNT 4000
+#define FRAME_SIZE 16384
+
+static ObjectList * targets;
+static int seeker_x[SEEKER_COUNT];
+static int seeker_y[SEEKER_COUNT];
+static FrameObject * old_results[SEEKER_COUNT];
+static FrameObject * new_results[SEEKER_COUNT];
+static Seeker * seeker;
+
+static FrameObject * old_find_closest(ObjectList & instances, int x, int y)
+{
+    float lowest_dist;
+    FrameObject * closest = NULL;
+    for (ObjectIterator it(instances); !it.end(); ++it) {
+        FrameObject * instance = *it;
+        float dist = get_distance(x, y, instance->x, instance->y);
+        if (closest != NULL && dist > lowest_dist)
+            continue;
+        closest = instance;
+        lowest_dist = dist;
+    }
+    return closest;
+}
+
+static void run_old()
+{
+    for (int i = 0; i < SEEKER_COUNT; i++)
+        old_results[i] = old_find_closest(*targets, seeker_x[i],
+                                          seeker_y[i]);
+}
+
+static void run_new()
+{
+    for (int i = 0; i < SEEKER_COUNT; i++) {
+        seeker->find_closest(*targets, seeker_x[i], seeker_y[i], true);
+        new_results[i] = seeker->closest;
+    }
+}
+
+int main(int argc, char ** argv)
+{
+    bench_init(argc, argv);
+
+    ClosestFrame frame(FRAME_SIZE);
+    seeker = frame.add_seeker();
+    for (int i = 0; i < TARGET_COUNT; i++)
+        frame.add_target(FIRST_ID, test_random(FRAME_SIZE / 4) * 4,
+                         test_random(FRAME_SIZE / 4) * 4);
+    for (int i = 0; i < SEEKER_COUNT; i++) {
+        seeker_x[i] = test_random(FRAME_SIZE);
+        seeker_y[i] = test_random(FRAME_SIZE);
+    }
+    targets = &frame.instances.items[FIRST_ID];
+    targets->clear_selection();
+
+    double old_time = bench_time(run_old);
+    double new_time = bench_time(run_new);
+    bench_report("find_closest 4000x4000", old_time, new_time);
+
+    for (int i = 0; i < SEEKER_COUNT; i++)
+        CHECK(old_results[i] == new_results[i]);
+    return test_result();
+}
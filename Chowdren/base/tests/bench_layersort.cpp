@@ -0,0 +1,169 @@
+#include "bench.h"
+#include "common.h"
+#include "objects/layerext.h"
+#include <algorithm>
+#include <vector>
+
+// LayerObject::sort_layer on a layer of instances sorted by an alterable,
+// against the std::list sort with LayerObject::sort_func and reset_depth
+// that sort_alt_decreasing used before
+
+#define SORT_INDEX 3
+#define ITEM_ID 1
+
+class SortItem : public FrameObject
+{
+public:
+    FRAMEOBJECT_HEAD(SortItem)
+
+    SortItem(int x, int y)
+    : FrameObject(x, y, ITEM_ID)
+    {
+        create_alterables();
+    }
+};
+
+FRAMEOBJECT_IMPL(LayerObject)
+FRAMEOBJECT_IMPL(SortItem)
+
+class SortFrame : public Frame
+{
+public:
+    SortFrame()
+    {
+        manager.frame = this;
+        set_index(0);
+        layers.resize(1);
+        layers[0].init(0, 1.0, 1.0, true, false, false);
+    }
+
+    void set_index(int value)
+    {
+        index = value;
+        width = height = virtual_width = virtual_height = 1024;
+        loops = NULL;
+        loop_hash = NULL;
+        global_values = NULL;
+        global_strings = NULL;
+    }
+
+    ~SortFrame()
+    {
+        reset();
+    }
+};
+
+static Layer * layer;
+static std::vector<FrameObject*> start_order;
+static std::vector<double> values;
+
+// the values go to the instances by layer position, so every run sorts the
+// same sequence whatever order the run before left
+static void set_values()
+{
+    LayerInstances::iterator it;
+    int i = 0;
+    for (it = layer->instances.begin(); it != layer->instances.end(); ++it)
+        it->alterables->values.set(SORT_INDEX, values[i++]);
+}
+
+static void old_sort()
+{
+    set_values();
+    LayerObject::sort_index = SORT_INDEX;
+    LayerObject::sort_reverse = true;
+    LayerObject::def = 0.0;
+    layer->instances.sort(LayerObject::sort_func);
+    layer->reset_depth();
+}
+
+static void new_sort()
+{
+    set_values();
+    LayerObject::sort_layer(layer, SORT_INDEX, 0.0);
+}
+
+static void restore_order()
+{
+    layer->instances.clear();
+    for (unsigned int i = 0; i < start_order.size(); ++i)
+        layer->instances.push_back(*start_order[i]);
+    layer->reset_depth();
+}
+
+static void get_order(std::vector<FrameObject*> & order)
+{
+    order.clear();
+    LayerInstances::iterator it;
+    for (it = layer->instances.begin(); it != layer->instances.end(); ++it)
+        order.push_back(&*it);
+}
+
+static bool is_same(const std::vector<FrameObject*> & a,
+                    const std::vector<FrameObject*> & b)
+{
+    if (a.size() != b.size())
+        return false;
+    for (unsigned int i = 0; i < a.size(); ++i) {
+        if (a[i] != b[i])
+            return false;
+    }
+    return true;
+}
+
+static void run(const char * name)
+{
+    std::vector<FrameObject*> old_order, new_order;
+    restore_order();
+    double old_time = bench_time(old_sort);
+    get_order(old_order);
+    restore_order();
+    double new_time = bench_time(new_sort);
+    get_order(new_order);
+    bench_report(name, old_time, new_time);
+    CHECK(is_same(old_order, new_order));
+}
+
+static double random_value()
+{
+    // few distinct values, so the sorts must also be stable
+    return double(test_random(512)) * 0.25 - 64.0;
+}
+
+static void run_size(SortFrame & frame, int count)
+{
+    while (int(start_order.size()) < count) {
+        FrameObject * obj = create_instance<SortItem>(SortItem::pool, 0, 0);
+        frame.add_object(obj, 0);
+        start_order.push_back(obj);
+    }
+
+    char name[64];
+    values.resize(count);
+    for (int i = 0; i < count; ++i)
+        values[i] = random_value();
+    sprintf(name, "shuffled, %d instances", count);
+    run(name);
+
+    // nearly sorted, as after a frame where a few instances moved
+    std::stable_sort(values.begin(), values.end());
+    for (int i = 0; i < count / 50; ++i)
+        std::swap(values[test_random(count)], values[test_random(count)]);
+    sprintf(name, "nearly sorted, %d instances", count);
+    run(name);
+
+    std::stable_sort(values.begin(), values.end());
+    sprintf(name, "sorted, %d instances", count);
+    run(name);
+}
+
+int main(int argc, char ** argv)
+{
+    bench_init(argc, argv);
+
+    SortFrame frame;
+    layer = &frame.layers[0];
+    run_size(frame, 500);
+    run_size(frame, 5000);
+    return test_result();
+}
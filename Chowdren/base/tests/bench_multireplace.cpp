@@ -0,0 +1,84 @@
+#include "bench.h"
+#include "stringcommon.h"
+#include <string>
+#include <vector>
+
+// a StringReplace with a word list of rules, run over a long text, against
+// one ireplace_substring call per rule as StringReplace did before
+
+#define WORD_COUNT 400
+#define RULE_COUNT 40
+#define TEXT_WORDS 8000
+
+static std::vector<std::string> words;
+static std::vector<std::string> from;
+static std::vector<std::string> to;
+static MultiReplace matcher;
+static std::string text;
+static std::string old_result;
+static std::string new_result;
+
+static std::string get_random_word()
+{
+    std::string value;
+    int size = 3 + test_random(5);
+    for (int i = 0; i < size; ++i)
+        value += char('a' + test_random(26));
+    if (test_random(4) == 0)
+        value[0] = char(value[0] - 'a' + 'A');
+    return value;
+}
+
+static void run_old()
+{
+    old_result = text;
+    for (int i = 0; i < RULE_COUNT; ++i)
+        ireplace_substring(old_result, from[i], to[i]);
+}
+
+static void run_new()
+{
+    new_result = text;
+    matcher.replace(new_result);
+}
+
+// rules for whole words overlap on their spaces, so each one is its own
+// stage. rules for bare words are mostly independent and share stages
+static void run_rules(const char * name, bool spaced)
+{
+    from.clear();
+    to.clear();
+    matcher.clear();
+    for (int i = 0; i < RULE_COUNT; ++i) {
+        if (spaced) {
+            from.push_back(" " + words[i] + " ");
+            to.push_back(" " + get_random_word() + " ");
+        } else {
+            from.push_back(words[i]);
+            to.push_back(get_random_word());
+        }
+        matcher.add(from[i], to[i]);
+    }
+    matcher.compile();
+
+    double old_time = bench_time(run_old);
+    double new_time = bench_time(run_new);
+    bench_report(name, old_time, new_time);
+    CHECK(old_result == new_result);
+}
+
+int main(int argc, char ** argv)
+{
+    bench_init(argc, argv);
+
+    for (int i = 0; i < WORD_COUNT; ++i)
+        words.push_back(get_random_word());
+    for (int i = 0; i < TEXT_WORDS; ++i) {
+        text += words[test_random(WORD_COUNT)];
+        text += ' ';
+    }
+
+    run_rules("replace 40 word rules, 50 KB", true);
+    run_rules("replace 40 bare rules, 50 KB", false);
+    return test_result();
+}
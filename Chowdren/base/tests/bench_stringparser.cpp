@@ -0,0 +1,199 @@
+#include "bench.h"
+#include "objects/stringparser.h"
+#include <string>
+#include <vector>
+
+// StringParser split, get_element and set_element, against the parser
+// before it kept elements as spans into its value
+
+FRAMEOBJECT_IMPL(StringParser)
+
+#define FIELD_COUNT 2000
+#define SET_COUNT 100
+#define LINE_COUNT 1000
+
+class OldParser
+{
+public:
+    vector<std::string> elements;
+    std::string delimiters;
+    std::string value;
+    bool has_split;
+
+    OldParser()
+    : has_split(false)
+    {
+    }
+
+    void split()
+    {
+        if (has_split)
+            return;
+        elements.clear();
+        std::string::size_type last_pos;
+        last_pos = value.find_first_not_of(delimiters, 0);
+        std::string::size_type pos = value.find_first_of(delimiters,
+                                                         last_pos);
+        while (std::string::npos != pos || std::string::npos != last_pos) {
+            elements.push_back(value.substr(last_pos, pos - last_pos));
+            last_pos = value.find_first_not_of(delimiters, pos);
+            pos = value.find_first_of(delimiters, last_pos);
+        }
+        has_split = true;
+    }
+
+    void set(const std::string & v)
+    {
+        value = v;
+        has_split = false;
+    }
+
+    int get_count()
+    {
+        split();
+        return int(elements.size());
+    }
+
+    std::string set_element(const std::string & value, int index)
+    {
+        if (delimiters.size() <= 0)
+            return value;
+        index--;
+        split();
+        std::string ret;
+        for (int i = 0; i < int(elements.size()); i++) {
+            if (i == index)
+                ret += value;
+            else
+                ret += elements[i];
+            if (i < int(elements.size()) - 1)
+                ret += delimiters[0];
+        }
+        return ret;
+    }
+
+    const std::string & get_element(int i)
+    {
+        i--;
+        split();
+        if (i < 0 || i >= int(elements.size()))
+            return empty_string;
+        return elements[i];
+    }
+};
+
+static OldParser * old_parser;
+static StringParser * new_parser;
+static std::string long_line;
+static std::vector<std::string> short_lines;
+static unsigned int old_sum;
+static unsigned int new_sum;
+
+static void old_split()
+{
+    old_parser->set(long_line);
+    old_sum += old_parser->get_count();
+}
+
+static void new_split()
+{
+    new_parser->set(long_line);
+    new_sum += new_parser->get_count();
+}
+
+static void old_get()
+{
+    old_parser->set(long_line);
+    for (int i = 1; i <= FIELD_COUNT; ++i)
+        old_sum += old_parser->get_element(i).size();
+}
+
+static void new_get()
+{
+    new_parser->set(long_line);
+    for (int i = 1; i <= FIELD_COUNT; ++i)
+        new_sum += new_parser->get_element(i).size();
+}
+
+static void old_set()
+{
+    old_parser->set(long_line);
+    for (int i = 1; i <= SET_COUNT; ++i)
+        old_sum += old_parser->set_element("value", i * 17).size();
+}
+
+static void new_set()
+{
+    new_parser->set(long_line);
+    for (int i = 1; i <= SET_COUNT; ++i)
+        new_sum += new_parser->set_element("value", i * 17).size();
+}
+
+// what events parsing a data file line by line do
+static void old_lines()
+{
+    for (int i = 0; i < LINE_COUNT; ++i) {
+        old_parser->set(short_lines[i]);
+        for (int ii = 1; ii <= 4; ++ii)
+            old_sum += old_parser->get_element(ii).size();
+    }
+}
+
+static void new_lines()
+{
+    for (int i = 0; i < LINE_COUNT; ++i) {
+        new_parser->set(short_lines[i]);
+        for (int ii = 1; ii <= 4; ++ii)
+            new_sum += new_parser->get_element(ii).size();
+    }
+}
+
+static void run(const char * name, void (*old_func)(), void (*new_func)())
+{
+    old_sum = new_sum = 0;
+    double old_time = bench_time(old_func);
+    double new_time = bench_time(new_func);
+    bench_report(name, old_time, new_time);
+    CHECK(old_sum == new_sum);
+    bench_sink += new_sum;
+}
+
+static std::string get_random_field()
+{
+    std::string value;
+    int size = test_random(12);
+    for (int i = 0; i < size; ++i)
+        value += char('a' + test_random(26));
+    return value;
+}
+
+int main(int argc, char ** argv)
+{
+    bench_init(argc, argv);
+
+    OldParser old_value;
+    StringParser new_value(0, 0, 0);
+    old_parser = &old_value;
+    new_parser = &new_value;
+    old_parser->delimiters = ",";
+    new_parser->add_delimiter(",");
+
+    // fields are never empty, so both parsers see the same elements
+    for (int i = 0; i < FIELD_COUNT; ++i) {
+        if (i > 0)
+            long_line += ',';
+        long_line += "f" + get_random_field();
+    }
+    for (int i = 0; i < LINE_COUNT; ++i) {
+        std::string line;
+        for (int ii = 0; ii < 6; ++ii)
+            line += get_random_field() + "x,";
+        short_lines.push_back(line);
+    }
+
+    run("split 2000 fields", old_split, new_split);
+    run("get_element x2000", old_get, new_get);
+    run("set_element x100", old_set, new_set);
+    run("1000 lines, 4 get_element", old_lines, new_lines);
+    return test_result();
+}
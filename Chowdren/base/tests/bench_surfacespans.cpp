@@ -0,0 +1,157 @@
+#include "bench.h"
+#include "spanrefs.h"
+#include <string.h>
+#include <vector>
+
+// the canvas span operations over a whole 1024x768 canvas, row by row,
+// against the one pixel at a time references in spanrefs.h. the references
+// are the plain per-pixel loops a canvas without the span paths would run
+
+#define CANVAS_WIDTH 1024
+#define CANVAS_HEIGHT 768
+#define CANVAS_SIZE (CANVAS_WIDTH * CANVAS_HEIGHT)
+
+static std::vector<unsigned int> source;
+static std::vector<unsigned int> start;
+static std::vector<unsigned int> old_canvas;
+static std::vector<unsigned int> new_canvas;
+
+static const float blur[9] = {1, 2, 1, 2, 4, 2, 1, 2, 1};
+
+static void old_fill()
+{
+    unsigned int * dst = &old_canvas[0];
+    for (int i = 0; i < CANVAS_SIZE; ++i)
+        dst[i] = 0x80402010;
+}
+
+static void new_fill()
+{
+    unsigned int * dst = &new_canvas[0];
+    for (int y = 0; y < CANVAS_HEIGHT; ++y)
+        fill_span(dst + y * CANVAS_WIDTH, 0x80402010, CANVAS_WIDTH);
+}
+
+static void old_blend()
+{
+    unsigned int * dst = &old_canvas[0];
+    const unsigned int * src = &source[0];
+    for (int i = 0; i < CANVAS_SIZE; ++i)
+        dst[i] = ref_blend(dst[i], src[i]);
+}
+
+static void new_blend()
+{
+    unsigned int * dst = &new_canvas[0];
+    const unsigned int * src = &source[0];
+    for (int y = 0; y < CANVAS_HEIGHT; ++y)
+        blend_span(dst + y * CANVAS_WIDTH, src + y * CANVAS_WIDTH,
+                   CANVAS_WIDTH);
+}
+
+static void old_subtract()
+{
+    unsigned int * dst = &old_canvas[0];
+    const unsigned int * src = &source[0];
+    for (int i = 0; i < CANVAS_SIZE; ++i)
+        dst[i] = ref_subtract(dst[i], src[i]);
+}
+
+static void new_subtract()
+{
+    unsigned int * dst = &new_canvas[0];
+    const unsigned int * src = &source[0];
+    for (int y = 0; y < CANVAS_HEIGHT; ++y)
+        subtract_span(dst + y * CANVAS_WIDTH, src + y * CANVAS_WIDTH,
+                      CANVAS_WIDTH);
+}
+
+static void old_key()
+{
+    unsigned int * dst = &old_canvas[0];
+    for (int i = 0; i < CANVAS_SIZE; ++i) {
+        if ((dst[i] & 0x00FFFFFF) == 0x00000000)
+            ((unsigned char*)&dst[i])[3] = 0;
+    }
+}
+
+static void new_key()
+{
+    unsigned int * dst = &new_canvas[0];
+    for (int y = 0; y < CANVAS_HEIGHT; ++y)
+        key_span(dst + y * CANVAS_WIDTH, CANVAS_WIDTH, Color(0, 0, 0));
+}
+
+static void convolve(std::vector<unsigned int> & canvas, bool spans)
+{
+    const unsigned int * src = &source[0];
+    unsigned int * dst = &canvas[0];
+    for (int y = 0; y < CANVAS_HEIGHT; ++y) {
+        const unsigned int * rows[3] = {
+            src + std::max(y - 1, 0) * CANVAS_WIDTH,
+            src + y * CANVAS_WIDTH,
+            src + std::min(y + 1, CANVAS_HEIGHT - 1) * CANVAS_WIDTH
+        };
+        if (spans)
+            convolve_span(dst + y * CANVAS_WIDTH, rows, CANVAS_WIDTH, blur,
+                          1.0f / 16.0f, 0.0f);
+        else
+            ref_convolve(dst + y * CANVAS_WIDTH, rows, CANVAS_WIDTH, blur,
+                         1.0f / 16.0f, 0.0f);
+    }
+}
+
+static void old_convolve()
+{
+    convolve(old_canvas, false);
+}
+
+static void new_convolve()
+{
+    convolve(new_canvas, true);
+}
+
+// each operation starts from the same canvas. with more than one run, the
+// blends keep going over their own output, which they do the same way
+static void run(const char * name, void (*old_func)(), void (*new_func)())
+{
+    old_canvas = start;
+    new_canvas = start;
+    double old_time = bench_time(old_func);
+    double new_time = bench_time(new_func);
+    bench_report(name, old_time, new_time);
+    CHECK(memcmp(&old_canvas[0], &new_canvas[0],
+                 CANVAS_SIZE * sizeof(unsigned int)) == 0);
+}
+
+static unsigned int random_pixel()
+{
+    unsigned int v = test_random() | (test_random() << 15);
+    v ^= test_random() << 30;
+    switch (test_random(4)) {
+        case 0:
+            return v & 0xFF000000;
+        case 1:
+            return v | 0xFF000000;
+    }
+    return v;
+}
+
+int main(int argc, char ** argv)
+{
+    bench_init(argc, argv);
+
+    source.resize(CANVAS_SIZE);
+    start.resize(CANVAS_SIZE);
+    for (int i = 0; i < CANVAS_SIZE; ++i) {
+        source[i] = random_pixel();
+        start[i] = random_pixel();
+    }
+
+    run("fill 1024x768", old_fill, new_fill);
+    run("blend 1024x768", old_blend, new_blend);
+    run("subtract 1024x768", old_subtract, new_subtract);
+    run("key 1024x768", old_key, new_key);
+    run("convolve 1024x768", old_convolve, new_convolve);
+    return test_result();
+}
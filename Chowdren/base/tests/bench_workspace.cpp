@@ -0,0 +1,180 @@
+#include "bench.h"
+#include "objects/workspace.h"
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// loading a workspace file into a WorkspaceSet, against the BinaryArray
+// before it, which copied every workspace into its own stringstream. both
+// parse the file from memory, so file reads are not timed. the new load
+// copies the file once, as read_file does, and owns that copy
+
+#define WORKSPACE_COUNT 400
+#define MAX_WORKSPACE_SIZE 32768
+
+// live heap bytes, for the memory each load keeps
+
+static size_t live_bytes = 0;
+
+void * operator new(size_t size)
+{
+    size_t * block = (size_t*)malloc(size + sizeof(size_t) * 2);
+    if (block == NULL)
+        abort();
+    block[0] = size;
+    live_bytes += size;
+    return block + 2;
+}
+
+void operator delete(void * ptr) throw()
+{
+    if (ptr == NULL)
+        return;
+    size_t * block = (size_t*)ptr - 2;
+    live_bytes -= block[0];
+    free(block);
+}
+
+void * operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete[](void * ptr) throw()
+{
+    operator delete(ptr);
+}
+
+class OldWorkspace
+{
+public:
+    std::string name;
+    std::stringstream data;
+
+    OldWorkspace(const std::string & name)
+    : name(name)
+    {
+    }
+};
+
+typedef hash_map<std::string, OldWorkspace*> OldWorkspaceMap;
+
+static std::string file;
+static std::vector<std::string> names;
+
+static void old_load(OldWorkspaceMap & workspaces)
+{
+    size_t pos = 0;
+    size_t size = file.size();
+    while (pos < size) {
+        size_t name_end = file.find('\0', pos);
+        OldWorkspace * workspace = new OldWorkspace(
+            file.substr(pos, name_end - pos));
+        pos = name_end + 1;
+        const unsigned char * p = (const unsigned char*)&file[pos];
+        size_t data_size = p[0] | (p[1] << 8) | (p[2] << 16) | (p[3] << 24);
+        pos += 4;
+        workspace->data.write(&file[pos], data_size);
+        pos += data_size;
+        workspaces[workspace->name] = workspace;
+    }
+}
+
+static void old_free(OldWorkspaceMap & workspaces)
+{
+    OldWorkspaceMap::const_iterator it;
+    for (it = workspaces.begin(); it != workspaces.end(); ++it)
+        delete it->second;
+    workspaces.clear();
+}
+
+static void new_load(WorkspaceSet & set)
+{
+    char * data = new char[file.size()];
+    memcpy(data, file.data(), file.size());
+    set.load(data, file.size());
+}
+
+static void old_run()
+{
+    OldWorkspaceMap workspaces;
+    old_load(workspaces);
+    bench_sink += workspaces.size();
+    old_free(workspaces);
+}
+
+static void new_run()
+{
+    WorkspaceSet set;
+    new_load(set);
+    bench_sink += set.map.size();
+}
+
+static std::string get_old_contents(OldWorkspaceMap & workspaces,
+                                    const std::string & name)
+{
+    OldWorkspaceMap::const_iterator it = workspaces.find(name);
+    if (it == workspaces.end())
+        return "<missing>";
+    return it->second->data.str();
+}
+
+static std::string get_new_contents(WorkspaceSet & set,
+                                    const std::string & name)
+{
+    Workspace * workspace = set.find(hash_workspace_name(name), name);
+    if (workspace == NULL)
+        return "<missing>";
+    return std::string(workspace->get_data(), workspace->get_size());
+}
+
+int main(int argc, char ** argv)
+{
+    bench_init(argc, argv);
+
+    for (int i = 0; i < WORKSPACE_COUNT; ++i) {
+        char name[32];
+        sprintf(name, "workspace%d", i);
+        names.push_back(name);
+        file += name;
+        file += '\0';
+        unsigned int size = test_random(MAX_WORKSPACE_SIZE);
+        for (int ii = 0; ii < 4; ++ii)
+            file += char(size >> (ii * 8));
+        for (unsigned int ii = 0; ii < size; ++ii)
+            file += char(test_random(256));
+    }
+
+    double old_time = bench_time(old_run);
+    double new_time = bench_time(new_run);
+    char name[64];
+    sprintf(name, "load and free %d KB", int(file.size() / 1024));
+    bench_report(name, old_time, new_time);
+
+    // what a loaded file keeps on the heap
+    size_t start = live_bytes;
+    OldWorkspaceMap workspaces;
+    old_load(workspaces);
+    size_t old_bytes = live_bytes - start;
+    start = live_bytes;
+    WorkspaceSet * set = new WorkspaceSet;
+    new_load(*set);
+    size_t new_bytes = live_bytes - start;
+    printf("%-32s old %10d KB  new %10d KB\n", "memory after load",
+           int(old_bytes / 1024), int(new_bytes / 1024));
+
+    bool same = true;
+    for (unsigned int i = 0; i < names.size(); ++i) {
+        if (get_old_contents(workspaces, names[i]) !=
+            get_new_contents(*set, names[i]))
+            same = false;
+    }
+    CHECK(same);
+
+    old_free(workspaces);
+    delete set;
+    return test_result();
+}
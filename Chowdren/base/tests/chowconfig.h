@@ -0,0 +1,12 @@
+#ifndef CHOWDREN_CONFIG_H
+#define CHOWDREN_CONFIG_H
+
+// stand-in for the chowconfig.h written by the exporter
+
+#define WINDOW_WIDTH 640
+#define WINDOW_HEIGHT 480
+#define FRAMERATE 60
+#define MAX_OBJECT_ID 64
+#define MAX_BACK_ID 16
+
+#endif // CHOWDREN_CONFIG_H
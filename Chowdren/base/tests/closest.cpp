@@ -0,0 +1,167 @@
+#include "test.h"
+#include "closestframe.h"
+#include "mathcommon.h"
+#include <algorithm>
+
+// find_closest must keep the same instances as sorting every selected
+// instance by distance, whether it searches the broadphase or the lists.
+// the instances sit on a coarse lattice, so most distances are tied
+
+struct Candidate
+{
+    FrameObject * obj;
+    float dist;
+    int list;
+
+    // ties go to the later list, then to the lower index, which is the
+    // instance the iterators visit last
+    bool operator<(const Candidate & other) const
+    {
+        if (dist != other.dist)
+            return dist < other.dist;
+        if (list != other.list)
+            return list > other.list;
+        return obj->index < other.obj->index;
+    }
+};
+
+static void get_expected(ObjectList ** lists, int list_count, int x, int y,
+                         int count, std::vector<FrameObject*> & out)
+{
+    std::vector<Candidate> candidates;
+    for (int i = 0; i < list_count; i++) {
+        for (ObjectIterator it(*lists[i]); !it.end(); ++it) {
+            Candidate candidate = {*it, get_distance(x, y, (*it)->x,
+                                                     (*it)->y), i};
+            candidates.push_back(candidate);
+        }
+    }
+    std::sort(candidates.begin(), candidates.end());
+    out.clear();
+    for (int i = 0; i < int(candidates.size()) && i < count; i++)
+        out.push_back(candidates[i].obj);
+}
+
+static bool is_expected(Seeker * seeker, std::vector<FrameObject*> & expected)
+{
+    if (seeker->closest_list.size() != expected.size())
+        return false;
+    for (unsigned int i = 0; i < expected.size(); i++) {
+        if (seeker->closest_list[i] != expected[i])
+            return false;
+    }
+    if (expected.empty())
+        return seeker->closest == NULL;
+    if (seeker->closest != expected[0])
+        return false;
+    // indices past the kept instances give the closest one
+    for (int n = 0; n < int(expected.size()) + 3; n++) {
+        FrameObject * obj = seeker->get_closest(n).object;
+        if (obj != expected[n < int(expected.size()) ? n : 0])
+            return false;
+    }
+    return true;
+}
+
+static const int counts[] = {1, 2, 5, 300};
+
+static void check_queries(Seeker * seeker, ObjectList & list)
+{
+    ObjectList * lists[1] = {&list};
+    std::vector<FrameObject*> expected;
+    for (int i = 0; i < 40; i++) {
+        int x = test_random(1100) - 50;
+        int y = test_random(1100) - 50;
+        if (i % 2 == 0) {
+            // on the lattice, where ties are most likely
+            x -= x % 50;
+            y -= y % 50;
+        }
+        for (int j = 0; j < int(sizeof(counts) / sizeof(int)); j++) {
+            int count = counts[j];
+            get_expected(lists, 1, x, y, count, expected);
+            seeker->find_closest(list, x, y, true, count);
+            CHECK(is_expected(seeker, expected));
+            seeker->find_closest(list, x, y, false, count);
+            CHECK(is_expected(seeker, expected));
+        }
+    }
+}
+
+static void check_qualifier_queries(Seeker * seeker, QualifierList & list)
+{
+    std::vector<FrameObject*> expected;
+    for (int i = 0; i < 40; i++) {
+        int x = test_random(1100) - 50;
+        int y = test_random(1100) - 50;
+        if (i % 2 == 0) {
+            x -= x % 50;
+            y -= y % 50;
+        }
+        for (int j = 0; j < int(sizeof(counts) / sizeof(int)); j++) {
+            int count = counts[j];
+            get_expected(list.items, list.count, x, y, count, expected);
+            seeker->find_closest(list, x, y, true, count);
+            CHECK(is_expected(seeker, expected));
+            seeker->find_closest(list, x, y, false, count);
+            CHECK(is_expected(seeker, expected));
+        }
+    }
+}
+
+int main()
+{
+    ClosestFrame frame(2048);
+    Seeker * seeker = frame.add_seeker();
+
+    // two instances on some lattice points, and some outside the frame
+    for (int i = 0; i < 120; i++) {
+        int id = i % 3 == 0 ? SECOND_ID : FIRST_ID;
+        int x = test_random(21) * 50;
+        int y = test_random(21) * 50;
+        frame.add_target(id, x, y);
+        if (i % 10 == 0)
+            frame.add_target(id, x, y);
+    }
+    frame.add_target(FIRST_ID, -300, 500);
+    frame.add_target(SECOND_ID, 2500, 2500);
+
+    ObjectList & first = frame.instances.items[FIRST_ID];
+    ObjectList & second = frame.instances.items[SECOND_ID];
+    first.clear_selection();
+    second.clear_selection();
+    check_queries(seeker, first);
+
+    ObjectList * qualifier_lists[3] = {&first, &second, NULL};
+    QualifierList qualifier;
+    qualifier.set(2, qualifier_lists);
+    check_qualifier_queries(seeker, qualifier);
+
+    // instances added after the selection was cleared are not selected,
+    // while the rest still are
+    for (int i = 0; i < 10; i++)
+        frame.add_target(FIRST_ID, i * 100, 500);
+    CHECK(first.all_selected);
+    check_queries(seeker, first);
+    check_qualifier_queries(seeker, qualifier);
+
+    // with only part of the instances selected, the selection is kept
+    for (ObjectIterator it(first); !it.end(); ++it) {
+        if ((*it)->index % 3 == 0)
+            it.deselect();
+    }
+    check_queries(seeker, first);
+    check_qualifier_queries(seeker, qualifier);
+
+    // fewer instances than asked for, and none at all
+    first.clear_selection();
+    for (ObjectIterator it(first); !it.end(); ++it) {
+        if ((*it)->index > 4)
+            it.deselect();
+    }
+    check_queries(seeker, first);
+    first.empty_selection();
+    check_queries(seeker, first);
+
+    return test_result();
+}
@@ -0,0 +1,101 @@
+#ifndef CHOWDREN_CLOSESTFRAME_H
+#define CHOWDREN_CLOSESTFRAME_H
+
+#include "common.h"
+#include "collision.h"
+#include "objects/advdir.h"
+
+// a frame with instances of two object types for AdvancedDirection to
+// search. the instances have 8x8 boxes with their position at the top left
+// corner, like the Active objects the exporter enables the grid search for
+
+#define FIRST_ID 1
+#define SECOND_ID 2
+#define SEEKER_ID 3
+
+template <int ID>
+class Target : public FrameObject
+{
+public:
+    FRAMEOBJECT_HEAD(Target)
+
+    Target(int x, int y)
+    : FrameObject(x, y, ID)
+    {
+        width = height = 8;
+        collision = new InstanceBox(this);
+    }
+
+    ~Target()
+    {
+        delete collision;
+    }
+};
+
+template <int ID>
+ObjectPool<Target<ID> > Target<ID>::pool;
+
+class Seeker : public AdvancedDirection
+{
+public:
+    FRAMEOBJECT_HEAD(Seeker)
+
+    Seeker(int x, int y)
+    : AdvancedDirection(x, y, SEEKER_ID)
+    {
+    }
+};
+
+FRAMEOBJECT_IMPL(AdvancedDirection)
+FRAMEOBJECT_IMPL(Seeker)
+
+class ClosestFrame : public Frame
+{
+public:
+    int size;
+
+    ClosestFrame(int size)
+    : size(size)
+    {
+        manager.frame = this;
+        set_index(0);
+        layers.resize(1);
+        layers[0].init(0, 1.0, 1.0, true, false, false);
+    }
+
+    void set_index(int value)
+    {
+        index = value;
+        width = height = virtual_width = virtual_height = size;
+        loops = NULL;
+        loop_hash = NULL;
+        global_values = NULL;
+        global_strings = NULL;
+    }
+
+    ~ClosestFrame()
+    {
+        reset();
+    }
+
+    FrameObject * add_target(int id, int x, int y)
+    {
+        FrameObject * obj;
+        if (id == FIRST_ID)
+            obj = create_instance<Target<FIRST_ID> >(
+                Target<FIRST_ID>::pool, x, y);
+        else
+            obj = create_instance<Target<SECOND_ID> >(
+                Target<SECOND_ID>::pool, x, y);
+        return add_object(obj, 0);
+    }
+
+    Seeker * add_seeker()
+    {
+        FrameObject * obj = create_instance<Seeker>(Seeker::pool, 0, 0);
+        add_object(obj, 0);
+        return (Seeker*)obj;
+    }
+};
+
+#endif // CHOWDREN_CLOSESTFRAME_H
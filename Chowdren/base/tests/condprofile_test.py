@@ -0,0 +1,244 @@
+"""
+Checks the exporter's condition reordering (chowdren/condprofile.py) against
+the original condition order, on stand-ins for the converter and the event
+data. Run with Python 2.
+"""
+
+import sys
+import os
+import imp
+import random
+import itertools
+import tempfile
+
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', '..'))
+
+# mmfparser's object info loader is a compiled module, and only the constant
+# is needed
+EXTENSION_BASE = 32
+objectinfo = imp.new_module('mmfparser.data.chunkloaders.objectinfo')
+objectinfo.EXTENSION_BASE = EXTENSION_BASE
+for name in ('mmfparser', 'mmfparser.data', 'mmfparser.data.chunkloaders'):
+    sys.modules.setdefault(name, imp.new_module(name))
+sys.modules['mmfparser.data.chunkloaders.objectinfo'] = objectinfo
+
+from chowdren.condprofile import ConditionProfile, get_condition_key
+
+failures = []
+
+def check(value, message):
+    if not value:
+        failures.append(message)
+
+class Item(object):
+    def __init__(self, name, object_info=None, extension=False):
+        self.name = name
+        self.objectInfo = object_info
+        self.extension = extension
+
+    def getType(self):
+        if self.extension:
+            return EXTENSION_BASE
+        return -1
+
+    def getExtensionNum(self):
+        return 0
+
+    def getName(self):
+        return self.name
+
+    def hasObjectInfo(self):
+        return self.objectInfo is not None
+
+class Loader(object):
+    isExpression = True
+
+    def __init__(self, items):
+        self.items = items + [Item('End')]
+
+class Parameter(object):
+    def __init__(self, items):
+        self.loader = Loader(items)
+
+class Condition(object):
+    def __init__(self, name, object_info=1, negated=False, parameters=(),
+                 custom=False):
+        self.data = Item(name)
+        self.object_info = object_info
+        self.negated = negated
+        self.parameters = list(parameters)
+        self.custom = custom
+
+    def use_select(self):
+        return True
+
+    def get_object(self):
+        return (self.object_info, None)
+
+    def is_negated(self):
+        return self.negated
+
+class Group(object):
+    def __init__(self, global_id):
+        self.global_id = global_id
+        self.or_index = 0
+        self.or_type = None
+
+class Converter(object):
+    current_frame_index = 0
+
+    def get_condition_name(self, data):
+        return data.name
+
+def make_profile(stats):
+    profile = ConditionProfile.__new__(ConditionProfile)
+    profile.converter = Converter()
+    profile.stats = stats
+    profile.total_before = profile.total_after = 0.0
+    return profile
+
+def add_stats(stats, group, index, cost, rate, evals=1000):
+    key = get_condition_key(Converter(), group, index)
+    stats[key] = (evals, int(round(rate * evals)), cost * evals)
+
+def get_estimates(profile, group, conditions):
+    estimates = {}
+    for index, condition in enumerate(conditions):
+        key = get_condition_key(profile.converter, group, index)
+        estimates[condition] = profile.get_estimate(condition, key)
+    return estimates
+
+def check_random_runs():
+    rng = random.Random(1)
+    for count in xrange(2, 7):
+        for _ in xrange(40):
+            group = Group(count)
+            stats = {}
+            conditions = []
+            for index in xrange(count):
+                conditions.append(Condition('CompareAlterableValue',
+                                            negated=rng.random() < 0.3))
+                add_stats(stats, group, index, rng.uniform(1e-7, 1e-5),
+                          rng.choice([0.0, 1.0, rng.random()]))
+            profile = make_profile(stats)
+            estimates = get_estimates(profile, group, conditions)
+            new = profile.reorder(group, conditions, 0)
+
+            check(sorted(new) == sorted(conditions),
+                  'reordering must keep the same conditions')
+            old_cost = profile.get_chain_cost(conditions, estimates)
+            new_cost = profile.get_chain_cost(new, estimates)
+            best = min(profile.get_chain_cost(order, estimates)
+                       for order in itertools.permutations(conditions))
+            check(new_cost <= old_cost + 1e-15,
+                  'reordering made a chain more expensive')
+            check(abs(new_cost - best) <= 1e-12 * max(best, 1e-9),
+                  'reordering is not optimal: %r > %r' % (new_cost, best))
+            check(profile.total_after <= profile.total_before,
+                  'totals must not get worse')
+
+def check_pinned():
+    # a custom condition and a condition on another object split the runs
+    group = Group(100)
+    other = Parameter([Item('XPosition', object_info=2)])
+    conditions = [
+        Condition('CompareAlterableValue'),
+        Condition('CompareAlterableValue'),
+        Condition('CompareX', parameters=[other]),
+        Condition('CompareAlterableValue'),
+        Condition('OnLoop', custom=True),
+        Condition('CompareAlterableValue'),
+        Condition('CompareAlterableValue')
+    ]
+    stats = {}
+    for index in xrange(len(conditions)):
+        # the later conditions are cheaper and fail more often
+        add_stats(stats, group, index, 1e-5 / (index + 1), 0.9 - index * 0.1)
+    profile = make_profile(stats)
+    new = profile.reorder(group, conditions, 0)
+    check(new[2] is conditions[2], 'a condition on another object moved')
+    check(new[3] is conditions[3], 'a run of one condition moved')
+    check(new[4] is conditions[4], 'a custom condition moved')
+    check(new[:2] == [conditions[1], conditions[0]], 'first run not sorted')
+    check(new[5:] == [conditions[6], conditions[5]], 'last run not sorted')
+
+    # impure expressions and extension items are never moved
+    random_parameter = Parameter([Item('Random')])
+    extension_parameter = Parameter([Item('Value', extension=True)])
+    check(not profile.is_movable(Condition('CompareAlterableValue',
+                                           parameters=[random_parameter])),
+          'a condition using Random is movable')
+    check(not profile.is_movable(Condition('CompareAlterableValue',
+                                           parameters=[extension_parameter])),
+          'a condition using an extension expression is movable')
+    check(not profile.is_movable(Condition('OnCollision')),
+          'a condition outside the pure set is movable')
+
+def check_unchanged():
+    group = Group(200)
+    conditions = [Condition('CompareAlterableValue'),
+                  Condition('CompareAlterableValue')]
+    stats = {}
+    add_stats(stats, group, 0, 1e-5, 0.9)
+    add_stats(stats, group, 1, 1e-7, 0.1)
+    profile = make_profile(stats)
+
+    group.or_type = 'or'
+    check(profile.reorder(group, conditions, 0) is conditions,
+          'an OR group was reordered')
+    group.or_type = None
+
+    # the profile indexes are offset by the conditions before the run
+    check(profile.reorder(group, conditions, 5) == conditions,
+          'conditions without profile data were reordered')
+
+    check(profile.reorder(group, conditions, 0) ==
+          [conditions[1], conditions[0]], 'a profiled run was not sorted')
+
+    # a negated condition passes when the profiled check fails
+    negated = Condition('CompareAlterableValue', negated=True)
+    cost, rate = profile.get_estimate(negated,
+                                      get_condition_key(Converter(), group, 0))
+    check(abs(rate - 0.1) < 1e-9, 'negated pass rate not inverted')
+
+def check_load():
+    fp = tempfile.NamedTemporaryFile(delete=False)
+    try:
+        fp.write('0 3 0 1 100 25 0.001000000\n')
+        fp.write('broken line\n')
+        fp.write('0 3 0 2 0 0 0.000000000\n')
+        fp.close()
+        profile = ConditionProfile(Converter(), fp.name)
+    finally:
+        os.remove(fp.name)
+    check(profile.stats == {'0 3 0 1': (100, 25, 0.001),
+                            '0 3 0 2': (0, 0, 0.0)},
+          'profile not parsed: %r' % profile.stats)
+    group = Group(3)
+    condition = Condition('CompareAlterableValue')
+    estimate = profile.get_estimate(condition, '0 3 0 1')
+    check(estimate is not None and abs(estimate[0] - 1e-5) < 1e-12 and
+          abs(estimate[1] - 0.25) < 1e-9, 'bad estimate: %r' % (estimate,))
+    check(profile.get_estimate(condition, '0 3 0 2') is None,
+          'a condition that never ran has an estimate')
+
+def main():
+    # reorder reports what it does on stdout
+    stdout = sys.stdout
+    sys.stdout = open(os.devnull, 'w')
+    try:
+        check_random_runs()
+        check_pinned()
+        check_unchanged()
+        check_load()
+    finally:
+        sys.stdout.close()
+        sys.stdout = stdout
+    for message in failures:
+        print >> sys.stderr, 'check failed: %s' % message
+    if failures:
+        print >> sys.stderr, '%s checks failed' % len(failures)
+        sys.exit(1)
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,100 @@
+#include "test.h"
+#include "common.h"
+
+// an event group that only compares globals, written the way the converter
+// writes it when get_event_stamps finds its inputs. the group is skipped
+// while its conditions failed and none of its inputs changed since
+
+enum GroupResult
+{
+    GROUP_SKIPPED,
+    GROUP_FAILED,
+    GROUP_RAN
+};
+
+#define VALUE_INDEX 2
+#define STRING_INDEX 1
+#define OTHER_INDEX 5
+
+// Global Value C = 3 + Global Value D, and Global String B = "go"
+static GroupResult run_group(GlobalValues * global_values,
+                             GlobalStrings * global_strings)
+{
+    static EventStamp event_stamp;
+    event_check_count++;
+    if (event_stamp.is_valid(global_values, global_strings) &&
+        global_values->get_stamp(3) <= event_stamp.stamp &&
+        global_values->get_stamp(VALUE_INDEX) <= event_stamp.stamp &&
+        global_strings->get_stamp(STRING_INDEX) <= event_stamp.stamp) {
+        event_skip_count++;
+        return GROUP_SKIPPED;
+    }
+    event_stamp.start(global_values, global_strings);
+    if (!(global_values->get(VALUE_INDEX) == 3 + global_values->get(3)))
+        return GROUP_FAILED;
+    if (!(global_strings->get(STRING_INDEX) == "go"))
+        return GROUP_FAILED;
+    event_stamp.invalidate();
+    return GROUP_RAN;
+}
+
+int main()
+{
+    GlobalValues * values = new GlobalValues;
+    GlobalStrings * strings = new GlobalStrings;
+    reset_event_stamps();
+
+    // fails, then is skipped while nothing changes
+    CHECK(run_group(values, strings) == GROUP_FAILED);
+    CHECK(run_group(values, strings) == GROUP_SKIPPED);
+    CHECK(run_group(values, strings) == GROUP_SKIPPED);
+
+    // globals the group does not read keep it skipped
+    values->set(OTHER_INDEX, 1);
+    strings->set(OTHER_INDEX, "other");
+    CHECK(run_group(values, strings) == GROUP_SKIPPED);
+
+    // a global value change runs it again, even to a value that still fails
+    values->set(VALUE_INDEX, 1);
+    CHECK(run_group(values, strings) == GROUP_FAILED);
+    CHECK(run_group(values, strings) == GROUP_SKIPPED);
+    values->set(VALUE_INDEX, 3);
+    CHECK(run_group(values, strings) == GROUP_FAILED);
+    CHECK(run_group(values, strings) == GROUP_SKIPPED);
+
+    // a value read in an expression counts as well
+    values->add(3, 0);
+    CHECK(run_group(values, strings) == GROUP_FAILED);
+    CHECK(run_group(values, strings) == GROUP_SKIPPED);
+
+    // a global string change runs it again, and now it passes. a group
+    // whose conditions passed is never skipped
+    strings->set(STRING_INDEX, "go");
+    CHECK(run_group(values, strings) == GROUP_RAN);
+    CHECK(run_group(values, strings) == GROUP_RAN);
+
+    strings->set(STRING_INDEX, "stop");
+    CHECK(run_group(values, strings) == GROUP_FAILED);
+    CHECK(run_group(values, strings) == GROUP_SKIPPED);
+
+    // setting or restarting a frame runs it again, as GameManager::set_frame
+    // does before it sets up the frame
+    reset_event_stamps();
+    CHECK(run_group(values, strings) == GROUP_FAILED);
+    CHECK(run_group(values, strings) == GROUP_SKIPPED);
+
+    // restarting the application replaces the globals
+    delete values;
+    delete strings;
+    values = new GlobalValues;
+    strings = new GlobalStrings;
+    CHECK(run_group(values, strings) == GROUP_FAILED);
+    CHECK(run_group(values, strings) == GROUP_SKIPPED);
+
+    CHECK(event_check_count == 18);
+    CHECK(event_skip_count == 9);
+
+    delete values;
+    delete strings;
+    return test_result();
+}
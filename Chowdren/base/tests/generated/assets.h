@@ -0,0 +1,7 @@
+// stand-in for the assets.h written by the exporter
+
+#define IMAGE_COUNT 1
+#define SOUND_COUNT 1
+#define FONT_COUNT 1
+#define SHADER_COUNT 1
+#define FILE_COUNT 1
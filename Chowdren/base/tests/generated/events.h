@@ -0,0 +1,3 @@
+// stand-in for the events.h written by the exporter
+
+#include "frame.h"
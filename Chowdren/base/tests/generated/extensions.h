@@ -0,0 +1 @@
+// stand-in for the extensions.h written by the exporter
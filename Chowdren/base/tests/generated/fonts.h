@@ -0,0 +1 @@
+// stand-in for the fonts.h written by the exporter
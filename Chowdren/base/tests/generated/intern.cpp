@@ -0,0 +1 @@
+// stand-in for the intern.cpp written by the exporter
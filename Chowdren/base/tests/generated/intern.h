@@ -0,0 +1 @@
+// stand-in for the intern.h written by the exporter
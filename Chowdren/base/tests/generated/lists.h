@@ -0,0 +1 @@
+// stand-in for the lists.h written by the exporter
@@ -0,0 +1 @@
+// stand-in for the objects.h written by the exporter
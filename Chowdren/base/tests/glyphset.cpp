@@ -0,0 +1,278 @@
+#include "test.h"
+#include "glyphset.h"
+#include "assetfile.h"
+#include "blockcodec.h"
+#include "shadercommon.h"
+#include <map>
+#include <vector>
+
+// glyph sets are made from images that are already decoded, so asset
+// loading is never reached. the GL calls keep the uploaded textures, so the
+// packed pixels can be compared with the images they came from
+
+typedef std::map<GLuint, std::vector<unsigned int> > TextureMap;
+static TextureMap textures;
+static std::map<GLuint, int> texture_widths;
+static GLuint bound_texture = 0;
+static GLuint last_texture = 0;
+
+extern "C" {
+
+void glGenTextures(GLsizei n, GLuint * out)
+{
+    for (int i = 0; i < n; ++i)
+        out[i] = ++last_texture;
+}
+
+void glBindTexture(GLenum target, GLuint texture)
+{
+    bound_texture = texture;
+}
+
+void glTexImage2D(GLenum target, GLint level, GLint internal_format,
+                  GLsizei width, GLsizei height, GLint border, GLenum format,
+                  GLenum type, const GLvoid * pixels)
+{
+    const unsigned int * src = (const unsigned int*)pixels;
+    textures[bound_texture].assign(src, src + width * height);
+    texture_widths[bound_texture] = width;
+}
+
+void glTexParameteri(GLenum target, GLenum name, GLint value)
+{
+}
+
+void glDeleteTextures(GLsizei n, const GLuint * textures_in)
+{
+    for (int i = 0; i < n; ++i)
+        textures.erase(textures_in[i]);
+}
+
+void glDrawArrays(GLenum mode, GLint first, GLsizei count)
+{
+}
+
+}
+
+RenderStats Render::stats;
+RenderData render_data;
+
+void shader_set_texture()
+{
+}
+
+double platform_get_time()
+{
+    return 0.0;
+}
+
+int decode_block(int codec, const unsigned char * src, unsigned int src_size,
+                 unsigned char * out, unsigned int out_size)
+{
+    return -1;
+}
+
+BaseFile::BaseFile()
+: handle(NULL), flags(CLOSED)
+{
+}
+
+BaseFile::BaseFile(const char * filename, const char * mode)
+: handle(NULL), flags(CLOSED)
+{
+}
+
+BaseFile::~BaseFile()
+{
+}
+
+size_t BaseFile::read(void * data, size_t size)
+{
+    return 0;
+}
+
+size_t BaseFile::get_size()
+{
+    return 0;
+}
+
+void BaseFile::close()
+{
+}
+
+AssetFile::AssetFile()
+{
+}
+
+void AssetFile::open()
+{
+}
+
+void AssetFile::set_item(int index, AssetType type)
+{
+}
+
+unsigned int AssetFile::get_offset(int index, AssetType type)
+{
+    return 0;
+}
+
+#define GLYPH_COUNT 14
+
+static unsigned int get_pixel(int image, int x, int y, int version)
+{
+    return 0xFF000000 | (version << 16) | (image << 10) | (y << 5) | x;
+}
+
+static void fill_image(Image * image, int index, int version)
+{
+    int w = image->width;
+    int h = image->height;
+    free(image->image);
+    unsigned int * pixels = (unsigned int*)malloc(w * h * 4);
+    for (int y = 0; y < h; ++y)
+        for (int x = 0; x < w; ++x)
+            pixels[y * w + x] = get_pixel(index, x, y, version);
+    image->image = (unsigned char*)pixels;
+}
+
+static Image * make_image(int index)
+{
+    Image * image = new Image(3, 5, 0, 0);
+    image->width = 4 + index % 5;
+    image->height = 6 + index % 3;
+    fill_image(image, index, 0);
+    return image;
+}
+
+static unsigned int get_image_pixel(Image * image, int x, int y)
+{
+    return ((unsigned int*)image->image)[y * image->width + x];
+}
+
+// every glyph in the texture must hold the current pixels of its image,
+// with the gaps between glyphs left empty
+static bool check_texture(GlyphSet * set)
+{
+    TextureMap::const_iterator it = textures.find(set->tex);
+    if (it == textures.end())
+        return false;
+    const std::vector<unsigned int> & pixels = it->second;
+    int width = texture_widths[set->tex];
+    int height = int(pixels.size()) / width;
+    int expected_x = 0;
+    for (int i = 0; i < set->count; ++i) {
+        Image * image = set->images[i];
+        if (set->width[i] != image->width || set->height[i] != image->height)
+            return false;
+        int x1 = int(set->coords[i][0] * width + 0.5f);
+        int x2 = int(set->coords[i][2] * width + 0.5f);
+        int y2 = int(set->coords[i][3] * height + 0.5f);
+        if (x1 != expected_x || x2 != x1 + image->width ||
+            y2 != image->height || set->coords[i][1] != 0.0f)
+            return false;
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < image->width; ++x) {
+                unsigned int expected = 0;
+                if (y < image->height)
+                    expected = get_image_pixel(image, x, y);
+                if (pixels[y * width + x1 + x] != expected)
+                    return false;
+            }
+            if (pixels[y * width + x2] != 0)
+                return false;
+        }
+        expected_x = x2 + 1;
+    }
+    return expected_x == width;
+}
+
+int main()
+{
+    Image * images[GLYPH_COUNT];
+    for (int i = 0; i < GLYPH_COUNT; ++i)
+        images[i] = make_image(i);
+
+    GlyphSet * set = get_glyph_set(images, GLYPH_COUNT);
+    CHECK(set->tex != 0);
+    CHECK(textures.size() == 1);
+    CHECK(check_texture(set));
+    CHECK(get_glyph_set(images, GLYPH_COUNT) == set);
+    CHECK(textures.size() == 1);
+
+    // the images keep their own pixels
+    for (int i = 0; i < GLYPH_COUNT; ++i) {
+        CHECK(images[i]->image != NULL);
+        CHECK(images[i]->flags & Image::GLYPHS);
+    }
+
+    // a run has the quads the images were drawn at one by one, right to
+    // left from the counter position
+    int glyphs[] = {10, 1, 2, 12, 5, 13, 11, 3};
+    int glyph_count = sizeof(glyphs) / sizeof(int);
+    vector<int> boxes;
+    vector<float> coords;
+    int x = 0;
+    for (int i = glyph_count - 1; i >= 0; --i)
+        set->add_left(glyphs[i], x, boxes, coords);
+    CHECK(int(boxes.size()) == glyph_count * 4);
+    CHECK(int(coords.size()) == glyph_count * 4);
+    int current_x = 0;
+    for (int i = glyph_count - 1, j = 0; i >= 0; --i, ++j) {
+        Image * image = images[glyphs[i]];
+        int draw_x = current_x + image->hotspot_x - image->width;
+        int draw_y = image->hotspot_y - image->height;
+        int x1 = draw_x - image->hotspot_x;
+        int y1 = draw_y - image->hotspot_y;
+        CHECK(boxes[j * 4] == x1);
+        CHECK(boxes[j * 4 + 1] == y1);
+        CHECK(boxes[j * 4 + 2] == x1 + image->width);
+        CHECK(boxes[j * 4 + 3] == y1 + image->height);
+        for (int k = 0; k < 4; ++k)
+            CHECK(coords[j * 4 + k] == set->coords[glyphs[i]][k]);
+        current_x -= image->width;
+    }
+    CHECK(x == current_x);
+
+    // unloading an image frees the set and its texture, and the next set
+    // has the pixels the image is loaded with again
+    unsigned int id = set->id;
+    images[3]->unload();
+    CHECK(textures.empty());
+    CHECK(!(images[3]->flags & Image::GLYPHS));
+    fill_image(images[3], 3, 1);
+    set = get_glyph_set(images, GLYPH_COUNT);
+    CHECK(set->id != id);
+    CHECK(textures.size() == 1);
+    CHECK(check_texture(set));
+
+    // replacing a color changes the pixels in place
+    id = set->id;
+    unsigned int from = get_image_pixel(images[5], 0, 0);
+    images[5]->replace(Color(from & 0xFF, (from >> 8) & 0xFF,
+                             (from >> 16) & 0xFF),
+                       Color(1, 2, 3));
+    CHECK(get_image_pixel(images[5], 0, 0) == 0xFF030201);
+    CHECK(textures.empty());
+    set = get_glyph_set(images, GLYPH_COUNT);
+    CHECK(set->id != id);
+    CHECK(check_texture(set));
+
+    // a set of other images is left alone
+    Image * other[GLYPH_COUNT];
+    for (int i = 0; i < GLYPH_COUNT; ++i)
+        other[i] = make_image(i);
+    GlyphSet * other_set = get_glyph_set(other, GLYPH_COUNT);
+    CHECK(textures.size() == 2);
+    delete images[0];
+    CHECK(textures.size() == 1);
+    CHECK(textures.count(other_set->tex) == 1);
+    CHECK(check_texture(other_set));
+
+    for (int i = 1; i < GLYPH_COUNT; ++i)
+        delete images[i];
+    for (int i = 0; i < GLYPH_COUNT; ++i)
+        delete other[i];
+    CHECK(textures.empty());
+    return test_result();
+}
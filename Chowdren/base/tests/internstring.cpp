@@ -0,0 +1,134 @@
+#include "test.h"
+#include "alterables.h"
+#include <map>
+
+// interned alterable strings against the plain std::string values they
+// replaced
+
+std::string empty_string("");
+
+#define SLOTS 16
+
+static const char * candidates[] = {
+    "", "a", "b", "A", "hello", "hello ", "a string that is longer than the "
+    "small string buffer of std::string", "a string that is longer than the "
+    "small string buffer of std::strinG", "0", "-1"
+};
+
+#define CANDIDATE_COUNT int(sizeof(candidates) / sizeof(candidates[0]))
+
+static std::string random_value()
+{
+    return candidates[test_random(CANDIDATE_COUNT)];
+}
+
+// every slot must hold its value, equal values must share one entry, and
+// every entry must count exactly the handles that refer to it
+static bool check_slots(InternString * handles, std::string * model)
+{
+    std::map<std::string, unsigned int> counts;
+    for (int i = 0; i < SLOTS; ++i) {
+        if (handles[i].get() != model[i])
+            return false;
+        if ((handles[i].entry == NULL) != model[i].empty())
+            return false;
+        if (!model[i].empty())
+            counts[model[i]]++;
+        for (int j = 0; j < SLOTS; ++j) {
+            if ((handles[i] == handles[j]) != (model[i] == model[j]))
+                return false;
+            if ((handles[i] != handles[j]) != (model[i] != model[j]))
+                return false;
+        }
+    }
+    for (int i = 0; i < SLOTS; ++i) {
+        if (model[i].empty())
+            continue;
+        if (handles[i].entry->second != counts[model[i]])
+            return false;
+    }
+    return get_intern_count() == counts.size();
+}
+
+int main()
+{
+    CHECK(get_intern_count() == 0);
+    CHECK(empty_intern.get().empty());
+    CHECK(InternString("") == empty_intern);
+    CHECK(InternString().entry == NULL);
+
+    {
+        InternString * handles = new InternString[SLOTS];
+        std::string model[SLOTS];
+        for (int i = 0; i < 20000; ++i) {
+            int index = test_random(SLOTS);
+            int other = test_random(SLOTS);
+            switch (test_random(4)) {
+                case 0: {
+                    std::string value = random_value();
+                    handles[index].set(value);
+                    model[index] = value;
+                    break;
+                }
+                case 1:
+                    handles[index] = handles[other];
+                    model[index] = model[other];
+                    break;
+                case 2: {
+                    // a constant interned by the exporter compares equal to
+                    // a handle set to the same value
+                    std::string value = random_value();
+                    InternString constant(value);
+                    CHECK((handles[index] == constant) ==
+                          (model[index] == value));
+                    InternString copy(handles[other]);
+                    handles[other] = handles[index];
+                    handles[index] = copy;
+                    std::swap(model[index], model[other]);
+                    break;
+                }
+                default:
+                    // setting the stored value keeps the entry
+                    InternEntry * entry = handles[index].entry;
+                    handles[index].set(model[index]);
+                    CHECK(handles[index].entry == entry);
+                    handles[index] = handles[index];
+                    CHECK(handles[index].entry == entry);
+                    break;
+            }
+            if (!check_slots(handles, model)) {
+                CHECK(!"slots differ from their values");
+                break;
+            }
+        }
+        delete[] handles;
+    }
+    // releasing the last handle of a string removes it from the table
+    CHECK(get_intern_count() == 0);
+
+    // alterable strings copy handles, and give the empty string for
+    // indices out of range
+    AlterableStrings * strings = new AlterableStrings;
+    AlterableStrings * copy = new AlterableStrings;
+    strings->set(0, "first");
+    strings->set(ALT_STRINGS - 1, "last");
+    strings->set(ALT_STRINGS, "ignored");
+    CHECK(strings->get(0) == "first");
+    CHECK(strings->get(ALT_STRINGS - 1) == "last");
+    CHECK(strings->get(ALT_STRINGS).empty());
+    CHECK(strings->get_intern(ALT_STRINGS) == empty_intern);
+    copy->set(*strings);
+    CHECK(copy->get_intern(0) == strings->get_intern(0));
+    CHECK(copy->get_intern(0).entry->second == 2);
+    CHECK(get_intern_count() == 2);
+    strings->set(0, "changed");
+    CHECK(copy->get(0) == "first");
+    CHECK(get_intern_count() == 3);
+    delete strings;
+    CHECK(copy->get(0) == "first");
+    CHECK(copy->get_intern(0).entry->second == 1);
+    delete copy;
+    CHECK(get_intern_count() == 0);
+
+    return test_result();
+}
@@ -0,0 +1,104 @@
+#include "test.h"
+#include "objects/layersort.h"
+#include <math.h>
+
+// the keyed sorts against std::stable_sort with the comparison the layer
+// sort used before, on the alterable values directly
+
+struct ValueItem
+{
+    double value;
+    int id;
+};
+
+static bool value_less(const ValueItem & a, const ValueItem & b)
+{
+    return a.value < b.value;
+}
+
+static double random_value(int mode)
+{
+    switch (mode) {
+        case 0:
+            // many duplicates, to check stability
+            return double(test_random(8) - 4);
+        case 1:
+            return (test_random() - 16384) * 0.37;
+        default:
+            switch (test_random(8)) {
+                case 0:
+                    return -0.0;
+                case 1:
+                    return HUGE_VAL;
+                case 2:
+                    return -HUGE_VAL;
+                case 3:
+                    return 1e-310; // denormal
+                case 4:
+                    return -1e300;
+            }
+            return (test_random() - 16384) * 1e5;
+    }
+}
+
+static void check_sort(const ValueItem * values, int count, bool radix)
+{
+    vector<ValueItem> expected(values, values + count);
+    std::stable_sort(expected.begin(), expected.end(), value_less);
+
+    vector<AltSortItem> items(count);
+    for (int i = 0; i < count; ++i) {
+        items[i].key = get_sort_key(values[i].value);
+        // the id stands in for the instance
+        items[i].obj = (FrameObject*)(size_t)(values[i].id + 1);
+    }
+    if (count > 0) {
+        if (radix) {
+            vector<AltSortItem> temp;
+            radix_sort(items, temp);
+        } else
+            insertion_sort(&items[0], count);
+    }
+
+    bool same = true;
+    for (int i = 0; i < count; ++i) {
+        if ((size_t)items[i].obj != size_t(expected[i].id + 1))
+            same = false;
+    }
+    CHECK(same);
+}
+
+int main()
+{
+    // keys order like the doubles, with -0.0 equal to 0.0
+    CHECK(get_sort_key(-0.0) == get_sort_key(0.0));
+    CHECK(get_sort_key(-1.0) < get_sort_key(-0.5));
+    CHECK(get_sort_key(-HUGE_VAL) < get_sort_key(-1e300));
+    CHECK(get_sort_key(-1e-310) < get_sort_key(0.0));
+    CHECK(get_sort_key(0.0) < get_sort_key(1e-310));
+    CHECK(get_sort_key(1e300) < get_sort_key(HUGE_VAL));
+
+    for (int mode = 0; mode < 3; ++mode) {
+        for (int n = 0; n < 300; n += 1 + n / 8) {
+            vector<ValueItem> values(n);
+            for (int i = 0; i < n; ++i) {
+                values[i].value = random_value(mode);
+                values[i].id = i;
+            }
+            const ValueItem * data = n > 0 ? &values[0] : NULL;
+            check_sort(data, n, true);
+            check_sort(data, n, false);
+
+            // nearly sorted, as after a frame of small changes
+            std::stable_sort(values.begin(), values.end(), value_less);
+            for (int i = 0; i < n / 10; ++i)
+                std::swap(values[test_random(n)], values[test_random(n)]);
+            for (int i = 0; i < n; ++i)
+                values[i].id = i;
+            check_sort(data, n, true);
+            check_sort(data, n, false);
+        }
+    }
+
+    return test_result();
+}
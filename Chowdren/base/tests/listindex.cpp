@@ -0,0 +1,150 @@
+#include "test.h"
+#include "objects/listext.h"
+#include <string>
+#include <vector>
+
+// random line edits on large lists, with every search compared against a
+// linear scan of a plain copy of the lines. the lines are short and drawn
+// from a few letters, so there are many equal lines and shared prefixes
+
+FRAMEOBJECT_IMPL(ListObject)
+
+typedef std::vector<std::string> Lines;
+
+// whether the list sort puts a strictly before b, through insert_sorted
+// on a list that only holds b
+static bool is_before(const std::string & a, const std::string & b)
+{
+    ListObject list(0, 0, 0);
+    list.lines.push_back(b);
+    return list.insert_sorted(a) == 0;
+}
+
+static std::string get_random_line()
+{
+    static const char letters[] = "abAB-";
+    std::string value;
+    int size = test_random(5);
+    for (int i = 0; i < size; ++i)
+        value += letters[test_random(5)];
+    return value;
+}
+
+static int find_linear(const Lines & lines, const std::string & text,
+                       bool exact, int offset)
+{
+    for (int i = 0; i < int(lines.size()); ++i) {
+        const std::string & line = lines[i];
+        if (exact ? line == text : line.compare(0, text.size(), text) == 0)
+            return i - offset;
+    }
+    return -1;
+}
+
+// where a sorted list should insert value, which is after every line that
+// is not sorted after it
+static int get_sorted_position(const Lines & lines, const std::string & value)
+{
+    int i = 0;
+    while (i < int(lines.size()) && !is_before(value, lines[i]))
+        i++;
+    return i;
+}
+
+static void add_line(ListObject & list, Lines & model,
+                     const std::string & value)
+{
+    list.add_line(value);
+    if (list.list_flags & ListObject::SORT_LIST)
+        model.insert(model.begin() + get_sorted_position(model, value),
+                     value);
+    else
+        model.push_back(value);
+}
+
+static bool is_same(ListObject & list, const Lines & model)
+{
+    if (list.lines.size() != model.size())
+        return false;
+    for (unsigned int i = 0; i < model.size(); ++i) {
+        if (list.lines[i] != model[i])
+            return false;
+    }
+    return true;
+}
+
+static void check_searches(ListObject & list, const Lines & model)
+{
+    for (int i = 0; i < 4; ++i) {
+        std::string text = get_random_line();
+        CHECK(list.find_string(text, -1) ==
+              find_linear(model, text, false, list.index_offset));
+        CHECK(list.find_string_exact(text, -1) ==
+              find_linear(model, text, true, list.index_offset));
+    }
+    // lines that are certainly there
+    if (model.empty())
+        return;
+    const std::string & line = model[test_random(int(model.size()))];
+    CHECK(list.find_string_exact(line, -1) ==
+          find_linear(model, line, true, list.index_offset));
+}
+
+static void run_edits(bool sorted, int offset)
+{
+    ListObject list(0, 0, 0);
+    list.index_offset = offset;
+    if (sorted)
+        list.list_flags |= ListObject::SORT_LIST;
+    Lines model;
+    for (int i = 0; i < 100; ++i)
+        add_line(list, model, get_random_line());
+    CHECK(is_same(list, model));
+
+    for (int i = 0; i < 3000; ++i) {
+        int size = int(model.size());
+        int op = test_random(10);
+        if (op < 4 || size < 70) {
+            add_line(list, model, get_random_line());
+        } else if (op < 7) {
+            int line = test_random(size);
+            std::string value = get_random_line();
+            list.set_line(line - offset, value);
+            if (sorted) {
+                model.erase(model.begin() + line);
+                model.insert(model.begin() +
+                             get_sorted_position(model, value), value);
+            } else
+                model[line] = value;
+        } else {
+            int line = test_random(size);
+            list.delete_line(line - offset);
+            model.erase(model.begin() + line);
+        }
+        CHECK(is_same(list, model));
+        // searches between some edits only, so edits also follow edits
+        if (i % 3 == 0)
+            check_searches(list, model);
+    }
+
+    // out of range edits change nothing
+    list.set_line(-1 - offset, "a");
+    list.delete_line(int(model.size()) - offset);
+    CHECK(is_same(list, model));
+    check_searches(list, model);
+
+    list.clear();
+    model.clear();
+    for (int i = 0; i < 80; ++i)
+        add_line(list, model, get_random_line());
+    check_searches(list, model);
+}
+
+int main()
+{
+    run_edits(false, 0);
+    run_edits(true, 0);
+    run_edits(false, 1);
+    run_edits(true, 1);
+    return test_result();
+}
@@ -0,0 +1,152 @@
+#include "test.h"
+#include "stringcommon.h"
+#include <string>
+#include <vector>
+
+// MultiReplace must give the same result as calling ireplace_substring for
+// each rule in order, which is what StringReplace did before
+
+struct TestRule
+{
+    const char * from;
+    const char * to;
+};
+
+static std::string replace_sequential(const std::string & value,
+                                      const std::vector<std::string> & from,
+                                      const std::vector<std::string> & to)
+{
+    std::string ret(value);
+    for (unsigned int i = 0; i < from.size(); ++i)
+        ireplace_substring(ret, from[i], to[i]);
+    return ret;
+}
+
+static std::string replace_multi(const std::string & value,
+                                 const std::vector<std::string> & from,
+                                 const std::vector<std::string> & to)
+{
+    MultiReplace matcher;
+    for (unsigned int i = 0; i < from.size(); ++i)
+        matcher.add(from[i], to[i]);
+    matcher.compile();
+    std::string ret(value);
+    matcher.replace(ret);
+    return ret;
+}
+
+static bool check_rules(const std::string & value, const TestRule * rules,
+                        int count, const char * expected)
+{
+    std::vector<std::string> from, to;
+    for (int i = 0; i < count; ++i) {
+        from.push_back(rules[i].from);
+        to.push_back(rules[i].to);
+    }
+    std::string sequential = replace_sequential(value, from, to);
+    std::string multi = replace_multi(value, from, to);
+    if (sequential != multi) {
+        fprintf(stderr, "\"%s\": sequential \"%s\", multi \"%s\"\n",
+                value.c_str(), sequential.c_str(), multi.c_str());
+        return false;
+    }
+    return expected == NULL || multi == expected;
+}
+
+#define CHECK_RULES(value, rules, expected) \
+    CHECK(check_rules(value, rules, sizeof(rules) / sizeof(TestRule), \
+                      expected))
+
+static std::string get_random_string(const char * letters, int max_size)
+{
+    int count = int(strlen(letters));
+    std::string value;
+    int size = test_random(max_size + 1);
+    for (int i = 0; i < size; ++i)
+        value += letters[test_random(count)];
+    return value;
+}
+
+int main()
+{
+    // overlapping patterns, where the first rule takes the shared
+    // characters
+    TestRule overlap[] = {{"ab", "1"}, {"bc", "2"}, {"abc", "3"}};
+    CHECK_RULES("abcabc", overlap, "1c1c");
+    CHECK_RULES("bcab", overlap, "21");
+    TestRule self_overlap[] = {{"aa", "b"}, {"aba", "c"}};
+    CHECK_RULES("aaaaa", self_overlap, "bba");
+    CHECK_RULES("ababa", self_overlap, "cba");
+
+    // the output of a rule is matched by the rules after it, but not by
+    // the ones before it
+    TestRule chain[] = {{"a", "b"}, {"b", "c"}, {"c", "a"}};
+    CHECK_RULES("abc", chain, "aaa");
+    TestRule join[] = {{"x", "ab"}, {"bc", "!"}};
+    CHECK_RULES("xcxc", join, "a!a!");
+    TestRule split[] = {{"b", "-"}, {"ac", "?"}, {"a-c", "+"}};
+    CHECK_RULES("abcac", split, "+?");
+
+    // empty replacements join what was around them
+    TestRule remove[] = {{"b", ""}, {"ac", "!"}, {"", "never"}};
+    CHECK_RULES("abcbac", remove, "!!");
+    TestRule remove_all[] = {{"a", ""}, {"b", ""}};
+    CHECK_RULES("abba", remove_all, "");
+    CHECK_RULES("", remove_all, "");
+
+    // patterns match in any case, replacements are written as given
+    TestRule fold[] = {{"HeLLo", "World"}, {"WORLD", "x"}, {"z", "Z"},
+                       {"zz", "y"}};
+    CHECK_RULES("hello HELLO hElLo", fold, "x x x");
+    CHECK_RULES("zZzz", fold, "yy");
+    TestRule symbols[] = {{"[", "<"}, {"]", ">"}, {"<b>", "**"}};
+    CHECK_RULES("[B]bold[/B]", symbols, "**bold</B>");
+
+    // independent rules in one stage, and many stages
+    TestRule independent[] = {{"cat", "dog"}, {"red", "blue"},
+                              {"one", "two"}, {"dog", "cat"}};
+    CHECK_RULES("red cat, one dog", independent, "blue cat, two cat");
+
+    // random rules and strings from a few letters, so that rules overlap,
+    // feed each other and differ only in case. with more letters, more
+    // rules are independent and share a stage
+    for (int i = 0; i < 20000; ++i) {
+        bool few = i % 2 == 0;
+        std::vector<std::string> from, to;
+        int count = 1 + test_random(few ? 6 : 12);
+        for (int j = 0; j < count; ++j) {
+            from.push_back(get_random_string(few ? "abAB" : "abcdefgHIJ",
+                                             3));
+            to.push_back(get_random_string(few ? "abcB" : "abcdefghij", 3));
+        }
+        std::string value = get_random_string(few ? "abcABC" : "abcdefghij",
+                                              few ? 24 : 60);
+        std::string sequential = replace_sequential(value, from, to);
+        std::string multi = replace_multi(value, from, to);
+        CHECK(sequential == multi);
+        if (sequential == multi)
+            continue;
+        fprintf(stderr, "\"%s\": sequential \"%s\", multi \"%s\"\n",
+                value.c_str(), sequential.c_str(), multi.c_str());
+        for (int j = 0; j < count; ++j)
+            fprintf(stderr, "    \"%s\" -> \"%s\"\n", from[j].c_str(),
+                    to[j].c_str());
+    }
+
+    // a compiled matcher can be used again, and cleared
+    MultiReplace matcher;
+    matcher.add("a", "b");
+    matcher.compile();
+    std::string value = "aAa";
+    matcher.replace(value);
+    CHECK(value == "bbb");
+    matcher.replace(value);
+    CHECK(value == "bbb");
+    matcher.clear();
+    matcher.add("b", "c");
+    matcher.compile();
+    matcher.replace(value);
+    CHECK(value == "ccc");
+
+    return test_result();
+}
@@ -0,0 +1,202 @@
+// definitions that the runtime normally gets from the platform layer, the
+// renderer and the generated code. the runtime checks never draw, open
+// files or read input, so none of these do anything
+
+#include "manager.h"
+#include "fileio.h"
+#include "font.h"
+#include "image.h"
+#include "platform.h"
+#include "render.h"
+#include "shadercommon.h"
+#include "include_gl.h"
+#include "renderplatform.h"
+
+GameManager manager;
+
+GameManager::GameManager()
+: frame(NULL), values(NULL), strings(NULL), window_created(false),
+  fullscreen(false), off_x(0), off_y(0), x_size(WINDOW_WIDTH),
+  y_size(WINDOW_HEIGHT), fade_dir(0.0f), fade_value(0.0f), lives(0),
+  player_died(true), dt(0.0f), player_flags(0), player_press_flags(0),
+  ignore_controls(false), joystick_flags(0), joystick_press_flags(0),
+  joystick_release_flags(0)
+{
+}
+
+FPSLimiter::FPSLimiter()
+: framerate(-1), current_framerate(0.0), dt(0.0)
+{
+}
+
+InputList::InputList()
+: last(-1), count(0)
+{
+}
+
+ObjectPool<FrameObject> FrameObject::pool;
+
+// render
+
+int Render::offset[2];
+RenderStats Render::stats;
+RenderData render_data;
+
+void shader_set_effect(int effect, FrameObject * obj, int width, int height)
+{
+}
+
+void shader_set_texture()
+{
+}
+
+extern "C" {
+
+void glBindTexture(GLenum target, GLuint texture)
+{
+}
+
+void glClear(GLbitfield mask)
+{
+}
+
+void glClearColor(GLclampf r, GLclampf g, GLclampf b, GLclampf a)
+{
+}
+
+void glDrawArrays(GLenum mode, GLint first, GLsizei count)
+{
+}
+
+void glViewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+}
+
+}
+
+// images and fonts
+
+void Image::upload_texture()
+{
+}
+
+void Image::draw(int x, int y, Color color, float angle, float scale_x,
+                 float scale_y)
+{
+}
+
+void Image::draw_flip_x(int x, int y, Color color, float angle,
+                        float scale_x, float scale_y)
+{
+}
+
+void Image::draw(int x, int y, int src_x, int src_y, int w, int h,
+                 Color color)
+{
+}
+
+Image * get_image_cache(const std::string & filename, int hot_x, int hot_y,
+                        int act_x, int act_y, TransparentColor color)
+{
+    return NULL;
+}
+
+bool load_fonts(FontList & fonts)
+{
+    return false;
+}
+
+// files
+
+BaseFile::BaseFile(const char * filename, const char * mode)
+: handle(NULL), flags(CLOSED)
+{
+}
+
+BaseFile::~BaseFile()
+{
+}
+
+size_t BaseFile::write(const void * data, size_t size)
+{
+    return 0;
+}
+
+void BaseFile::close()
+{
+    flags |= CLOSED;
+}
+
+bool read_file(const char * filename, std::string & dst, bool binary)
+{
+    return false;
+}
+
+std::string convert_path(const std::string & value)
+{
+    return value;
+}
+
+bool platform_remove_file(const std::string & path)
+{
+    return false;
+}
+
+bool platform_remove_directory(const std::string & path)
+{
+    return false;
+}
+
+const std::string & platform_get_appdata_dir()
+{
+    return empty_string;
+}
+
+size_t platform_get_file_size(const char * filename)
+{
+    return 0;
+}
+
+void platform_create_directories(const std::string & v)
+{
+}
+
+bool platform_is_file(const std::string & path)
+{
+    return false;
+}
+
+bool platform_is_directory(const std::string & path)
+{
+    return false;
+}
+
+bool platform_path_exists(const std::string & path)
+{
+    return false;
+}
+
+// input and display
+
+void platform_set_vsync(bool value)
+{
+}
+
+bool is_joystick_attached(int n)
+{
+    return false;
+}
+
+bool is_joystick_pressed(int n, int button)
+{
+    return false;
+}
+
+void joystick_vibrate(int n, int l, int r, int d)
+{
+}
+
+float get_joystick_axis_raw(int n, int axis)
+{
+    return 0.0f;
+}
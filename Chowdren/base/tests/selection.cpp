@@ -0,0 +1,236 @@
+#include "test.h"
+#include "common.h"
+#include <vector>
+
+// object list selection, where a reset selection is only marked with
+// all_selected and the links are written when something changes it.
+// iterators walk the most recently added instances first
+
+#define FIRST_ID 1
+#define SECOND_ID 2
+#define ITEM_COUNT 6
+
+typedef std::vector<FrameObject*> Objects;
+
+class Item : public FrameObject
+{
+public:
+    FRAMEOBJECT_HEAD(Item)
+
+    Item(int id)
+    : FrameObject(0, 0, id)
+    {
+    }
+};
+
+FRAMEOBJECT_IMPL(Item)
+
+static void get_selection(ObjectList & list, Objects & out)
+{
+    out.clear();
+    for (ObjectIterator it(list); !it.end(); ++it)
+        out.push_back(*it);
+}
+
+static void get_selection(QualifierList & list, Objects & out)
+{
+    out.clear();
+    for (QualifierIterator it(list); !it.end(); ++it)
+        out.push_back(*it);
+}
+
+// the instances of a list from a list position, in iteration order
+static void add_reversed(ObjectList & list, int start, Objects & out)
+{
+    for (int i = start; i >= 0; i--)
+        out.push_back(list[i]);
+}
+
+static bool is_same(const Objects & a, const Objects & b)
+{
+    if (a.size() != b.size())
+        return false;
+    for (unsigned int i = 0; i < a.size(); i++) {
+        if (a[i] != b[i])
+            return false;
+    }
+    return true;
+}
+
+static void check_list()
+{
+    Item * items[ITEM_COUNT];
+    ObjectList list;
+    for (int i = 0; i < ITEM_COUNT; i++) {
+        items[i] = new Item(FIRST_ID);
+        list.add(items[i]);
+    }
+    Objects selection, expected;
+
+    // select_single while walking a reset selection ends the walk
+    list.clear_selection();
+    Objects visited;
+    for (ObjectIterator it(list); !it.end(); ++it) {
+        visited.push_back(*it);
+        if (*it == items[3])
+            it.select_single();
+    }
+    expected.clear();
+    add_reversed(list, ITEM_COUNT - 1, expected);
+    expected.resize(ITEM_COUNT - 3);
+    CHECK(is_same(visited, expected));
+    get_selection(list, selection);
+    CHECK(selection.size() == 1 && selection[0] == items[3]);
+    CHECK(list.get_selection_size() == 1);
+
+    // an inner iterator deselecting instances the outer one has not reached
+    list.clear_selection();
+    visited.clear();
+    for (ObjectIterator it(list); !it.end(); ++it) {
+        visited.push_back(*it);
+        if (*it != items[ITEM_COUNT - 1])
+            continue;
+        for (ObjectIterator inner(list); !inner.end(); ++inner) {
+            if (*inner == items[1] || *inner == items[3])
+                inner.deselect();
+        }
+    }
+    expected.clear();
+    expected.push_back(items[5]);
+    expected.push_back(items[4]);
+    expected.push_back(items[2]);
+    expected.push_back(items[0]);
+    CHECK(is_same(visited, expected));
+    get_selection(list, selection);
+    CHECK(is_same(selection, expected));
+
+    // the outer iterator deselects after the inner one wrote the links
+    list.clear_selection();
+    for (ObjectIterator it(list); !it.end(); ++it) {
+        if (*it == items[4]) {
+            for (ObjectIterator inner(list); !inner.end(); ++inner) {
+                if (*inner == items[0])
+                    inner.deselect();
+            }
+        }
+        if (*it == items[2])
+            it.deselect();
+    }
+    expected.clear();
+    expected.push_back(items[5]);
+    expected.push_back(items[4]);
+    expected.push_back(items[3]);
+    expected.push_back(items[1]);
+    get_selection(list, selection);
+    CHECK(is_same(selection, expected));
+
+    // get_wrapped_selection after a reset wraps over every instance, also
+    // when the links were written by an earlier selection
+    list.select_single(items[2]);
+    CHECK(list.get_wrapped_selection(3) == items[2]);
+    list.clear_selection();
+    expected.clear();
+    add_reversed(list, ITEM_COUNT - 1, expected);
+    for (int i = 0; i < ITEM_COUNT * 2 + 1; i++)
+        CHECK(list.get_wrapped_selection(i) == expected[i % ITEM_COUNT]);
+
+    // an empty selection gives the instances from the back
+    list.empty_selection();
+    CHECK(list.get_wrapped_selection(0) == items[ITEM_COUNT - 1]);
+    CHECK(list.get_wrapped_selection(ITEM_COUNT + 1) ==
+          items[ITEM_COUNT - 2]);
+
+    for (int i = 0; i < ITEM_COUNT; i++)
+        delete items[i];
+}
+
+static void check_qualifier()
+{
+    Item * items[ITEM_COUNT * 2];
+    ObjectList first, second;
+    for (int i = 0; i < ITEM_COUNT; i++) {
+        items[i] = new Item(FIRST_ID);
+        first.add(items[i]);
+        items[ITEM_COUNT + i] = new Item(SECOND_ID);
+        second.add(items[ITEM_COUNT + i]);
+    }
+    ObjectList * lists[3] = {&first, &second, NULL};
+    QualifierList qualifier;
+    qualifier.set(2, lists);
+    Objects selection, expected;
+
+    // select_single in the first list ends the walk, and empties the
+    // second one
+    qualifier.clear_selection();
+    Objects visited;
+    for (QualifierIterator it(qualifier); !it.end(); ++it) {
+        visited.push_back(*it);
+        if (*it == items[4])
+            it.select_single();
+    }
+    expected.clear();
+    expected.push_back(items[5]);
+    expected.push_back(items[4]);
+    CHECK(is_same(visited, expected));
+    get_selection(qualifier, selection);
+    CHECK(selection.size() == 1 && selection[0] == items[4]);
+    CHECK(!second.has_selection());
+
+    // and in the second list, it keeps the walk from going on
+    qualifier.clear_selection();
+    visited.clear();
+    for (QualifierIterator it(qualifier); !it.end(); ++it) {
+        visited.push_back(*it);
+        if (*it == items[ITEM_COUNT + 3])
+            it.select_single();
+    }
+    expected.clear();
+    add_reversed(first, ITEM_COUNT - 1, expected);
+    add_reversed(second, ITEM_COUNT - 1, expected);
+    expected.resize(ITEM_COUNT * 2 - 3);
+    CHECK(is_same(visited, expected));
+    get_selection(qualifier, selection);
+    CHECK(selection.size() == 1 && selection[0] == items[ITEM_COUNT + 3]);
+
+    // an inner iterator deselecting in both lists
+    qualifier.clear_selection();
+    visited.clear();
+    for (QualifierIterator it(qualifier); !it.end(); ++it) {
+        visited.push_back(*it);
+        if (*it != items[ITEM_COUNT - 1])
+            continue;
+        for (QualifierIterator inner(qualifier); !inner.end(); ++inner) {
+            if (*inner == items[2] || *inner == items[ITEM_COUNT + 4])
+                inner.deselect();
+        }
+    }
+    expected.clear();
+    add_reversed(first, ITEM_COUNT - 1, expected);
+    add_reversed(second, ITEM_COUNT - 1, expected);
+    expected.erase(expected.begin() + ITEM_COUNT + 1);
+    expected.erase(expected.begin() + 3);
+    CHECK(is_same(visited, expected));
+    get_selection(qualifier, selection);
+    CHECK(is_same(selection, expected));
+
+    // get_wrapped_selection after a reset
+    qualifier.select_single(items[ITEM_COUNT + 2]);
+    CHECK(qualifier.get_wrapped_selection(1) == items[ITEM_COUNT + 2]);
+    qualifier.clear_selection();
+    expected.clear();
+    add_reversed(first, ITEM_COUNT - 1, expected);
+    add_reversed(second, ITEM_COUNT - 1, expected);
+    for (int i = 0; i < ITEM_COUNT * 4 + 1; i++)
+        CHECK(qualifier.get_wrapped_selection(i) ==
+              expected[i % (ITEM_COUNT * 2)]);
+
+    for (int i = 0; i < ITEM_COUNT * 2; i++)
+        delete items[i];
+}
+
+int main()
+{
+    check_list();
+    check_qualifier();
+    return test_result();
+}
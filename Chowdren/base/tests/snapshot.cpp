@@ -0,0 +1,241 @@
+#include "test.h"
+#include "common.h"
+#include "snapshot.h"
+#include "crossrand.h"
+
+// a frame is set up by data->init(), changed the way events would change
+// it, and restarted from its restart snapshot. the restarted frame must
+// then match a second frame that was just set up
+
+#define TEST_ID 1
+#define PLAIN_ID 2
+
+class TestObject : public FrameObject
+{
+public:
+    FRAMEOBJECT_HEAD(TestObject)
+
+    TestObject(int x, int y)
+    : FrameObject(x, y, TEST_ID)
+    {
+        create_alterables();
+    }
+};
+
+FRAMEOBJECT_IMPL(TestObject)
+
+// an object type without alterables
+class PlainObject : public FrameObject
+{
+public:
+    FRAMEOBJECT_HEAD(PlainObject)
+
+    PlainObject(int x, int y)
+    : FrameObject(x, y, PLAIN_ID)
+    {
+    }
+};
+
+FRAMEOBJECT_IMPL(PlainObject)
+
+class TestFrame : public Frame
+{
+public:
+    void set_index(int value)
+    {
+        index = value;
+        width = 1280;
+        height = 960;
+        virtual_width = 1280;
+        virtual_height = 960;
+        background_color = Color(0, 0, 0);
+        loops = NULL;
+        loop_hash = NULL;
+        global_values = NULL;
+        global_strings = NULL;
+        timer_base = 0;
+    }
+};
+
+class TestData : public FrameData
+{
+public:
+    int start_count;
+
+    TestData()
+    : start_count(0)
+    {
+    }
+
+    void init()
+    {
+        frame->layers.resize(2);
+        frame->layers[0].init(0, 1.0, 1.0, true, false, false);
+        frame->layers[1].init(1, 0.5, 0.5, true, false, false);
+
+        for (int i = 0; i < 3; ++i) {
+            FrameObject * obj = create_instance<TestObject>(
+                TestObject::pool, 10 + i * 100, 20 + i * 50);
+            obj->alterables->values.set(0, i);
+            obj->alterables->values.set(1, i * 0.5);
+            obj->alterables->strings.set(0, "start");
+            obj->alterables->flags.enable(i);
+            frame->add_object(obj, i % 2);
+        }
+        frame->add_object(
+            create_instance<PlainObject>(PlainObject::pool, 300, 400), 1);
+    }
+
+    void on_start()
+    {
+        start_count++;
+    }
+};
+
+static void set_up(TestFrame & frame, TestData & data)
+{
+    manager.frame = &frame;
+    frame.data = &data;
+    data.frame = &frame;
+    frame.set_index(0);
+    cross_seed = 1234;
+    frame.update();
+}
+
+static int get_layer_index(Layer & layer, FrameObject * obj)
+{
+    int i = 0;
+    LayerInstances::iterator it;
+    for (it = layer.instances.begin(); it != layer.instances.end(); ++it) {
+        if (&*it == obj)
+            return i;
+        ++i;
+    }
+    return -1;
+}
+
+static void check_same_object(FrameObject * a, FrameObject * b)
+{
+    CHECK(a->id == b->id);
+    CHECK(a->x == b->x);
+    CHECK(a->y == b->y);
+    CHECK(a->flags == b->flags);
+    CHECK(a->layer->index == b->layer->index);
+    CHECK(get_layer_index(*a->layer, a) == get_layer_index(*b->layer, b));
+    CHECK((a->alterables == NULL) == (b->alterables == NULL));
+    if (a->alterables == NULL || b->alterables == NULL)
+        return;
+    for (int i = 0; i < ALT_VALUES; ++i) {
+        CHECK(a->alterables->values.get(i) == b->alterables->values.get(i));
+        CHECK(a->alterables->values.get_int(i) ==
+              b->alterables->values.get_int(i));
+    }
+    for (int i = 0; i < ALT_STRINGS; ++i)
+        CHECK(a->alterables->strings.get(i) ==
+              b->alterables->strings.get(i));
+    CHECK(a->alterables->flags.flags == b->alterables->flags.flags);
+}
+
+static void check_same_frame(TestFrame & a, TestFrame & b)
+{
+    CHECK(a.get_instance_count() == b.get_instance_count());
+    CHECK(a.loop_count == b.loop_count);
+    CHECK(a.frame_time == b.frame_time);
+    CHECK(a.off_x == b.off_x && a.off_y == b.off_y);
+    CHECK(a.layers.size() == b.layers.size());
+    for (unsigned int i = 0; i < a.layers.size() && i < b.layers.size();
+         ++i) {
+        CHECK(a.layers[i].x == b.layers[i].x);
+        CHECK(a.layers[i].y == b.layers[i].y);
+        CHECK(a.layers[i].instances.size() == b.layers[i].instances.size());
+    }
+    for (unsigned int i = 0; i < MAX_OBJECT_ID; ++i) {
+        ObjectList & list_a = a.instances.items[i];
+        ObjectList & list_b = b.instances.items[i];
+        CHECK(list_a.size() == list_b.size());
+        if (list_a.size() != list_b.size())
+            continue;
+        ObjectList::iterator it_a = list_a.begin();
+        ObjectList::iterator it_b = list_b.begin();
+        for (; it_a != list_a.end(); ++it_a, ++it_b)
+            check_same_object(it_a->obj, it_b->obj);
+    }
+}
+
+// changes a set up frame the way running events would
+static void change_frame(TestFrame & frame)
+{
+    ObjectList & list = frame.instances.items[TEST_ID];
+    FrameObject * first = list.items[1].obj;
+    FrameObject * second = list.items[2].obj;
+    FrameObject * third = list.items[3].obj;
+
+    first->set_position(500, 600);
+    first->alterables->values.set(0, 42.5);
+    first->alterables->values.set_int(3, 7);
+    first->alterables->strings.set(0, "changed");
+    first->alterables->strings.set(9, "new");
+    first->alterables->flags.disable(0);
+    first->set_layer(1);
+    second->set_visible(false);
+    second->alterables->strings.set(0, "");
+    third->destroy();
+
+    FrameObject * created = create_instance<TestObject>(TestObject::pool,
+                                                        1, 2);
+    created->alterables->strings.set(0, "created");
+    frame.add_object(created, 0);
+    frame.add_object(create_instance<PlainObject>(PlainObject::pool, 3, 4),
+                     1);
+
+    frame.layers[0].set_position(30, 40);
+    frame.set_display_center(100, 100);
+    cross_seed = 99;
+}
+
+int main()
+{
+    TestFrame fresh;
+    TestData fresh_data;
+    set_up(fresh, fresh_data);
+
+    TestFrame frame;
+    TestData data;
+    set_up(frame, data);
+    check_same_frame(frame, fresh);
+    CHECK(frame.restart_snapshot.is_valid(&frame));
+
+    // the destroyed instance is parked on the next update, and the one
+    // created after the snapshot is thrown away by the restore
+    change_frame(frame);
+    frame.update();
+    frame.update();
+    CHECK(frame.get_instance_count() == fresh.get_instance_count() + 1);
+    CHECK(frame.parked_instances.size() == 1);
+
+    CHECK(frame.restart_from_snapshot());
+    CHECK(frame.parked_instances.empty());
+    CHECK(cross_seed == 1234);
+    frame.update();
+    CHECK(data.start_count == 2);
+    CHECK(frame.loop_count == 1);
+    check_same_frame(frame, fresh);
+
+    // the snapshot stays valid, so a frame can be restarted again
+    change_frame(frame);
+    frame.update();
+    CHECK(frame.restart_from_snapshot());
+    frame.update();
+    check_same_frame(frame, fresh);
+
+    // freeing the parked instances makes the snapshot unusable
+    frame.instances.items[TEST_ID].items[1].obj->destroy();
+    frame.update();
+    frame.free_parked_instances();
+    CHECK(!frame.restart_snapshot.is_valid(&frame));
+    CHECK(!frame.restart_from_snapshot());
+
+    frame.reset();
+    fresh.reset();
+    return test_result();
+}
@@ -0,0 +1,73 @@
+#ifndef CHOWDREN_SPANREFS_H
+#define CHOWDREN_SPANREFS_H
+
+#include "objects/surfacespans.h"
+
+// one pixel at a time references for the canvas spans, using the blend
+// equations the GPU paths use
+
+inline unsigned char channel(unsigned int pixel, int c)
+{
+    return ((const unsigned char*)&pixel)[c];
+}
+
+inline unsigned int make_pixel(int r, int g, int b, int a)
+{
+    unsigned int value;
+    unsigned char * c = (unsigned char*)&value;
+    c[0] = r;
+    c[1] = g;
+    c[2] = b;
+    c[3] = a;
+    return value;
+}
+
+inline int round_div_255(int v)
+{
+    return (v * 2 + 255) / 510;
+}
+
+// src alpha, one minus src alpha for color, one, one minus src alpha for
+// alpha
+inline unsigned int ref_blend(unsigned int d, unsigned int s)
+{
+    int a = channel(s, 3);
+    int inv = 255 - a;
+    int out[4];
+    for (int c = 0; c < 3; ++c)
+        out[c] = round_div_255(channel(s, c) * a + channel(d, c) * inv);
+    out[3] = round_div_255(a * 255 + channel(d, 3) * inv);
+    return make_pixel(out[0], out[1], out[2], out[3]);
+}
+
+// reverse subtract with src alpha, keeping the destination alpha
+inline unsigned int ref_subtract(unsigned int d, unsigned int s)
+{
+    int a = channel(s, 3);
+    int out[3];
+    for (int c = 0; c < 3; ++c)
+        out[c] = std::max(0, channel(d, c) - round_div_255(channel(s, c) * a));
+    return make_pixel(out[0], out[1], out[2], channel(d, 3));
+}
+
+// 3x3 convolution of the middle row, with the edge pixels repeated and the
+// alpha of the middle row kept
+inline void ref_convolve(unsigned int * dst, const unsigned int * rows[3],
+                         int n, const float * matrix, float scale,
+                         float offset)
+{
+    for (int x = 0; x < n; ++x) {
+        int xs[3] = {std::max(x - 1, 0), x, std::min(x + 1, n - 1)};
+        int out[3];
+        for (int c = 0; c < 3; ++c) {
+            float acc = 0.0f;
+            for (int i = 0; i < 9; ++i)
+                acc += channel(rows[i / 3][xs[i % 3]], c) * matrix[i];
+            acc = acc * scale + (offset + 0.5f);
+            out[c] = clamp_color_component(int(std::max(acc, 0.0f)));
+        }
+        dst[x] = make_pixel(out[0], out[1], out[2], channel(rows[1][x], 3));
+    }
+}
+
+#endif // CHOWDREN_SPANREFS_H
@@ -0,0 +1,174 @@
+#include "test.h"
+#include "stringcommon.h"
+#include "objects/stringparser.h"
+#include <sstream>
+
+// the splitting loops that split_spans replaced, and the StringParser
+// element access that was built on them
+
+static void old_split(const std::string & s, char delim,
+                      vector<std::string> & elems)
+{
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, delim)) {
+        elems.push_back(item);
+    }
+}
+
+static void old_split(const std::string & str, const std::string & delims,
+                      vector<std::string> & elems)
+{
+    std::string::size_type last_pos = str.find_first_not_of(delims, 0);
+    std::string::size_type pos = str.find_first_of(delims, last_pos);
+
+    while (std::string::npos != pos || std::string::npos != last_pos) {
+        elems.push_back(str.substr(last_pos, pos - last_pos));
+        last_pos = str.find_first_not_of(delims, pos);
+        pos = str.find_first_of(delims, last_pos);
+    }
+}
+
+FRAMEOBJECT_IMPL(StringParser)
+
+static std::string old_set_element(const vector<std::string> & elements,
+                                   const std::string & delimiters,
+                                   const std::string & value, int index)
+{
+    if (delimiters.size() <= 0)
+        return value;
+    index--;
+    std::string ret;
+    for (int i = 0; i < int(elements.size()); i++) {
+        if (i == index)
+            ret += value;
+        else
+            ret += elements[i];
+        if (i < int(elements.size()) - 1)
+            ret += delimiters[0];
+    }
+    return ret;
+}
+
+static std::string random_string(const char * chars, int max_size)
+{
+    int count = int(strlen(chars));
+    std::string ret;
+    int size = test_random(max_size + 1);
+    for (int i = 0; i < size; ++i)
+        ret += chars[test_random(count)];
+    return ret;
+}
+
+static bool same_elements(const std::string & str,
+                          const vector<StringSpan> & spans,
+                          const vector<std::string> & elems)
+{
+    if (spans.size() != elems.size())
+        return false;
+    for (unsigned int i = 0; i < spans.size(); ++i) {
+        if (spans[i].get(str) != elems[i])
+            return false;
+    }
+    return true;
+}
+
+// the bundled boost vector has a broken operator==
+
+static bool same_elements(const vector<std::string> & a,
+                          const vector<std::string> & b)
+{
+    if (a.size() != b.size())
+        return false;
+    for (unsigned int i = 0; i < a.size(); ++i) {
+        if (a[i] != b[i])
+            return false;
+    }
+    return true;
+}
+
+static void check_char(const std::string & str, char delim)
+{
+    vector<StringSpan> spans;
+    split_spans(str, delim, spans);
+    vector<std::string> old_elems;
+    old_split(str, delim, old_elems);
+    CHECK(same_elements(str, spans, old_elems));
+    vector<std::string> elems;
+    split_string(str, delim, elems);
+    CHECK(same_elements(elems, old_elems));
+}
+
+static void check_delims(const std::string & str, const std::string & delims)
+{
+    vector<StringSpan> spans;
+    split_spans(str, delims, spans);
+    vector<std::string> old_elems;
+    old_split(str, delims, old_elems);
+    CHECK(same_elements(str, spans, old_elems));
+    vector<std::string> elems;
+    split_string(str, delims, elems);
+    CHECK(same_elements(elems, old_elems));
+}
+
+// set_element joins the elements with the first delimiter, so runs of
+// delimiters and leading or trailing ones are not kept
+static void check_parser(const std::string & str,
+                         const std::string & delims)
+{
+    StringParser parser(0, 0, 0);
+    for (unsigned int i = 0; i < delims.size(); ++i)
+        parser.add_delimiter(delims.substr(i, 1));
+    parser.set(str);
+    vector<std::string> elems;
+    old_split(str, delims, elems);
+    int count = int(elems.size());
+    CHECK(parser.get_count() == count);
+    for (int i = -1; i <= count + 1; ++i) {
+        const std::string & element = i >= 1 && i <= count ? elems[i - 1]
+                                                           : empty_string;
+        CHECK(parser.get_element(i) == element);
+        CHECK(parser.set_element("new", i) ==
+              old_set_element(elems, delims, "new", i));
+    }
+    CHECK(parser.get_last_element() ==
+          (count > 0 ? elems.back() : empty_string));
+}
+
+int main()
+{
+    const char * edges[] = {"", ",", ",,", "a", "a,", ",a", "a,,b", "a,b,",
+                            ",,a,,b,,", "abc"};
+    for (unsigned int i = 0; i < sizeof(edges) / sizeof(edges[0]); ++i) {
+        check_char(edges[i], ',');
+        check_delims(edges[i], ",");
+        check_delims(edges[i], ",;");
+        check_delims(edges[i], "");
+    }
+
+    // bytes above 127 must not be taken for delimiters
+    check_delims("a\xe9,b\xff", ",\xff");
+
+    for (unsigned int i = 0; i < sizeof(edges) / sizeof(edges[0]); ++i) {
+        check_parser(edges[i], ",");
+        check_parser(edges[i], ",;");
+        check_parser(edges[i], "");
+    }
+    StringParser parser(0, 0, 0);
+    parser.add_delimiter(",");
+    parser.add_delimiter(";");
+    parser.set(";a,,b;c,");
+    CHECK(parser.set_element("x", 2) == "a,x,c");
+    CHECK(parser.set_element("x", 5) == "a,b,c");
+
+    for (int i = 0; i < 5000; ++i) {
+        std::string str = random_string("ab,; \xe9", 24);
+        check_char(str, ',');
+        check_char(str, '\xe9');
+        check_delims(str, random_string(",; \xe9", 3));
+        if (i % 5 == 0)
+            check_parser(str, random_string(",; \xe9", 3));
+    }
+
+    return test_result();
+}
@@ -0,0 +1,346 @@
+#include "test.h"
+#include "stringcommon.h"
+#include <limits.h>
+#include <stdio.h>
+
+// the number formatting functions before they wrote into a buffer, and the
+// number_to_string overloads built on them
+
+static const char OLD_DIGITS[] =
+    "0001020304050607080910111213141516171819"
+    "2021222324252627282930313233343536373839"
+    "4041424344454647484950515253545556575859"
+    "6061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+static std::string old_itoa(int value)
+{
+    enum {BUFFER_SIZE = 16};
+    char buffer[BUFFER_SIZE];
+
+    unsigned int abs_value = static_cast<unsigned int>(value);
+    bool negative = value < 0;
+    if (negative)
+      abs_value = 0 - abs_value;
+
+    char *buffer_end = buffer + BUFFER_SIZE - 1;
+    while (abs_value >= 100) {
+        // Integer division is slow so do it for a group of two digits instead
+        // of for every digit. The idea comes from the talk by Alexandrescu
+        // "Three Optimization Tips for C++". See speed-test for a comparison.
+        unsigned index = (abs_value % 100) * 2;
+        abs_value /= 100;
+        *--buffer_end = OLD_DIGITS[index + 1];
+        *--buffer_end = OLD_DIGITS[index];
+    }
+    if (abs_value < 10) {
+      *--buffer_end = static_cast<char>('0' + abs_value);
+    } else {
+        unsigned index = static_cast<unsigned>(abs_value * 2);
+        *--buffer_end = OLD_DIGITS[index + 1];
+        *--buffer_end = OLD_DIGITS[index];
+    }
+
+    if (negative)
+      *--buffer_end = '-';
+
+    return std::string(buffer_end, buffer - buffer_end + BUFFER_SIZE - 1);
+}
+
+static std::string old_lltoa(long long value)
+{
+    enum {BUFFER_SIZE = 24};
+    char buffer[BUFFER_SIZE];
+
+    unsigned long long abs_value = static_cast<unsigned long long>(value);
+    bool negative = value < 0;
+    if (negative)
+      abs_value = 0 - abs_value;
+
+    char *buffer_end = buffer + BUFFER_SIZE - 1;
+    while (abs_value >= 100) {
+        // Integer division is slow so do it for a group of two digits instead
+        // of for every digit. The idea comes from the talk by Alexandrescu
+        // "Three Optimization Tips for C++". See speed-test for a comparison.
+        unsigned index = (abs_value % 100) * 2;
+        abs_value /= 100;
+        *--buffer_end = OLD_DIGITS[index + 1];
+        *--buffer_end = OLD_DIGITS[index];
+    }
+    if (abs_value < 10) {
+      *--buffer_end = static_cast<char>('0' + abs_value);
+    } else {
+        unsigned index = static_cast<unsigned>(abs_value * 2);
+        *--buffer_end = OLD_DIGITS[index + 1];
+        *--buffer_end = OLD_DIGITS[index];
+    }
+
+    if (negative)
+      *--buffer_end = '-';
+
+    return std::string(buffer_end, buffer - buffer_end + BUFFER_SIZE - 1);
+}
+
+static std::string old_dtoa(double value)
+{
+    char buffer[16];
+
+    /* if input is larger than thres_max, revert to exponential */
+    const double thres_max = (double)(0x7FFFFFFF);
+
+    /* we'll work in positive values and deal with the
+       negative sign issue later */
+    int neg = 0;
+    if (value < 0) {
+        neg = 1;
+        value = -value;
+    }
+
+    /* for very large numbers switch back to native sprintf for exponentials.
+       anyone want to write code to replace this? */
+    /*
+      normal printf behavior is to print EVERY whole number digit
+      which can be 100s of characters overflowing your buffers == bad
+    */
+    if (value > thres_max) {
+        sprintf(&buffer[0], "%e", neg ? -value : value);
+        return std::string(buffer);
+    }
+
+    char* wstr = &buffer[15];
+    int whole = (int) value;
+    double tmp = (value - whole) * 100000;
+    unsigned int frac = (unsigned int)(tmp);
+    double diff = tmp - frac;
+
+    if (diff > 0.5) {
+        ++frac;
+        /* handle rollover, e.g.  case 0.99 with prec 1 is 1.0  */
+        if (frac >= 100000) {
+            frac = 0;
+            ++whole;
+        }
+    } else if (diff == 0.5 && ((frac == 0) || (frac & 1))) {
+        /* if halfway, round up if odd, OR
+           if last digit is 0.  That last part is strange */
+        ++frac;
+    }
+
+    int count = 5;
+    /* now do fractional part, as an unsigned number */
+    bool write = false;
+    do {
+        --count;
+        char c = frac % 10;
+        if (!write) {
+            if (c == 0)
+                continue;
+            write = true;
+        }
+        *wstr-- = c + 48;
+    } while (frac /= 10);
+
+    if (write) {
+        /* add extra 0s */
+        while (count-- > 0)
+            *wstr-- = '0';
+        /* add decimal */
+        *wstr-- = '.';
+    }
+
+    /* do whole part
+     * Take care of sign
+     * Conversion. Number is reversed.
+     */
+    do
+        *wstr-- = (char)(48 + (whole % 10));
+    while (whole /= 10);
+    if (neg) {
+        *wstr-- = '-';
+    }
+    return std::string(wstr + 1, &buffer[15] - wstr);
+}
+
+static std::string old_number_to_string(double value)
+{
+    return old_dtoa(value);
+}
+
+static std::string old_number_to_string(int value)
+{
+    return old_itoa(value);
+}
+
+static std::string old_number_to_string(unsigned int value)
+{
+    return old_itoa(value);
+}
+
+static std::string old_number_to_string(long long value)
+{
+    return old_lltoa(value);
+}
+
+static std::string old_number_to_string(uint64_t value)
+{
+    return old_lltoa(value);
+}
+
+template <class T>
+static bool same_number(T value)
+{
+    StringFuse fuse;
+    std::string old = old_number_to_string(value);
+    return number_to_string(value) == old &&
+           fuse.add(value).get() == old;
+}
+
+static bool same_write(int value)
+{
+    char buffer[NUMBER_STRING_SIZE];
+    int size = write_itoa(value, buffer);
+    return std::string(buffer, size) == old_itoa(value);
+}
+
+static bool same_write(long long value)
+{
+    char buffer[NUMBER_STRING_SIZE];
+    int size = write_lltoa(value, buffer);
+    return std::string(buffer, size) == old_lltoa(value);
+}
+
+static bool same_write(double value)
+{
+    char buffer[NUMBER_STRING_SIZE];
+    int size = write_dtoa(value, buffer);
+    return std::string(buffer, size) == old_dtoa(value);
+}
+
+static int random_int()
+{
+    return int((test_random() << 17) ^ (test_random() << 2) ^ test_random());
+}
+
+static long long random_long()
+{
+    return ((long long)random_int() << 32) ^ (unsigned int)random_int();
+}
+
+static double random_double()
+{
+    switch (test_random(4)) {
+        case 0:
+            // halfway and rounding cases of the fraction
+            return (random_int() % 2000000) / 400000.0;
+        case 1:
+            return random_int() / double(test_random(1000) + 1);
+        case 2:
+            // past the exponent threshold
+            return random_long() * 1e6;
+        default:
+            return (random_int() % 1000) * 0.001;
+    }
+}
+
+static std::string random_string()
+{
+    std::string value;
+    int size = test_random(4) == 0 ? test_random(200) : test_random(8);
+    for (int i = 0; i < size; ++i)
+        value += char('a' + test_random(26));
+    return value;
+}
+
+// appends a random operand to a chain and to the + concatenation that the
+// exporter wrote before
+static void add_operand(StringFuse & fuse, std::string & old)
+{
+    switch (test_random(6)) {
+        case 0: {
+            int value = random_int();
+            fuse.add(value);
+            old = old + old_number_to_string(value);
+            break;
+        }
+        case 1: {
+            double value = random_double();
+            fuse.add(value);
+            old = old + old_number_to_string(value);
+            break;
+        }
+        case 2: {
+            unsigned int value = (unsigned int)random_int();
+            fuse.add(value);
+            old = old + old_number_to_string(value);
+            break;
+        }
+        case 3: {
+            long long value = random_long();
+            fuse.add(value);
+            old = old + old_number_to_string(value);
+            break;
+        }
+        case 4: {
+            uint64_t value = (uint64_t)random_long();
+            fuse.add(value);
+            old = old + old_number_to_string(value);
+            break;
+        }
+        default: {
+            std::string value = random_string();
+            fuse.add(value);
+            old = old + value;
+            break;
+        }
+    }
+}
+
+int main()
+{
+    int ints[] = {0, 1, -1, 9, 10, 99, 100, -100, 12345, INT_MAX, INT_MIN};
+    for (unsigned int i = 0; i < sizeof(ints) / sizeof(int); ++i) {
+        CHECK(same_write(ints[i]));
+        CHECK(same_number(ints[i]));
+        CHECK(same_number((unsigned int)ints[i]));
+    }
+    long long longs[] = {0, -1, 1LL << 40, LLONG_MAX, LLONG_MIN};
+    for (unsigned int i = 0; i < sizeof(longs) / sizeof(long long); ++i) {
+        CHECK(same_write(longs[i]));
+        CHECK(same_number(longs[i]));
+        CHECK(same_number((uint64_t)longs[i]));
+    }
+    double doubles[] = {0.0, -0.0, 0.5, -0.5, 0.125, 0.999995, 0.0000049,
+                        1.000005, 2147483647.0, 2147483648.0, -1e300, 1e-9};
+    for (unsigned int i = 0; i < sizeof(doubles) / sizeof(double); ++i) {
+        CHECK(same_write(doubles[i]));
+        CHECK(same_number(doubles[i]));
+    }
+
+    for (int i = 0; i < 20000; ++i) {
+        int value = random_int();
+        CHECK(same_write(value));
+        CHECK(same_write(random_long()));
+        CHECK(same_write(random_double()));
+        CHECK(fast_itoa(value) == old_itoa(value));
+    }
+
+    // chains past the stack buffer spill into a string
+    for (int i = 0; i < 5000; ++i) {
+        StringFuse fuse;
+        std::string old;
+        int count = test_random(12);
+        for (int j = 0; j < count; ++j)
+            add_operand(fuse, old);
+        CHECK(fuse.get() == old);
+        CHECK(fuse.get() == old);
+    }
+
+    // results are independent values, however many chains run meanwhile
+    vector<std::string> results;
+    for (int i = 0; i < 40; ++i)
+        results.push_back(StringFuse().add("result ").add(i).get());
+    for (int i = 0; i < 40; ++i)
+        CHECK(results[i] == "result " + old_itoa(i));
+
+    return test_result();
+}
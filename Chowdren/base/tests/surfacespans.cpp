@@ -0,0 +1,122 @@
+#include "test.h"
+#include "spanrefs.h"
+#include <string.h>
+
+// the canvas spans against the one pixel at a time references in
+// spanrefs.h. lengths up to 13 cover the four pixel body, the tail and both
+// together.
+
+#define MAX_SPAN 13
+
+static unsigned int random_pixel()
+{
+    unsigned int v = test_random() | (test_random() << 15);
+    v ^= test_random() << 30;
+    // make fully transparent and opaque sources common
+    switch (test_random(4)) {
+        case 0:
+            return v & 0x00FFFFFF;
+        case 1:
+            return v | 0xFF000000;
+    }
+    return v;
+}
+
+static void random_span(unsigned int * span, int n)
+{
+    for (int i = 0; i < n; ++i)
+        span[i] = random_pixel();
+}
+
+static void check_blend()
+{
+    for (int n = 0; n <= MAX_SPAN; ++n) {
+        for (int k = 0; k < 200; ++k) {
+            unsigned int src[MAX_SPAN], dst[MAX_SPAN], ref[MAX_SPAN];
+            random_span(src, n);
+            random_span(dst, n);
+            for (int i = 0; i < n; ++i)
+                ref[i] = ref_blend(dst[i], src[i]);
+            blend_span(dst, src, n);
+            CHECK(memcmp(dst, ref, n * sizeof(unsigned int)) == 0);
+
+            random_span(dst, n);
+            for (int i = 0; i < n; ++i)
+                ref[i] = ref_subtract(dst[i], src[i]);
+            subtract_span(dst, src, n);
+            CHECK(memcmp(dst, ref, n * sizeof(unsigned int)) == 0);
+        }
+    }
+}
+
+static void check_row_ops()
+{
+    for (int n = 0; n <= MAX_SPAN; ++n) {
+        for (int k = 0; k < 50; ++k) {
+            unsigned int span[MAX_SPAN], ref[MAX_SPAN];
+            random_span(span, n);
+
+            for (int i = 0; i < n; ++i)
+                ref[i] = span[n - 1 - i];
+            reverse_span(span, n);
+            CHECK(memcmp(span, ref, n * sizeof(unsigned int)) == 0);
+
+            int alpha = test_random(256);
+            for (int i = 0; i < n; ++i)
+                ref[i] = make_pixel(channel(span[i], 0), channel(span[i], 1),
+                                    channel(span[i], 2), alpha);
+            set_alpha_span(span, n, alpha);
+            CHECK(memcmp(span, ref, n * sizeof(unsigned int)) == 0);
+
+            // key on a color that is in the span most of the time
+            random_span(span, n);
+            unsigned int key = n > 0 ? span[test_random(n)] : 0;
+            Color color(channel(key, 0), channel(key, 1), channel(key, 2));
+            for (int i = 0; i < n; ++i) {
+                ref[i] = span[i];
+                if ((span[i] & 0x00FFFFFF) == (key & 0x00FFFFFF))
+                    ((unsigned char*)&ref[i])[3] = 0;
+            }
+            key_span(span, n, color);
+            CHECK(memcmp(span, ref, n * sizeof(unsigned int)) == 0);
+
+            unsigned int value = random_pixel();
+            for (int i = 0; i < n; ++i)
+                ref[i] = value;
+            fill_span(span, value, n);
+            CHECK(memcmp(span, ref, n * sizeof(unsigned int)) == 0);
+        }
+    }
+}
+
+static void check_convolve()
+{
+    const float blur[9] = {1, 2, 1, 2, 4, 2, 1, 2, 1};
+    const float sharpen[9] = {0, -1, 0, -1, 5, -1, 0, -1, 0};
+    const float * matrices[2] = {blur, sharpen};
+    const float scales[2] = {1.0f / 16.0f, 1.0f};
+
+    for (int n = 1; n <= MAX_SPAN; ++n) {
+        for (int m = 0; m < 2; ++m) {
+            unsigned int lines[3][MAX_SPAN], dst[MAX_SPAN];
+            for (int r = 0; r < 3; ++r)
+                random_span(lines[r], n);
+            const unsigned int * rows[3] = {lines[0], lines[1], lines[2]};
+            const float * matrix = matrices[m];
+            float offset = m == 0 ? 0.0f : 8.0f;
+            convolve_span(dst, rows, n, matrix, scales[m], offset);
+
+            unsigned int ref[MAX_SPAN];
+            ref_convolve(ref, rows, n, matrix, scales[m], offset);
+            CHECK(memcmp(dst, ref, n * sizeof(unsigned int)) == 0);
+        }
+    }
+}
+
+int main()
+{
+    check_blend();
+    check_row_ops();
+    check_convolve();
+    return test_result();
+}
@@ -0,0 +1,44 @@
+#ifndef CHOWDREN_TEST_H
+#define CHOWDREN_TEST_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// every check in a test program runs, and main returns test_result() so
+// ctest reports the program as failed if any of them did not hold
+
+static int test_failures = 0;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, \
+                    __LINE__, #cond); \
+            test_failures++; \
+        } \
+    } while (0)
+
+inline int test_result()
+{
+    if (test_failures == 0)
+        return 0;
+    fprintf(stderr, "%d checks failed\n", test_failures);
+    return 1;
+}
+
+// deterministic across platforms, unlike rand()
+
+static unsigned int test_seed = 1;
+
+inline unsigned int test_random()
+{
+    test_seed = test_seed * 1103515245 + 12345;
+    return (test_seed >> 16) & 0x7FFF;
+}
+
+inline int test_random(int n)
+{
+    return int(test_random() % (unsigned int)n);
+}
+
+#endif // CHOWDREN_TEST_H
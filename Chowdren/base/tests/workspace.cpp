@@ -0,0 +1,111 @@
+#include "test.h"
+#include "objects/workspace.h"
+#include <string>
+
+// workspace files as read by BinaryArray::load_workspaces: a zero
+// terminated name, a little endian size and the data, for every workspace
+
+static void add_entry(std::string & file, const std::string & name,
+                      const std::string & data)
+{
+    file += name;
+    file += '\0';
+    unsigned int size = data.size();
+    for (int i = 0; i < 4; ++i)
+        file += char(size >> (i * 8));
+    file += data;
+}
+
+static char * make_buffer(const std::string & file)
+{
+    char * data = new char[file.size() + 1];
+    memcpy(data, file.data(), file.size());
+    return data;
+}
+
+static std::string get_contents(WorkspaceSet & set, const char * name)
+{
+    std::string str(name);
+    Workspace * workspace = set.find(hash_workspace_name(str), str);
+    if (workspace == NULL)
+        return "<missing>";
+    return std::string(workspace->get_data(), workspace->get_size());
+}
+
+// every workspace that is still a view must point into the current buffer
+static bool views_in_buffer(WorkspaceSet & set, size_t size)
+{
+    WorkspaceMap::const_iterator it;
+    for (it = set.map.begin(); it != set.map.end(); ++it) {
+        Workspace * workspace = it->second;
+        for (; workspace != NULL; workspace = workspace->next_hash) {
+            if (workspace->owned)
+                continue;
+            if (workspace->view < set.buffer ||
+                workspace->view + workspace->view_size > set.buffer + size)
+                return false;
+        }
+    }
+    return true;
+}
+
+int main()
+{
+    // FNV-1a reference values, which the exporter computes as well
+    CHECK(hash_workspace_name("", 0) == 2166136261U);
+    CHECK(hash_workspace_name("a", 1) == 0xE40C292CU);
+    CHECK(hash_workspace_name(std::string("foobar")) == 0xBF9CF968U);
+
+    WorkspaceSet set;
+
+    std::string first;
+    add_entry(first, "a", "first a");
+    add_entry(first, "b", "first b");
+    add_entry(first, "empty", "");
+    set.load(make_buffer(first), first.size());
+    CHECK(get_contents(set, "a") == "first a");
+    CHECK(get_contents(set, "b") == "first b");
+    CHECK(get_contents(set, "empty") == "");
+    CHECK(views_in_buffer(set, first.size()));
+
+    // writing copies the view
+    Workspace * b = set.find(hash_workspace_name(std::string("b")), "b");
+    b->append("!", 1);
+    CHECK(b->owned);
+    CHECK(get_contents(set, "b") == "first b!");
+
+    // reloading keeps only the new buffer, and copies the workspaces that
+    // are not in it
+    for (int i = 0; i < 3; ++i) {
+        std::string second;
+        add_entry(second, "a", "second a");
+        add_entry(second, "c", std::string("second\0c", 8));
+        set.load(make_buffer(second), second.size());
+        CHECK(get_contents(set, "a") == "second a");
+        CHECK(get_contents(set, "b") == "first b!");
+        CHECK(get_contents(set, "c") == std::string("second\0c", 8));
+        CHECK(get_contents(set, "empty") == "");
+        CHECK(set.find(hash_workspace_name(std::string("empty")),
+                       "empty")->owned);
+        CHECK(views_in_buffer(set, second.size()));
+    }
+
+    // a truncated entry keeps what is there
+    std::string truncated;
+    add_entry(truncated, "d", "truncated");
+    truncated.resize(truncated.size() - 4);
+    set.load(make_buffer(truncated), truncated.size());
+    CHECK(get_contents(set, "d") == "trunc");
+    CHECK(get_contents(set, "a") == "second a");
+    CHECK(views_in_buffer(set, truncated.size()));
+
+    // names that collide in the hash table stay apart
+    Workspace * x = set.add(1, "x");
+    Workspace * y = set.add(1, "y");
+    CHECK(x != y);
+    CHECK(set.find(1, "x") == x);
+    CHECK(set.find(1, "y") == y);
+    CHECK(set.add(1, "x") == x);
+
+    return test_result();
+}
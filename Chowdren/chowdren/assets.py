@@ -9,9 +9,12 @@ SHADER_COUNT offsets for each shader
 FILE_COUNT offsets for each internal file
 
 Images:
+    W, H size (ushort)
     X, Y hotspot (short)
     X, Y action point (short)
-    PNG image
+    uint8 codec (see blockcodec.py)
+    uint32 size
+    compressed RGBA data
 
 Sounds:
     uint32 type
@@ -233,7 +236,8 @@ class Assets(object):
     def get_sound_id(self, name):
         return self.sound_ids.get(name.lower(), 'INVALID_ASSET_ID')
 
-    def add_image(self, width, height, hot_x, hot_y, act_x, act_y, data):
+    def add_image(self, width, height, hot_x, hot_y, act_x, act_y, codec,
+                  data):
         writer = ByteReader()
         writer.writeShort(width, True)
         writer.writeShort(height, True)
@@ -241,5 +245,6 @@ class Assets(object):
         writer.writeShort(hot_y)
         writer.writeShort(act_x)
         writer.writeShort(act_y)
+        writer.writeByte(codec, True)
         writer.writeIntString(data)
         self.images.append(str(writer))
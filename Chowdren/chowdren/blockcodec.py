@@ -0,0 +1,88 @@
+"""
+Block codecs for image data in Assets.dat
+
+ZLIB_CODEC: zlib stream (zopfli or zlib)
+LZ4_CODEC: raw LZ4 block (no frame header, uncompressed size is implied by
+           the image dimensions)
+"""
+
+import struct
+
+ZLIB_CODEC, LZ4_CODEC = xrange(2)
+
+CODEC_NAMES = {
+    'zlib': ZLIB_CODEC,
+    'lz4': LZ4_CODEC
+}
+
+MIN_MATCH = 4
+# the last match must start at least 12 bytes before the end of the block,
+# and the last 5 bytes are always literals
+MF_LIMIT = 12
+LAST_LITERALS = 5
+MAX_DISTANCE = 0xFFFF
+HASH_LOG = 16
+
+def write_length(out, value):
+    while value >= 255:
+        out.append(chr(255))
+        value -= 255
+    out.append(chr(value))
+
+def write_sequence(out, data, lit_start, lit_end, offset, match_len):
+    lit_len = lit_end - lit_start
+    token = min(lit_len, 15) << 4
+    if match_len is not None:
+        token |= min(match_len - MIN_MATCH, 15)
+    out.append(chr(token))
+    if lit_len >= 15:
+        write_length(out, lit_len - 15)
+    out.append(data[lit_start:lit_end])
+    if match_len is None:
+        return
+    out.append(struct.pack('<H', offset))
+    if match_len - MIN_MATCH >= 15:
+        write_length(out, match_len - MIN_MATCH - 15)
+
+def compress_lz4_python(data):
+    size = len(data)
+    out = []
+    table = {}
+    anchor = 0
+    pos = 0
+    match_limit = size - MF_LIMIT
+    end_limit = size - LAST_LITERALS
+    while pos < match_limit:
+        seq = data[pos:pos+4]
+        ref = table.get(seq, -1)
+        table[seq] = pos
+        if ref < 0 or pos - ref > MAX_DISTANCE:
+            pos += 1
+            continue
+        # extend match forward
+        match_len = MIN_MATCH
+        while (pos + match_len < end_limit and
+               data[ref + match_len] == data[pos + match_len]):
+            match_len += 1
+        write_sequence(out, data, anchor, pos, pos - ref, match_len)
+        pos += match_len
+        anchor = pos
+    write_sequence(out, data, anchor, size, None, None)
+    return ''.join(out)
+
+try:
+    import lz4.block
+    def compress_lz4(data):
+        return lz4.block.compress(data, mode='high_compression',
+                                  compression=12, store_size=False)
+except ImportError:
+    compress_lz4 = compress_lz4_python
+
+def get_compressor(codec, use_zopfli=True):
+    if codec == LZ4_CODEC:
+        return compress_lz4
+    if use_zopfli:
+        from mmfparser import zopfli as complib
+    else:
+        import zlib as complib
+    return complib.compress
@@ -0,0 +1,183 @@
+from mmfparser.data.chunkloaders.objectinfo import EXTENSION_BASE
+
+"""
+Condition profile, as written by a build with CHOWDREN_CONDITION_PROFILE.
+Each line is:
+
+frame group or_index condition evals passes time
+
+Conditions are only moved if they are known to have no side effects, and
+only within a run of such conditions. A condition that refers to another
+object in its parameters pins the run, since the selection of that object
+may be changed by the conditions around it.
+"""
+
+PURE_CONDITIONS = set([
+    'CompareAlterableValue',
+    'CompareAlterableString',
+    'CompareGlobalValue',
+    'CompareGlobalValueIntEqual',
+    'CompareGlobalValueIntNotEqual',
+    'CompareGlobalString',
+    'CompareCounter',
+    'CompareX',
+    'CompareY',
+    'Compare',
+    'ObjectVisible',
+    'ObjectInvisible',
+    'WhileMousePressed',
+    'KeyDown',
+    'AnimationPlaying',
+    'AnimationFrame',
+    'InsidePlayfield',
+    'OutsidePlayfield',
+    'IsObstacle',
+    'IsLadder',
+    'IsOverlappingBackground',
+    'ChannelNotPlaying',
+    'SampleNotPlaying',
+    'IsBold',
+    'IsItalic',
+    'MovementStopped',
+    'CompareSpeed',
+    'FlagOn',
+    'FlagOff',
+    'NearWindowBorder',
+    'NumberOfLives',
+    'VsyncEnabled'
+])
+
+IMPURE_EXPRESSIONS = set([
+    'Random',
+    'TemporaryBinaryFilePath'
+])
+
+def get_condition_key(converter, group, index):
+    return '%s %s %s %s' % (converter.current_frame_index, group.global_id,
+                            group.or_index, index)
+
+def is_system_item(item):
+    return item.getType() != EXTENSION_BASE or item.getExtensionNum() < 0
+
+class ConditionProfile(object):
+    def __init__(self, converter, filename):
+        self.converter = converter
+        self.stats = {}
+        self.total_before = self.total_after = 0.0
+        try:
+            fp = open(filename, 'rb')
+        except IOError:
+            print 'Condition profile %r not found' % filename
+            return
+        with fp:
+            for line in fp:
+                values = line.split()
+                if len(values) != 7:
+                    continue
+                key = ' '.join(values[:4])
+                evals, passes = int(values[4]), int(values[5])
+                self.stats[key] = (evals, passes, float(values[6]))
+
+    def is_movable(self, condition):
+        if condition.custom or not condition.use_select():
+            return False
+        data = condition.data
+        if not is_system_item(data):
+            return False
+        name = self.converter.get_condition_name(data)
+        if name not in PURE_CONDITIONS:
+            return False
+        object_info = condition.get_object()[0]
+        for parameter in condition.parameters:
+            loader = parameter.loader
+            if not loader.isExpression:
+                if type(loader).__name__ == 'Object':
+                    return False
+                continue
+            for item in loader.items[:-1]:
+                if not is_system_item(item):
+                    return False
+                if item.getName() in IMPURE_EXPRESSIONS:
+                    return False
+                if not item.hasObjectInfo():
+                    continue
+                if item.objectInfo != object_info:
+                    return False
+        return True
+
+    def get_estimate(self, condition, key):
+        try:
+            evals, passes, time = self.stats[key]
+        except KeyError:
+            return None
+        if evals == 0:
+            return None
+        cost = time / evals
+        rate = float(passes) / evals
+        if condition.is_negated():
+            rate = 1.0 - rate
+        return cost, rate
+
+    def reorder(self, group, conditions, offset):
+        if group.or_type is not None or not self.stats:
+            return conditions
+        old_conditions = conditions
+        conditions = list(conditions)
+        estimates = {}
+        for index, condition in enumerate(conditions):
+            if not self.is_movable(condition):
+                continue
+            key = get_condition_key(self.converter, group, index + offset)
+            estimate = self.get_estimate(condition, key)
+            if estimate is None:
+                continue
+            estimates[condition] = estimate
+
+        # runs of movable conditions with known estimates
+        runs = []
+        start = None
+        for index, condition in enumerate(conditions + [None]):
+            if condition in estimates:
+                if start is None:
+                    start = index
+                continue
+            if start is not None and index - start > 1:
+                runs.append((start, index))
+            start = None
+
+        if not runs:
+            return conditions
+
+        before = after = 0.0
+        for start, end in runs:
+            run = conditions[start:end]
+            # for a chain of conditions that all have to pass, the expected
+            # cost is minimized by ordering on cost / (1 - pass rate)
+            def get_rank(condition):
+                cost, rate = estimates[condition]
+                if rate >= 1.0:
+                    return float('inf')
+                return cost / (1.0 - rate)
+            new_run = sorted(run, key=get_rank)
+            before += self.get_chain_cost(run, estimates)
+            after += self.get_chain_cost(new_run, estimates)
+            conditions[start:end] = new_run
+
+        if after >= before:
+            return old_conditions
+        self.total_before += before
+        self.total_after += after
+        print ('Reordered conditions in frame %s, event %s: '
+               'est. %.3f us -> %.3f us' % (
+               self.converter.current_frame_index + 1, group.global_id,
+               before * 1000000.0, after * 1000000.0))
+        return conditions
+
+    def get_chain_cost(self, conditions, estimates):
+        cost = 0.0
+        chance = 1.0
+        for condition in conditions:
+            condition_cost, rate = estimates[condition]
+            cost += chance * condition_cost
+            chance *= rate
+        return cost
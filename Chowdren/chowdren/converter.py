@@ -35,11 +35,13 @@ from chowdren.key import VK_TO_SDL, VK_TO_NAME, convert_key, KEY_TO_NAME
 from chowdren import extra
 from chowdren import shader
 from chowdren.shader import INK_EFFECTS, get_shader_programs
+from chowdren.shaders import get_parameter_id
 from chowdren.config import ConfigurationFile
 from chowdren.idpool import get_id
 from chowdren.codewriter import CodeWriter
 from chowdren.platforms import classes as platform_classes
 from chowdren.assets import Assets
+from chowdren.blockcodec import CODEC_NAMES, LZ4_CODEC
 from mmfparser import texpack
 import platform
 import math
@@ -52,6 +54,8 @@ import multiprocessing
 from chowdren.local import write_locals
 from chowdren import transition
 from chowdren.runinfo import RunInfo
+from chowdren.condprofile import ConditionProfile, get_condition_key
+from chowdren.stringfusion import fuse_strings
 
 WRITE_SOUNDS = True
 PROFILE = False
@@ -60,6 +64,31 @@ PROFILE_DRAW = PROFILE and False
 PROFILE_EVENTS = PROFILE and False
 PROFILE_OBJECTS = PROFILE and False
 
+# conditions that only read globals, and the containers they read from.
+# event groups that consist of these can be skipped while the globals they
+# read keep the stamp they had when the group last failed
+STAMP_CONDITIONS = {
+    'CompareGlobalValue' : 'global_values',
+    'CompareGlobalValueIntEqual' : 'global_values',
+    'CompareGlobalValueIntNotEqual' : 'global_values',
+    'CompareGlobalString' : 'global_strings',
+    'Never' : None
+}
+
+STAMP_EXPRESSIONS = {
+    'GlobalValue' : 'global_values',
+    'GlobalString' : 'global_strings'
+}
+
+CONSTANT_EXPRESSIONS = set(['Long', 'Double', 'String', 'Plus', 'Minus',
+                            'Multiply', 'Divide', 'Virgule', 'Parenthesis',
+                            'EndParenthesis'])
+
+# frame members that are copied by a frame snapshot. pointers and lists are
+# left alone, since they only live for the duration of an event
+SNAPSHOT_TYPES = set(['bool', 'int', 'unsigned int', 'float', 'double',
+                      'std::string'])
+
 # enabled for porting
 if getattr(sys, 'frozen', False):
     NATIVE_EXTENSIONS = False
@@ -590,6 +619,7 @@ class Converter(object):
         # DLL architecture
         self.use_dlls = args.dlls
         self.use_zlib = args.zlib
+        self.image_codec = CODEC_NAMES[args.codec]
         self.event_hash_id = 0
 
         self.clear_selection()
@@ -598,6 +628,7 @@ class Converter(object):
         self.iterated_index = self.iterated_object = self.iterated_name = None
         self.in_actions = self.in_condition_expression = False
         self.strings = {}
+        self.intern_handles = set()
         self.event_functions = {}
         self.event_wrappers = {}
         self.objs_to_qualifier = {}
@@ -677,6 +708,7 @@ class Converter(object):
         self.frame_map = {}
         self.image_frames = defaultdict(set)
         self.frame_images = {}
+        self.frame_targets = defaultdict(set)
 
         max_index = 0
         for game in self.games:
@@ -778,6 +810,13 @@ class Converter(object):
         # runinfo
         self.runinfo = RunInfo(self, self.get_filename('runinfo.dat'))
 
+        # condition profile for condition reordering
+        condition_profile = self.config.get_condition_profile()
+        if condition_profile is None:
+            self.condition_profile = None
+        else:
+            self.condition_profile = ConditionProfile(self, condition_profile)
+
         for game_index, game in enumerate(self.games):
             self.game_index = game_index
             self.game = game
@@ -819,6 +858,12 @@ class Converter(object):
                 self.write_frame(frame.offset_index, frame, event_file,
                                  lists_file, lists_header)
 
+        profile = self.condition_profile
+        if profile is not None and profile.total_before > 0.0:
+            print 'Condition reordering: est. %.3f us -> %.3f us' % (
+                profile.total_before * 1000000.0,
+                profile.total_after * 1000000.0)
+
         # write object updates
         event_file.ensure(1)
         update_calls = defaultdict(list)
@@ -1008,6 +1053,24 @@ class Converter(object):
                                       'upload_texture();', image)
                 event_file.end_brace()
 
+        if self.config.use_image_prepare():
+            for frame_index in self.processed_frames:
+                images = self.frame_images.get(frame_index - 1, set())
+                event_file.putmeth('void use_frame_%s_images' % frame_index)
+                self.write_image_handles(event_file, 'use_prepared_images',
+                                         images)
+                event_file.end_brace()
+
+                next_images = set()
+                for target in self.frame_targets[frame_index - 1]:
+                    next_images.update(self.frame_images.get(target, ()))
+                next_images -= images
+                event_file.putmeth('void prepare_frame_%s_images'
+                                   % frame_index)
+                self.write_image_handles(event_file, 'prepare_images',
+                                         next_images)
+                event_file.end_brace()
+
         event_file.close()
 
         lists_header.close_guard('CHOWDREN_LISTS_H')
@@ -1058,10 +1121,14 @@ class Converter(object):
         strings_header = self.open_code('intern.h')
         strings_header.start_guard('CHOWDREN_STRINGS_H')
         strings_header.putln('#include <string>')
+        strings_header.putln('#include "internstring.h"')
         for value, name in self.strings.iteritems():
             strings_file.putlnc('std::string %s(%r, %s);', name, value,
                                 len(value), cpp=False)
             strings_header.putlnc('extern std::string %s;', name)
+        for name in sorted(self.intern_handles):
+            strings_file.putln('InternString %s_intern(%s);' % (name, name))
+            strings_header.putln('extern InternString %s_intern;' % name)
 
         local_dict = self.config.get_locals()
         write_locals(local_dict, strings_file, strings_header, self)
@@ -1101,14 +1168,26 @@ class Converter(object):
             config_file.putdefine('CHOWDREN_VSYNC')
         if PROFILE:
             config_file.putdefine('CHOWDREN_USE_PROFILER')
+        if self.config.use_condition_profiler():
+            config_file.putdefine('CHOWDREN_CONDITION_PROFILE')
+        if self.config.use_alloc_profiler():
+            config_file.putdefine('CHOWDREN_ALLOC_PROFILE')
 
         # write all options/extension defines
         if self.config.use_iteration_index():
             config_file.putdefine('CHOWDREN_ITER_INDEX')
         if self.config.use_image_preload():
             config_file.putdefine('CHOWDREN_PRELOAD_IMAGES')
+        if self.config.use_image_prepare():
+            config_file.putdefine('CHOWDREN_PREPARE_IMAGES')
+        if self.config.use_frame_snapshot():
+            config_file.putdefine('CHOWDREN_FRAME_SNAPSHOT')
         if self.config.use_deferred_collisions():
             config_file.putdefine('CHOWDREN_DEFER_COLLISIONS')
+        if self.config.use_back_capture():
+            config_file.putdefine('CHOWDREN_BACK_CAPTURE')
+        if self.config.use_layer_cache():
+            config_file.putdefine('CHOWDREN_LAYER_CACHE')
 
         for (name, value) in self.defines:
             if value is None:
@@ -1235,22 +1314,27 @@ class Converter(object):
 
         from chowdren.imageworker import worker
         in_queue = multiprocessing.Queue()
-        worker_count = 8
+        worker_count = multiprocessing.cpu_count()
         workers = []
+        codec = self.image_codec
         use_zopfli = not self.use_zlib
-        if use_zopfli:
+        if codec == LZ4_CODEC:
+            print 'Using LZ4 for compression'
+        elif use_zopfli:
             print 'Using zopfli for compression'
         else:
             print 'Using zlib for compression'
 
         for _ in xrange(worker_count):
             p = multiprocessing.Process(target=worker,
-                                        args=(in_queue, use_zopfli))
+                                        args=(in_queue, codec, use_zopfli))
             p.start()
             workers.append(p)
 
         def get_image_path(image_hash):
             image_hash = image_hash.encode('hex')
+            if codec == LZ4_CODEC:
+                image_hash += '_lz4'
             return self.get_filename('image_cache', '%s.dat' % image_hash)
 
         for i, (image, image_hash) in enumerate(new_entries):
@@ -1277,7 +1361,7 @@ class Converter(object):
             temp = open(cache_path, 'rb').read()
             arg = (image.width, image.height,
                    image.xHotspot, image.yHotspot,
-                   image.actionX, image.actionY, temp)
+                   image.actionX, image.actionY, codec, temp)
             self.assets.add_image(*arg)
 
         self.image_count = image_index
@@ -1677,6 +1761,9 @@ class Converter(object):
         if self.config.use_image_flush(frame):
             start_writer.putlnc('reset_image_cache();')
 
+        if self.config.use_image_prepare():
+            start_writer.putlnc('use_frame_%s_images();', frame_index + 1)
+
         if self.config.use_image_preload():
             start_writer.putlnc('load_frame_%s_images();', frame_index + 1)
 
@@ -1920,6 +2007,10 @@ class Converter(object):
             name = name.rsplit(' ', 1)[-1]
             start_writer.putlnc('%s = %s;', name, default)
 
+        if self.config.use_frame_snapshot():
+            self.write_snapshot_members(frame_file, event_file, events_ref,
+                                        frame_index + 1)
+
         fade = frame.fadeIn
         if fade:
             if fade.duration == 0:
@@ -1927,6 +2018,10 @@ class Converter(object):
             else:
                 transition.write(start_writer, fade, False)
 
+        # decode what the next frames need while this one is running
+        if self.config.use_image_prepare():
+            start_writer.putlnc('prepare_frame_%s_images();', frame_index + 1)
+
         event_file.putmeth('void %s' % start_name)
         event_file.putcode(start_writer)
         event_file.end_brace()
@@ -2046,8 +2141,8 @@ class Converter(object):
                                  % object_func)
             objects_file.putmeth('FrameObject * %s' % object_func,
                                  'int x', 'int y')
-            objects_file.putlnc('return new (%s::pool.create()) %s(x, y);',
-                                object_writer.class_name, class_name)
+            objects_file.putlnc('return create_instance<%s>(%s::pool, x, y);',
+                                class_name, object_writer.class_name)
             objects_file.end_brace()
 
             objects_file.next()
@@ -2173,6 +2268,12 @@ class Converter(object):
                         value = 0
                     parameters[parameter.name].value = value
             for name, value in parameters.iteritems():
+                param_id = get_parameter_id(name)
+                if param_id is not None and isinstance(value.value,
+                                                       (int, float)):
+                    objects_file.putlnc('set_shader_parameter(%s, %s);',
+                                        param_id, value.value)
+                    continue
                 objects_file.putln(to_c('set_shader_parameter(%r, %s);',
                     name, value.value))
 
@@ -2208,8 +2309,12 @@ class Converter(object):
             objects_file.end_brace()
 
             objects_file.putmeth('void dealloc')
+            objects_file.putln('bool in_arena = (flags & ARENA) != 0;')
             objects_file.putlnc('this->%s::~%s();', class_name, class_name)
+            objects_file.putln('if (!in_arena)')
+            objects_file.indent()
             objects_file.putlnc('%s::pool.destroy(this);', subclass)
+            objects_file.dedent()
             objects_file.end_brace()
 
         if PROFILE_OBJECTS:
@@ -2250,6 +2355,44 @@ class Converter(object):
             ret = '(*%s)' % ret
         return ret
 
+    def write_snapshot_members(self, frame_file, event_file, events_ref,
+                               frame_index):
+        members = []
+        for name in sorted(self.frame_initializers):
+            type_name, member = name.rsplit(' ', 1)
+            if type_name not in SNAPSHOT_TYPES or '[' in member:
+                continue
+            members.append(member)
+
+        for name in ('save', 'load'):
+            func_name = '%s_frame_%s_members' % (name, frame_index)
+            frame_file.putmeth('void %s_state' % name,
+                               'FrameSnapshot & snapshot')
+            frame_file.putln('%s%s(snapshot);' % (events_ref, func_name))
+            frame_file.end_brace()
+
+            func = {'save': 'write', 'load': 'read'}[name]
+            event_file.putmeth('void %s' % func_name,
+                               'FrameSnapshot & snapshot')
+            for member in members:
+                event_file.putln('snapshot.%s(%s);' % (func, member))
+            event_file.end_brace()
+
+    def add_frame_target(self, target):
+        if self.current_frame_index is None:
+            return
+        self.frame_targets[self.current_frame_index].add(target)
+
+    def write_image_handles(self, writer, func, images):
+        if not images:
+            writer.putln('%s(NULL, 0);' % func)
+            return
+        images = sorted(images)
+        writer.putln('static const unsigned short images[%s] = {%s};'
+                     % (len(images), ', '.join(str(i) for i in images)),
+                     wrap=True)
+        writer.putln('%s(images, %s);' % (func, len(images)))
+
     def get_image_handle(self, value, game_index=None):
         if game_index is None:
             game_index = self.game_index
@@ -2394,6 +2537,36 @@ class Converter(object):
             writer.putln('if (!%s) goto %s;' % (
                 item.code_name, item.end_label))
 
+    def get_event_stamps(self, conditions):
+        stamps = []
+        for condition in conditions:
+            data = condition.data
+            if condition.custom or data.getType() == EXTENSION_BASE:
+                return None
+            try:
+                container = STAMP_CONDITIONS[data.getName()]
+            except KeyError:
+                return None
+            for parameter in condition.parameters:
+                loader = parameter.loader
+                if not loader.isExpression:
+                    continue
+                for item in loader.items[:-1]:
+                    if item.getType() == EXTENSION_BASE:
+                        return None
+                    name = item.getName()
+                    if name in CONSTANT_EXPRESSIONS:
+                        continue
+                    if name not in STAMP_EXPRESSIONS:
+                        return None
+                    stamps.append('%s->get_stamp(%s)' % (
+                        STAMP_EXPRESSIONS[name], item.loader.value))
+            if container is None:
+                continue
+            stamps.append('%s->get_stamp(%s)' % (container,
+                                                 condition.convert_index(0)))
+        return stamps
+
     def get_container_check(self, container):
         groups = []
         for item in container.tree:
@@ -2657,6 +2830,25 @@ class Converter(object):
         if triggered:
             conditions = conditions[1:]
 
+        condition_stats = {}
+        if self.config.use_condition_profiler():
+            for index, condition in enumerate(group.conditions):
+                if condition not in conditions or condition.custom:
+                    continue
+                name = 'cond_stats_%s' % index
+                key = get_condition_key(self, group, index)
+                writer.putln('static ConditionStats %s("%s");' % (name, key))
+                condition_stats[condition] = name
+
+        if self.condition_profile is not None:
+            conditions = self.condition_profile.reorder(group, conditions,
+                                                        int(triggered))
+
+        event_stamps = None
+        if (not triggered and group.or_type is None and conditions and
+                self.config.use_event_stamps()):
+            event_stamps = self.get_event_stamps(conditions)
+
         if conditions or has_container_check:
             if has_container_check:
                 condition = self.get_container_check(container)
@@ -2664,6 +2856,21 @@ class Converter(object):
             else:
                 writer.putlnc('// group: %s', TEMPORARY_GROUP_NAME)
 
+            if event_stamps is not None:
+                writer.putln('static EventStamp event_stamp;')
+                writer.putln('event_check_count++;')
+                checks = ['event_stamp.is_valid(global_values, '
+                          'global_strings)']
+                for stamp in event_stamps:
+                    checks.append('%s <= event_stamp.stamp' % stamp)
+                writer.putlnc('if (%s) {', ' && '.join(checks))
+                writer.indent()
+                writer.putln('event_skip_count++;')
+                writer.putln(event_break)
+                writer.end_brace()
+                writer.putln('event_stamp.start(global_values, '
+                             'global_strings);')
+
             condition_index = -1
             while condition_index < len(conditions) - 1:
                 condition_index += 1
@@ -2725,6 +2932,9 @@ class Converter(object):
                         writer.put('if (!(')
                     else:
                         writer.put('if (')
+                    stats_name = condition_stats.get(write_condition, None)
+                    if stats_name is not None:
+                        writer.put('CONDITION_PROFILE(%s, ' % stats_name)
                     writer.put(write_condition.prefix)
                     if object_name is None:
                         if write_condition.static:
@@ -2740,6 +2950,8 @@ class Converter(object):
                         writer.put(obj)
 
                     write_condition.write(writer)
+                    if stats_name is not None:
+                        writer.put(')')
                     if negated:
                         writer.put(')')
                     if has_multiple:
@@ -2802,6 +3014,9 @@ class Converter(object):
             self.has_selection = new_selection # group.or_selected
             self.has_single_selection = single_save
 
+        if event_stamps is not None:
+            writer.putln('event_stamp.invalidate();')
+
         self.in_actions = True
 
         action_index = -1
@@ -2984,9 +3199,24 @@ class Converter(object):
                 self.in_condition_expression = not self.in_actions
             self.expression_items = loader.items[:-1]
             self.item_index = 0
+            # top-level + operators and string literals, for fusion
+            use_fusion = self.config.use_string_fusion()
+            plus_offsets = []
+            constants = {}
             while self.item_index < len(self.expression_items):
                 item = self.expression_items[self.item_index]
                 expression_writer = self.get_expression_writer(item)
+                if use_fusion and out.count('(') == out.count(')'):
+                    name = item.getName()
+                    if name == 'Plus':
+                        plus_offsets.append(len(out))
+                    elif name == 'String':
+                        self.last_out = out
+                        start = len(out)
+                        out += expression_writer.get_string()
+                        constants[(start, len(out))] = item.loader.value
+                        self.item_index += 1
+                        continue
                 obj = expression_writer.get_object()
                 object_info, object_type = obj
                 if expression_writer.static:
@@ -3003,6 +3233,11 @@ class Converter(object):
                 out += expression_writer.get_string()
                 self.item_index += 1
 
+            if use_fusion:
+                fused = fuse_strings(self, out, plus_offsets, constants)
+                if fused is not None:
+                    out = fused
+
             if parameter_type == 'VARGLOBAL_EXP':
                 out = '-1 + ' + out
             if parameter_type == 'AlterableValueExpression':
@@ -3133,6 +3368,18 @@ class Converter(object):
         self.strings[value] = name
         return name
 
+    def get_intern_handle(self, exp):
+        """
+        Returns the InternString of an interned string constant, or None if
+        exp is not one.
+        """
+        if exp == 'empty_string':
+            return 'empty_intern'
+        if exp not in self.strings.itervalues():
+            return None
+        self.intern_handles.add(exp)
+        return '%s_intern' % exp
+
     def get_direction(self, parameter):
         loader = parameter.loader
         if loader.isExpression:
@@ -35,6 +35,9 @@ def main():
                         help='copy base runtime')
     parser.add_argument('--zlib', action='store_true',
                         help='use zlib instead of zopfli')
+    parser.add_argument('--codec', type=str, action='store', default='zlib',
+                        choices=('zlib', 'lz4'),
+                        help='block codec to use for image data')
     args = parser.parse_args()
     Converter(args)
 
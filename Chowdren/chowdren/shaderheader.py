@@ -47,7 +47,7 @@ def write_shaders():
         code.put_access('public')
 
         for uniform in shader.uniforms:
-            code.putlnc('static int %s;', uniform[0])
+            code.putlnc('static ShaderUniform %s;', uniform[0])
 
         if shader.uniforms:
             code.putln('')
@@ -95,7 +95,7 @@ def write_shaders():
         code.end_brace(True)
 
         for uniform in shader.uniforms:
-            code.putlnc('int %s::%s;', shader_name, uniform[0])
+            code.putlnc('ShaderUniform %s::%s;', shader_name, uniform[0])
 
         code.putln('')
 
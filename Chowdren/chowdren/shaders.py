@@ -1,3 +1,5 @@
+from chowdren.common import get_method_name
+
 class Shader(object):
     def __init__(self, name, asset_name, has_back=False, has_tex_size=False,
                  tex_param=None):
@@ -236,3 +238,19 @@ SHADERS = [
     shader_display,
     shader_fontoutline
 ]
+
+PARAMETER_NAMES = set()
+for shader in SHADERS:
+    for uniform in shader.uniforms:
+        PARAMETER_NAMES.add(uniform[0].lower())
+    if shader.tex_param:
+        PARAMETER_NAMES.add(shader.tex_param.lower())
+
+def get_parameter_id(name):
+    """
+    Returns the SHADER_PARAM_* define for a shader parameter name, or None if
+    the name is not used by any native shader
+    """
+    if name is None or name.lower() not in PARAMETER_NAMES:
+        return None
+    return 'SHADER_PARAM_%s' % get_method_name(name).upper()
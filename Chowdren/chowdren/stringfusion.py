@@ -0,0 +1,128 @@
+"""
+String expression fusion. A top-level chain of string concatenations is
+normally written as a + b + ..., which builds a std::string temporary per
+operand and per +. A fused chain is written as
+
+StringFuse().add(a).add(b).get()
+
+which appends the operands to a stack buffer, formats the arguments of
+number_to_string() in place and returns the result as one new string.
+Adjacent constants are joined at export time, and a chain of only constants
+becomes a single interned string.
+"""
+
+NUMBER_CALL = 'number_to_string('
+
+def get_call_argument(term, name):
+    if not term.startswith(name) or not term.endswith(')'):
+        return None
+    depth = 0
+    for index in xrange(len(name) - 1, len(term)):
+        c = term[index]
+        if c == '(':
+            depth += 1
+        elif c == ')':
+            depth -= 1
+            if depth == 0 and index != len(term) - 1:
+                return None
+    return term[len(name):-1]
+
+def has_top_level_comma(term):
+    depth = 0
+    for c in term:
+        if c == '(':
+            depth += 1
+        elif c == ')':
+            depth -= 1
+        elif c == ',' and depth == 0:
+            return True
+    return False
+
+def split_fused(exp):
+    """
+    Returns the operands of a fused chain, or None if exp is not one.
+    """
+    start = 'StringFuse().add('
+    end = ').get()'
+    if not exp.startswith(start) or not exp.endswith(end):
+        return None
+    operands = []
+    depth = 0
+    last = len(start)
+    separator = ').add('
+    index = last
+    while index < len(exp) - len(end):
+        c = exp[index]
+        if c == '(':
+            depth += 1
+        elif c == ')':
+            if depth == 0:
+                if not exp.startswith(separator, index):
+                    return None
+                operands.append(exp[last:index])
+                index += len(separator)
+                last = index
+                continue
+            depth -= 1
+        index += 1
+    if depth != 0:
+        return None
+    operands.append(exp[last:len(exp) - len(end)])
+    return operands
+
+def fuse_strings(converter, out, plus_offsets, constants):
+    """
+    out is the written expression, plus_offsets are the offsets of its
+    top-level + operators and constants maps the (start, end) span of each
+    top-level string literal to its value.
+    Returns None if the expression is not a chain of strings.
+    """
+    if '"' in out or "'" in out:
+        return None
+    if out.count('(') != out.count(')'):
+        return None
+
+    get_string = converter.config.get_string
+    bounds = [-1] + plus_offsets + [len(out)]
+    terms = []
+    is_string = False
+    for index in xrange(len(bounds) - 1):
+        start = bounds[index] + 1
+        end = bounds[index + 1]
+        value = constants.get((start, end), None)
+        if value is not None:
+            is_string = True
+            if terms and terms[-1][0] == 'constant':
+                # only join if the config translates the joined string the
+                # same as its parts
+                last = terms[-1][1]
+                joined = last + value
+                if get_string(joined) == get_string(last) + get_string(value):
+                    terms[-1] = ('constant', joined)
+                    continue
+            terms.append(('constant', value))
+            continue
+        term = out[start:end].strip()
+        if not term or has_top_level_comma(term):
+            return None
+        number = get_call_argument(term, NUMBER_CALL)
+        if number is not None:
+            is_string = True
+            terms.append(('number', number))
+        else:
+            terms.append(('value', term))
+
+    if not is_string:
+        return None
+
+    if len(terms) == 1 and terms[0][0] == 'constant':
+        return converter.intern_string(terms[0][1])
+
+    fused = 'StringFuse()'
+    for kind, value in terms:
+        if kind == 'constant':
+            if get_string(value) == '':
+                continue
+            value = converter.intern_string(value)
+        fused += '.add(%s)' % value
+    return fused + '.get()'
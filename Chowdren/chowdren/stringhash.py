@@ -30,4 +30,39 @@ def get_string_int_map(map_func, hash_func, string_map, case_sensitive=True):
         writer.end_brace()
     writer.putlnc('return -1;')
     writer.end_brace()
-    return writer.get_data()
\ No newline at end of file
+    return writer.get_data()
+
+def write_string_index_map(writer, map_func, hash_func, strings,
+                           static=False):
+    """
+    Like get_string_int_map, but maps each string to its index in 'strings'
+    and verifies the input, so strings outside the set return -1. The map
+    function is written with writer.putmeth, so it can be a class method.
+    Signature: int map_func(const char * str, unsigned int len)
+    """
+    hash_data = get_hash_function(hash_func, strings, True)
+    writer.putln(hash_data.code)
+    hashes = dict((v, k) for (k, v) in hash_data.strings.iteritems())
+
+    prototype = 'int %s' % map_func
+    if static:
+        prototype = 'static ' + prototype
+    writer.putmeth(prototype, 'const char * str', 'unsigned int len')
+    writer.putlnc('switch (%s(str, len)) {', hash_func)
+    writer.indent()
+    for i in xrange(hash_data.max_hash_value + 1):
+        value = hashes.get(i, None)
+        if value is None:
+            continue
+        writer.putlnc('case %s:', i)
+        writer.indent()
+        writer.putlnc('if (len != %s || memcmp(str, %r, %s) != 0)',
+                      len(value), value, len(value), cpp=False)
+        writer.indent()
+        writer.putln('return -1;')
+        writer.dedent()
+        writer.putlnc('return %s;', strings.index(value))
+        writer.dedent()
+    writer.end_brace()
+    writer.putln('return -1;')
+    writer.end_brace()
@@ -100,6 +100,9 @@ class FalseCondition(ConditionWriter):
 
 class ComparisonWriter(ConditionWriter):
     prefix = '('
+    # the value as an InternString, for comparing against interned string
+    # constants by handle
+    intern_value = None
 
     def write(self, writer):
         comparison = self.get_comparison()
@@ -112,6 +115,12 @@ class ComparisonWriter(ConditionWriter):
         elif len(parameters) == 2:
             value1 = value % parameters[0]
             value2 = parameters[1]
+            handle = None
+            if self.intern_value is not None and comparison in ('==', '!='):
+                handle = self.converter.get_intern_handle(value2)
+            if handle is not None:
+                value1 = self.intern_value % parameters[0]
+                value2 = handle
         else:
             raise NotImplementedError
         writer.put('%s) %s (%s)' % (value1, comparison, value2))
@@ -221,9 +230,10 @@ def make_static_expression(v):
         method = v
     return NewExpression
 
-def make_comparison(v):
+def make_comparison(v, intern_v=None):
     class NewCondition(ComparisonWriter):
         value = v
+        intern_value = intern_v
     return NewCondition
 
 def make_table(method_writer, table):
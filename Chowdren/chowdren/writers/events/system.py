@@ -14,6 +14,9 @@ from mmfparser.bitdict import BitDict
 from chowdren.idpool import get_id
 from chowdren import transition
 from chowdren.shader import INK_EFFECTS, NATIVE_SHADERS
+from chowdren.shaders import get_parameter_id
+from chowdren.stringhash import write_string_index_map
+from chowdren.stringfusion import split_fused
 
 def get_loop_running_name(name):
     return 'loop_%s_running' % get_method_name(name)
@@ -58,18 +61,20 @@ class SystemObject(ObjectWriter):
             writer.putln('%s = false;' % running_name)
             writer.putln('%s = 0;' % index_name)
         if self.dynamic_loops:
-            writer.putln('static DynamicLoops frame_loops;')
-            writer.putln('loops = &frame_loops;')
+            names = self.dynamic_loop_names
+            writer.putlnc('static DynamicLoop frame_loops[%s];', len(names))
+            writer.putln('loops = &frame_loops[0];')
+            writer.putlnc('loop_hash = &%s;', self.dynamic_loop_hash)
             writer.putln('static bool loops_initialized = false;')
             writer.putln('if (!loops_initialized) {')
             writer.indent()
-            for loop in self.dynamic_loops:
+            for index, loop in enumerate(names):
                 loop_method = 'loop_wrapper_' + get_loop_func_name(
                     loop, self.converter)
                 running_name = get_loop_running_name(loop)
                 index_name = get_loop_index_name(loop)
-                writer.putlnc('frame_loops[%r].set(&%s, &%s, &%s);',
-                              loop, loop_method, running_name, index_name)
+                writer.putlnc('frame_loops[%s].set(&%s, &%s, &%s);',
+                              index, loop_method, running_name, index_name)
             writer.putln('loops_initialized = true;')
             writer.end_brace()
         else:
@@ -402,6 +407,7 @@ class SystemObject(ObjectWriter):
         self.loop_pos = {}
         loops = self.loops = defaultdict(list)
         self.dynamic_loops = set()
+        self.dynamic_loop_names = []
 
         for loop_group in self.get_conditions('OnLoop'):
             parameter = loop_group.conditions[0].data.items[0]
@@ -448,6 +454,8 @@ class SystemObject(ObjectWriter):
                 continue
             self.dynamic_loops.update(names)
 
+        self.dynamic_loop_names = sorted(self.dynamic_loops)
+
         self.converter.begin_events()
 
         loop_order = []
@@ -536,6 +544,19 @@ class SystemObject(ObjectWriter):
             writer.putlnc('((Frames*)frame)->%s();', loop_func)
             writer.end_brace()
 
+        if not self.dynamic_loops:
+            return
+
+        # dynamic loop names are resolved to an index in the frame loop
+        # table with a perfect hash, so lookups do not allocate
+        names = self.dynamic_loop_names
+        frame_index = self.converter.current_frame_index
+        self.dynamic_loop_hash = 'find_dynamic_loop_%s' % frame_index
+        writer.ensure(1)
+        write_string_index_map(writer, self.dynamic_loop_hash,
+                               'hash_dynamic_loop_%s' % frame_index, names,
+                               static=True)
+
 
 # conditions
 
@@ -1614,6 +1635,77 @@ class StartLoop(ActionWriter):
                 break
         return loop_names
 
+    def get_number_cases(self, name_exp):
+        # "prefix" + Str$(n) names are converted to
+        # str_prefix+number_to_string(n), or to
+        # StringFuse().add(str_prefix).add(n).get() when fused
+        operands = split_fused(name_exp)
+        if operands is not None:
+            if len(operands) != 2:
+                return None
+            start, number_exp = operands
+        else:
+            start, sep, number_exp = name_exp.partition('+number_to_string(')
+            if not sep or not number_exp.endswith(')'):
+                return None
+            number_exp = number_exp[:-1]
+        depth = 0
+        for c in number_exp:
+            if c == '(':
+                depth += 1
+            elif c == ')':
+                depth -= 1
+                if depth < 0:
+                    return None
+        if depth != 0:
+            return None
+        prefix = None
+        for value, string_name in self.converter.strings.iteritems():
+            if string_name != start:
+                continue
+            prefix = value
+            break
+        if prefix is None:
+            return None
+        names = self.converter.system_object.dynamic_loop_names
+        cases = {}
+        for index, name in enumerate(names):
+            if not name.startswith(prefix):
+                continue
+            suffix = name[len(prefix):]
+            try:
+                number = int(suffix)
+            except ValueError:
+                return None
+            if str(number) != suffix:
+                return None
+            cases[number] = index
+        if not cases:
+            return None
+        return number_exp, cases
+
+    def write_dynamic_lookup(self, writer, dynamic_end):
+        name_exp = self.convert_index(0)
+        number_cases = self.get_number_cases(name_exp)
+        if number_cases is None:
+            writer.putlnc('DynamicLoop * dyn_ptr = find_loop(%s);', name_exp)
+            writer.putlnc('if (dyn_ptr == NULL) goto %s;', dynamic_end)
+            return
+        # only the number changes, so switch on it directly instead of
+        # building the name
+        number_exp, cases = number_cases
+        writer.putln('int dyn_number;')
+        writer.putlnc('if (!get_loop_number(%s, dyn_number)) goto %s;',
+                      number_exp, dynamic_end)
+        writer.putln('DynamicLoop * dyn_ptr;')
+        writer.putln('switch (dyn_number) {')
+        writer.indent()
+        for number, index in sorted(cases.iteritems()):
+            writer.putlnc('case %s: dyn_ptr = &loops[%s]; break;', number,
+                          index)
+        writer.putlnc('default: goto %s;', dynamic_end)
+        writer.end_brace()
+
     def write(self, writer):
         real_name = self.get_name()
         if real_name is None:
@@ -1704,11 +1796,8 @@ class StartLoop(ActionWriter):
         if is_dynamic:
             dynamic_end = 'dynamic_%s_end' % self.get_id(self)
             writer.putlnc('if (loops == NULL) goto %s;', dynamic_end)
-            writer.putlnc('DynamicLoops::iterator dyn_it = '
-                          '(*loops).find(%s);', self.convert_index(0))
-            writer.putlnc('if (dyn_it == (*loops).end()) goto %s;',
-                          dynamic_end)
-            writer.putlnc('DynamicLoop & dyn_loop = dyn_it->second;')
+            self.write_dynamic_lookup(writer, dynamic_end)
+            writer.putlnc('DynamicLoop & dyn_loop = *dyn_ptr;')
         writer.putln('%s = true;' % running_name)
         if not is_infinite:
             writer.putln('int times = int(%s);' % times)
@@ -1835,7 +1924,9 @@ class EndApplication(ActionWriter):
         writer.put('has_quit = true;')
 
 class SetFrameAction(ActionWriter):
-    def set_frame(self, writer, value):
+    def set_frame(self, writer, value, target=None):
+        if target is not None:
+            self.converter.add_frame_target(target)
         writer.putc('next_frame = %s + %s;', value,
                     self.converter.frame_index_offset)
         writer.putln('')
@@ -1853,11 +1944,14 @@ class JumpToFrame(SetFrameAction):
     def write(self, writer):
         try:
             frame = self.parameters[0].loader
+            target = None
             if frame.isExpression:
                 value = '%s-1' % self.convert_index(0)
             else:
-                value = str(self.converter.game.frameHandles[frame.value])
-            self.set_frame(writer, value)
+                value = self.converter.game.frameHandles[frame.value]
+                target = value + self.converter.frame_index_offset
+                value = str(value)
+            self.set_frame(writer, value, target)
         except IndexError:
             pass
 
@@ -1867,11 +1961,13 @@ class RestartFrame(SetFrameAction):
 
 class NextFrame(SetFrameAction):
     def write(self, writer):
-        self.set_frame(writer, 'index + 1')
+        self.set_frame(writer, 'index + 1',
+                       self.converter.current_frame_index + 1)
 
 class PreviousFrame(SetFrameAction):
     def write(self, writer):
-        self.set_frame(writer, 'index - 1')
+        self.set_frame(writer, 'index - 1',
+                       self.converter.current_frame_index - 1)
 
 class SetInkEffect(ActionWriter):
     custom = True
@@ -1924,6 +2020,19 @@ class SetEffect(ActionWriter):
             shader_name = shader.get_name(name)
             writer.putlnc('%s->set_shader(%s);', obj, shader_name)
 
+class SetEffectParameter(ActionMethodWriter):
+    method = 'set_shader_parameter'
+
+    def write(self, writer):
+        items = self.parameters[0].loader.items
+        name = self.converter.convert_static_expression(items)
+        param_id = get_parameter_id(name)
+        if param_id is None:
+            ActionMethodWriter.write(self, writer)
+            return
+        writer.putc('set_shader_parameter(%s, %s);', param_id,
+                    self.convert_index(1))
+
 class SpreadValue(ActionWriter):
     custom = True
     def write(self, writer):
@@ -2266,7 +2375,7 @@ actions = make_table(ActionMethodWriter, {
     'BringToFront' : 'move_front',
     'DeleteAllCreatedBackdrops' : 'layers[%s-1].destroy_backgrounds()',
     'DeleteCreatedBackdrops' : 'layers[%s-1].destroy_backgrounds(%s, %s, %s)',
-    'SetEffectParameter' : 'set_shader_parameter',
+    'SetEffectParameter' : SetEffectParameter,
     'SetEffectImage' : 'set_shader_parameter',
     'SetFrameBackgroundColor' : 'set_background_color',
     'AddBackdrop' : 'paste',
@@ -2344,11 +2453,13 @@ actions = make_table(ActionMethodWriter, {
 
 conditions = make_table(ConditionMethodWriter, {
     'CompareAlterableValue' : make_comparison('alterables->values.get(%s)'),
-    'CompareAlterableString' : make_comparison('alterables->strings.get(%s)'),
+    'CompareAlterableString' : make_comparison(
+        'alterables->strings.get(%s)', 'alterables->strings.get_intern(%s)'),
     'CompareGlobalValue' : make_comparison('global_values->get(%s)'),
     'CompareGlobalValueIntEqual' : make_comparison('global_values->get(%s)'),
     'CompareGlobalValueIntNotEqual' : make_comparison('global_values->get(%s)'),
-    'CompareGlobalString' : make_comparison('global_strings->get(%s)'),
+    'CompareGlobalString' : make_comparison(
+        'global_strings->get(%s)', 'global_strings->get_intern(%s)'),
     'CompareCounter' : make_comparison('value'),
     'CompareX' : make_comparison('get_x()'),
     'CompareY' : make_comparison('get_y()'),
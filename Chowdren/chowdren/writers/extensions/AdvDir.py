@@ -16,9 +16,9 @@ class FindClosest(ActionWriter):
     custom = True
     def write(self, writer):
         writer.start_brace()
-        object_info = (self.parameters[0].loader.objectInfo,
-                       self.parameters[0].loader.objectType)
-        instances = self.converter.create_list(object_info, writer)
+        other_info = (self.parameters[0].loader.objectInfo,
+                      self.parameters[0].loader.objectType)
+        instances = self.converter.create_list(other_info, writer)
         details = self.convert_index(1)
         x = str(details['x'])
         y = str(details['y'])
@@ -35,9 +35,25 @@ class FindClosest(ActionWriter):
             writer.end_brace()
             x = 'parent_x + %s' % x
             y = 'parent_y + %s' % y
+        # instances whose position lies in their collision box can be
+        # looked up in the layer broadphase
+        boxed = True
+        for other in self.converter.resolve_qualifier(other_info):
+            other_writer = self.converter.get_object_writer(other)
+            if other_writer.class_name != 'Active':
+                boxed = False
+            elif not other_writer.has_boxed_hotspots():
+                boxed = False
         object_info = self.get_object()
         obj = self.converter.get_object(object_info)
-        writer.put('%s->find_closest(%s, %s, %s);' % (obj, instances, x, y))
+        boxed = to_c('%s', boxed)
+        count = self.converter.config.get_closest_count(self)
+        if count > 1:
+            writer.put('%s->find_closest(%s, %s, %s, %s, %s);' % (
+                obj, instances, x, y, boxed, count))
+        else:
+            writer.put('%s->find_closest(%s, %s, %s, %s);' % (
+                obj, instances, x, y, boxed))
         writer.end_brace()
 
 class CompareDistance(ConditionMethodWriter):
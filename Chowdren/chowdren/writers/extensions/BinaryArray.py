@@ -9,19 +9,43 @@ class BinaryArray(ObjectWriter):
     class_name = 'BinaryArray'
     filename = 'binaryarray'
 
+    def get_sources(self):
+        return ObjectWriter.get_sources(self) + ['objects/workspace.cpp']
+
     def write_init(self, writer):
         pass
 
+def hash_workspace_name(name):
+    # FNV-1a, see hash_workspace_name in objects/workspace.cpp
+    value = 2166136261
+    for c in name:
+        value = ((value ^ ord(c)) * 16777619) & 0xFFFFFFFF
+    return value
+
+def get_workspace_arguments(writer):
+    items = writer.parameters[0].loader.items
+    name = writer.converter.convert_static_expression(items)
+    if name is None:
+        return str(writer.convert_index(0))
+    return to_c('%sU, %s', hash_workspace_name(name), name)
+
+class SwitchWorkspace(ActionMethodWriter):
+    def write(self, writer):
+        writer.put('switch_workspace(%s);' % get_workspace_arguments(self))
+
+class HasWorkspace(ConditionMethodWriter):
+    def write(self, writer):
+        writer.put('has_workspace(%s)' % get_workspace_arguments(self))
+
 actions = make_table(ActionMethodWriter, {
     0 : 'load_file',
     2 : 'load_workspaces',
     12 : 'create_workspace',
-    4 : 'switch_workspace',
-
+    4 : SwitchWorkspace
 })
 
 conditions = make_table(ConditionMethodWriter, {
-    0 : 'has_workspace'
+    0 : HasWorkspace
 })
 
 expressions = make_table(ExpressionMethodWriter, {
@@ -14,13 +14,17 @@ class Perspective(ObjectWriter):
         data.skipBytes(4) # sx, sy - unused
         writer.putlnc('width = %s;', data.readShort())
         writer.putlnc('height = %s;', data.readShort())
-        writer.putlnc('set_shader_parameter("effect", %s);', data.readByte())
-        writer.putlnc('set_shader_parameter("direction", %s);',
+        writer.putlnc('set_shader_parameter(SHADER_PARAM_EFFECT, %s);',
+                      data.readByte())
+        writer.putlnc('set_shader_parameter(SHADER_PARAM_DIRECTION, %s);',
                       data.readByte() != 0)
         data.skipBytes(2) # padding
-        writer.putlnc('set_shader_parameter("zoom", %s);', data.readInt())
-        writer.putlnc('set_shader_parameter("offset", %s);', data.readInt())
-        writer.putlnc('set_shader_parameter("sine_waves", %s);', data.readInt())
+        writer.putlnc('set_shader_parameter(SHADER_PARAM_ZOOM, %s);',
+                      data.readInt())
+        writer.putlnc('set_shader_parameter(SHADER_PARAM_OFFSET, %s);',
+                      data.readInt())
+        writer.putlnc('set_shader_parameter(SHADER_PARAM_SINE_WAVES, %s);',
+                      data.readInt())
         # writer.putlnc('set_shader_parameter("perspective_dir", %s);',
         #               data.readByte() != 0)
 
@@ -35,8 +39,8 @@ conditions = make_table(ConditionMethodWriter, {
 })
 
 expressions = make_table(ExpressionMethodWriter, {
-    0 : '.get_shader_parameter("zoom")',
-    1 : '.get_shader_parameter("offset")'
+    0 : '.get_shader_parameter(SHADER_PARAM_ZOOM)',
+    1 : '.get_shader_parameter(SHADER_PARAM_OFFSET)'
 })
 def get_object():
     return Perspective
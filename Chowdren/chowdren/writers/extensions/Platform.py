@@ -1,6 +1,7 @@
 from chowdren.writers.objects import ObjectWriter
 
 from chowdren.common import get_animation_name, to_c, make_color
+from chowdren.idpool import get_id
 
 from chowdren.writers.events import (ComparisonWriter, ActionMethodWriter,
     ConditionMethodWriter, ExpressionMethodWriter, make_table, TrueCondition)
@@ -34,6 +35,7 @@ class PlatformObject(ObjectWriter):
     def initialize(self):
         self.add_event_callback('call_overlaps_obstacle')
         self.add_event_callback('call_overlaps_platform')
+        self.add_event_callback('call_load_sweep')
 
     def write_init(self, writer):
         data = self.get_data()
@@ -51,13 +53,103 @@ class PlatformObject(ObjectWriter):
         writer.putln(to_c('jump_through = %s;', data.readByte() == 1))
 
     def write_frame(self, writer):
-        self.write_event_callback(
-            'call_overlaps_obstacle', writer,
-            self.get_object_conditions(TEST_OVERLAP_OBSTACLE))
-
-        self.write_event_callback(
-            'call_overlaps_platform', writer,
-            self.get_object_conditions(TEST_OVERLAP_PLATFORM))
+        obstacle_groups = self.get_object_conditions(TEST_OVERLAP_OBSTACLE)
+        platform_groups = self.get_object_conditions(TEST_OVERLAP_PLATFORM)
+
+        self.write_event_callback('call_overlaps_obstacle', writer,
+                                  obstacle_groups)
+        self.write_event_callback('call_overlaps_platform', writer,
+                                  platform_groups)
+
+        if self.converter.config.use_platform_sweep():
+            self.write_sweep(writer, obstacle_groups, platform_groups)
+
+    def get_overlap_set(self, groups, action_num):
+        # returns (subjects, other objects, background) if every group is a
+        # plain "X overlaps Y" or "X overlaps backdrop" test that only sets
+        # the collision flag, otherwise None
+        subjects = set()
+        others = set()
+        background = False
+        for group in groups:
+            if group.or_type is not None:
+                return None
+            container = group.container
+            if container and not all(item.is_static
+                                      for item in container.tree):
+                return None
+            conditions = group.conditions[1:]
+            if len(conditions) != 1:
+                return None
+            condition = conditions[0]
+            data = condition.data
+            if data.otherFlags['Not']:
+                return None
+            name = data.getName()
+            if name not in ('IsOverlapping', 'IsOverlappingBackground'):
+                return None
+            for action in group.actions:
+                action_data = action.data
+                if action_data.objectInfo != self.data.handle:
+                    return None
+                if action_data.getExtensionNum() != action_num:
+                    return None
+            subjects.add((data.objectInfo, data.objectType))
+            if name == 'IsOverlappingBackground':
+                background = True
+                continue
+            other = (data.items[0].loader.objectInfo,
+                     data.items[0].loader.objectType)
+            others.update(self.converter.resolve_qualifier(other))
+        return subjects, others, background
+
+    def get_type_ids(self, objs):
+        type_ids = set()
+        for obj in objs:
+            if self.converter.get_object_writer(obj).is_static_background():
+                return None
+            type_ids.add(self.converter.get_object_handle(obj)[0])
+        return sorted(type_ids)
+
+    def write_sweep(self, writer, obstacle_groups, platform_groups):
+        obstacles = self.get_overlap_set(obstacle_groups, 0)
+        platforms = self.get_overlap_set(platform_groups, 1)
+        if obstacles is None or platforms is None:
+            return
+        subjects = obstacles[0] | platforms[0]
+        if len(subjects) != 1:
+            return
+        subject, = subjects
+        converter = self.converter
+        if converter.get_object_handle(subject)[1]:
+            return
+        obstacle_types = self.get_type_ids(obstacles[1])
+        platform_types = self.get_type_ids(platforms[1])
+        if obstacle_types is None or platform_types is None:
+            return
+
+        name = 'load_sweep_%s_%s' % (get_id(self),
+                                     converter.current_frame_index)
+        writer.putmeth('void %s' % name)
+        type_list = obstacle_types + platform_types
+        if type_list:
+            writer.putln('static const int types[] = {%s};'
+                         % ', '.join(type_list))
+        else:
+            writer.putln('static const int * types = NULL;')
+        writer.putln('static PlatformSweep sweep;')
+        writer.putln('sweep.subject = %s;'
+                     % converter.get_object_handle(subject)[0])
+        writer.putln('sweep.obstacles = types;')
+        writer.putlnc('sweep.obstacle_count = %s;', len(obstacle_types))
+        writer.putlnc('sweep.obstacle_background = %s;', obstacles[2])
+        writer.putlnc('sweep.platforms = types + %s;', len(obstacle_types))
+        writer.putlnc('sweep.platform_count = %s;', len(platform_types))
+        writer.putlnc('sweep.platform_background = %s;', platforms[2])
+        writer.putln('PlatformObject::loaded_sweep = &sweep;')
+        writer.end_brace()
+        event_id = self.event_callbacks['call_load_sweep']
+        converter.event_callbacks[event_id] = name
 
 
 actions = make_table(ActionMethodWriter, {
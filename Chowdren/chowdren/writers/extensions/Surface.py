@@ -11,6 +11,9 @@ class SurfaceObject(ObjectWriter):
     use_alterables = True
     update = True
 
+    def get_sources(self):
+        return ObjectWriter.get_sources(self) + ['objects/surfacecanvas.cpp']
+
     def write_init(self, writer):
         data = self.get_data()
         width = data.readShort()
@@ -43,6 +46,8 @@ class SurfaceObject(ObjectWriter):
 
         writer.putlnc('display_selected = %s;', disp_target)
         writer.putlnc('use_abs_coords = %s;', use_abs)
+        if self.converter.config.use_surface_canvas(self):
+            writer.putln('use_canvas = true;')
 
         image_names = [self.converter.get_image(image) for image in images]
 
@@ -12,6 +12,8 @@ class Viewport(ObjectWriter):
     use_alterables = True
 
     def write_init(self, writer):
+        if self.converter.config.use_viewport_fbo():
+            self.converter.add_define('CHOWDREN_VIEWPORT_FBO')
         data = self.get_data()
         data.skipBytes(4)
         width = data.readShort()
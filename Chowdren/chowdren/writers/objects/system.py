@@ -144,6 +144,17 @@ class Active(ObjectWriter):
             return False
         return True
 
+    def has_boxed_hotspots(self):
+        # true if the position of every instance lies inside its collision
+        # box, i.e. every hotspot is within its image
+        for image in self.get_images():
+            bank_image = self.converter.game.images.itemDict[image]
+            if not 0 <= bank_image.xHotspot <= bank_image.width:
+                return False
+            if not 0 <= bank_image.yHotspot <= bank_image.height:
+                return False
+        return True
+
     def write_pre(self, writer):
         self.animations = {}
         self.images = []
@@ -583,6 +594,13 @@ class SubApplication(ObjectWriter):
         writer.putlnc('width = %s;', data.width)
         writer.putlnc('height = %s;', data.height)
 
+        update_interval, draw_interval = \
+            self.converter.config.get_subapp_intervals(self)
+        if update_interval > 1 or draw_interval > 1:
+            self.converter.add_define('CHOWDREN_SUBAPP_CACHE')
+            writer.putlnc('update_interval = %s;', update_interval)
+            writer.putlnc('draw_interval = %s;', draw_interval)
+
         flags = data.options
         if flags['ShareGlobals']:
             writer.putlnc('subapp_frame.global_values = '
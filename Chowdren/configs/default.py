@@ -78,6 +78,56 @@ def use_image_flush(converter, frame):
 def use_image_preload(converter):
     return False
 
+def use_image_prepare(converter):
+    return True
+
+def use_frame_snapshot(converter):
+    return False
+
+def use_back_capture(converter):
+    return True
+
+def use_layer_cache(converter):
+    return False
+
+def use_platform_sweep(converter):
+    # off until the swept probes are checked against the step loop on the
+    # same obstacle sets
+    return False
+
+def use_surface_canvas(converter, obj):
+    return False
+
+def get_closest_count(converter, action):
+    # number of nearest instances AdvancedDirection keeps for its closest
+    # object expression
+    return 1
+
+def get_subapp_intervals(converter, obj):
+    # update and redraw intervals of a sub-application, in parent ticks
+    return (1, 1)
+
+def use_viewport_fbo(converter):
+    # draw the viewport source through a framebuffer instead of copying it
+    # with copy_rect. the layers are still drawn at full size, so this only
+    # trades the copy for a draw, which is not faster everywhere
+    return False
+
+def use_condition_profiler(converter):
+    return False
+
+def get_condition_profile(converter):
+    return None
+
+def use_alloc_profiler(converter):
+    return False
+
+def use_string_fusion(converter):
+    return True
+
+def use_event_stamps(converter):
+    return True
+
 def add_defines(converter):
     pass
 
@@ -87,6 +87,8 @@ class Builder(object):
             'company': None,
             'author': None,
             'version': None,
+            'zlib': False,
+            'codec': 'zlib',
             'copy_base': not self.is_temp
         }
 